@@ -0,0 +1,685 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "chord_detector.h"
+#include "chord_detector_chroma.h"
+#include "chord_detector_sequence.h"
+#include "chord_detector_progression.h"
+#include "chord_detector_key.h"
+#include "chord_detector_bank.h"
+#include "chord_detector_annotation.h"
+#include "chord_detector_arena.h"
+#include "bench_support.h"
+
+/**
+ * Chord detector benchmark suite
+ * Google-Benchmark-style runner without the dependency: each benchmark reports ns/op, heap
+ * allocations/op and p50/p99/p999 of per-op averages over ~1 us batches, optionally as JSON.
+ * The batch percentiles show jitter between batches, not single-call latency: one call of a few
+ * ns cannot be timed on its own. The worst-case section times single calls.
+ * Worst-case benchmarks time every call on its own, warm and with the caches flushed first, report
+ * the unfiltered maximum, and check p99.9 against a warm and a cold budget (1.5 us and 10 us).
+ *
+ * Usage:
+ *   chord_detector_bench [--benchmark_filter=<substring>] [--benchmark_min_time=<seconds>]
+ *                        [--benchmark_out=<file.json>] [--realtime_budget_ns=<ns>]
+ *                        [--realtime_cold_budget_ns=<ns>]
+ */
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations;        // Operations timed
+    double ns_per_op;
+    double allocs_per_op;
+    double batch_p50_ns;        // Percentiles of the per-operation average of each ~1 us batch
+    double batch_p99_ns;
+    double batch_p999_ns;
+    uint64_t ops_per_batch;
+};
+
+struct WorstCaseResult {
+    std::string name;
+    bool cold;                  // Caches flushed before every call
+    uint64_t calls;
+    double p50_ns;              // Per call, clock overhead included, nothing filtered
+    double p999_ns;
+    double p9999_ns;
+    double max_ns;
+};
+
+class BenchmarkRunner {
+public:
+    BenchmarkRunner(const std::string& filter, double min_time) : filter_(filter), min_time_(min_time) {}
+
+    // body(i) runs one call; items_per_call is how many operations a call counts as (e.g. batch size)
+    void run(const std::string& name, const std::function<void(size_t)>& body, size_t items_per_call = 1) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+        using clock = std::chrono::steady_clock;
+
+        // Warm up caches and branch predictors before anything is measured
+        size_t call = 0;
+        for (size_t i = 0; i < 1024; ++i) body(call++);
+
+        // Calibrate the batch size so one sample spans ~1us and clock overhead stays negligible
+        size_t batch = 1;
+        while (batch < (1u << 20)) {
+            auto start = clock::now();
+            for (size_t i = 0; i < batch; ++i) body(call++);
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            if (ns >= 1000.0) break;
+            batch *= 2;
+        }
+
+        std::vector<double> samples;
+        samples.reserve(1 << 16);
+        uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+        double total_ns = 0.0;
+        while (total_ns < min_time_ * 1e9 || samples.size() < 1000) {
+            auto start = clock::now();
+            for (size_t i = 0; i < batch; ++i) body(call++);
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            total_ns += ns;
+            samples.push_back(ns / static_cast<double>(batch * items_per_call));
+        }
+        uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+        uint64_t ops = static_cast<uint64_t>(samples.size()) * batch * items_per_call;
+        std::sort(samples.begin(), samples.end());
+        BenchmarkResult result = {name, ops, total_ns / static_cast<double>(ops),
+                                  static_cast<double>(allocations) / static_cast<double>(ops),
+                                  percentile(samples, 0.50), percentile(samples, 0.99), percentile(samples, 0.999),
+                                  static_cast<uint64_t>(batch * items_per_call)};
+        print(result);
+        results_.push_back(result);
+    }
+
+    // Times each call on its own; nothing is filtered, so max is the slowest single call seen,
+    // interrupts and preemption included, and clock overhead is part of every sample. With evict,
+    // every call starts with cold caches: a buffer larger than the last-level cache is streamed
+    // through (untimed) first.
+    void run_worst_case(const std::string& name, const std::function<void(size_t)>& body, bool evict) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+        using clock = std::chrono::steady_clock;
+        static std::vector<uint8_t> scratch(64u << 20);
+        auto timed_call = [&](size_t i) {
+            if (evict) {
+                for (size_t j = 0; j < scratch.size(); j += 64) scratch[j]++;
+                do_not_optimize(scratch[i & (scratch.size() - 1)]);
+            }
+            auto start = clock::now();
+            body(i);
+            return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        };
+
+        size_t call = 0;
+        for (size_t i = 0; i < 1024; ++i) body(call++);
+
+        std::vector<double> samples;
+        size_t min_calls = evict ? 64 : 100000;
+        auto begin = clock::now();
+        while (samples.size() < min_calls ||
+               std::chrono::duration<double>(clock::now() - begin).count() < min_time_) {
+            samples.push_back(timed_call(call++));
+        }
+
+        std::sort(samples.begin(), samples.end());
+        WorstCaseResult result = {name, evict, static_cast<uint64_t>(samples.size()), percentile(samples, 0.50),
+                                  percentile(samples, 0.999), percentile(samples, 0.9999), samples.back()};
+        if (worst_cases_.empty()) {
+            std::printf("\n%-48s %12s %12s %12s %12s %12s\n", "Worst case (per call)", "p50", "p99.9", "p99.99", "max",
+                        "Calls");
+            std::printf("%s\n", std::string(113, '-').c_str());
+        }
+        std::printf("%-48s %12.1f %12.1f %12.1f %12.1f %12llu\n", result.name.c_str(), result.p50_ns, result.p999_ns,
+                    result.p9999_ns, result.max_ns, static_cast<unsigned long long>(result.calls));
+        worst_cases_.push_back(result);
+    }
+
+    // Checks each worst-case benchmark's p99.9 against the warm or cold budget and prints the verdict.
+    // p99.9 rather than max: interrupts and preemption land in a few calls per run whatever the code
+    // does, and they cannot reach 0.1% of the calls; max is still reported, unfiltered, above.
+    bool check_budgets(double warm_budget_ns, double cold_budget_ns) const {
+        bool within = true;
+        for (const WorstCaseResult& r : worst_cases_) {
+            double budget = r.cold ? cold_budget_ns : warm_budget_ns;
+            bool ok = r.p999_ns <= budget;
+            within = within && ok;
+            std::printf("%-48s p99.9 %9.1f ns of a %8.0f ns budget (max %9.1f ns): %s\n", r.name.c_str(), r.p999_ns,
+                        budget, r.max_ns, ok ? "within budget" : "OVER BUDGET");
+        }
+        return within;
+    }
+
+    void print_header() const {
+        std::printf("%-48s %12s %10s %11s %11s %11s %10s %12s\n", "Benchmark", "ns/op", "allocs/op", "batch p50",
+                    "batch p99", "batch p999", "ops/batch", "Iterations");
+        std::printf("%s\n", std::string(132, '-').c_str());
+    }
+
+    bool write_json(const char* path) const {
+        std::FILE* file = std::fopen(path, "w");
+        if (!file) return false;
+
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        std::fprintf(file, "{\n  \"context\": {\n");
+        std::fprintf(file, "    \"date\": \"%s\",\n", date);
+        std::fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#if defined(__clang__)
+        std::fprintf(file, "    \"compiler\": \"clang %d.%d\",\n", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+        std::fprintf(file, "    \"compiler\": \"gcc %d.%d\",\n", __GNUC__, __GNUC_MINOR__);
+#elif defined(_MSC_VER)
+        std::fprintf(file, "    \"compiler\": \"msvc %d\",\n", _MSC_VER);
+#endif
+#ifdef NDEBUG
+        std::fprintf(file, "    \"library_build_type\": \"release\",\n");
+#else
+        std::fprintf(file, "    \"library_build_type\": \"debug\",\n");
+#endif
+        std::fprintf(file, "    \"min_time\": %g\n  },\n  \"benchmarks\": [\n", min_time_);
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const BenchmarkResult& r = results_[i];
+            std::fprintf(file,
+                         "    {\"name\": \"%s\", \"iterations\": %llu, \"real_time\": %.3f, \"time_unit\": \"ns\", "
+                         "\"allocs_per_op\": %.4f, \"batch_p50\": %.3f, \"batch_p99\": %.3f, \"batch_p999\": %.3f, "
+                         "\"ops_per_batch\": %llu}%s\n",
+                         r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.ns_per_op, r.allocs_per_op,
+                         r.batch_p50_ns, r.batch_p99_ns, r.batch_p999_ns, static_cast<unsigned long long>(r.ops_per_batch),
+                         i + 1 < results_.size() ? "," : "");
+        }
+        std::fprintf(file, "  ],\n  \"worst_case\": [\n");
+        for (size_t i = 0; i < worst_cases_.size(); ++i) {
+            const WorstCaseResult& r = worst_cases_[i];
+            std::fprintf(file,
+                         "    {\"name\": \"%s\", \"cold\": %s, \"calls\": %llu, \"time_unit\": \"ns\", \"p50\": %.1f, "
+                         "\"p999\": %.1f, \"p9999\": %.1f, \"max\": %.1f}%s\n",
+                         r.name.c_str(), r.cold ? "true" : "false", static_cast<unsigned long long>(r.calls), r.p50_ns,
+                         r.p999_ns, r.p9999_ns, r.max_ns,
+                         i + 1 < worst_cases_.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+
+private:
+    static double percentile(const std::vector<double>& sorted, double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[index < sorted.size() ? index : sorted.size() - 1];
+    }
+
+    static void print(const BenchmarkResult& r) {
+        std::printf("%-48s %12.2f %10.3f %11.2f %11.2f %11.2f %10llu %12llu\n", r.name.c_str(), r.ns_per_op,
+                    r.allocs_per_op, r.batch_p50_ns, r.batch_p99_ns, r.batch_p999_ns,
+                    static_cast<unsigned long long>(r.ops_per_batch), static_cast<unsigned long long>(r.iterations));
+    }
+
+    std::string filter_;
+    double min_time_;
+    std::vector<BenchmarkResult> results_;
+    std::vector<WorstCaseResult> worst_cases_;
+};
+
+// Fixed pool of voicings cycled through by a benchmark; a power-of-two size keeps indexing cheap
+struct ChordPool {
+    static constexpr size_t SIZE = 1024;
+
+    std::vector<int> notes;         // Flat note buffer
+    std::vector<size_t> offsets;    // SIZE + 1 entries
+    std::vector<uint16_t> pc_masks;
+    std::vector<uint8_t> bass_pcs;
+
+    const int* chord(size_t i) const { return notes.data() + offsets[i & (SIZE - 1)]; }
+    int count(size_t i) const { i &= SIZE - 1; return static_cast<int>(offsets[i + 1] - offsets[i]); }
+
+    void add(const std::vector<int>& chord) {
+        if (offsets.empty()) offsets.push_back(0);
+        notes.insert(notes.end(), chord.begin(), chord.end());
+        offsets.push_back(notes.size());
+    }
+
+    void finish() {
+        pc_masks.resize(SIZE);
+        bass_pcs.resize(SIZE);
+        pitch_class_sets_from_notes(notes.data(), offsets.data(), SIZE, pc_masks.data(), bass_pcs.data());
+    }
+};
+
+// Voicing of a pitch-class set: bass in octave 3, the rest spread over octaves 4-5
+static std::vector<int> voice(uint16_t pc_mask, std::mt19937& rng) {
+    std::vector<int> pcs;
+    for (int pc = 0; pc < 12; ++pc) {
+        if (pc_mask & (1 << pc)) pcs.push_back(pc);
+    }
+    std::shuffle(pcs.begin(), pcs.end(), rng);
+
+    std::vector<int> chord;
+    chord.push_back(48 + pcs[0]);
+    for (size_t i = 1; i < pcs.size(); ++i) chord.push_back(60 + pcs[i] + 12 * static_cast<int>(rng() % 2));
+    std::shuffle(chord.begin() + 1, chord.end(), rng);
+    return chord;
+}
+
+// Random pitch-class sets of exactly note_count distinct pitch classes
+static ChordPool random_pool(int note_count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    ChordPool pool;
+    for (size_t i = 0; i < ChordPool::SIZE; ++i) {
+        int pcs[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+        std::shuffle(pcs, pcs + 12, rng);
+        uint16_t mask = 0;
+        for (int n = 0; n < note_count; ++n) mask |= static_cast<uint16_t>(1 << pcs[n]);
+        pool.add(voice(mask, rng));
+    }
+    pool.finish();
+    return pool;
+}
+
+// Worst case: sets of 2+ pitch classes that match no pattern over any root, so every root is probed
+static ChordPool no_match_pool(uint32_t seed) {
+    std::vector<uint16_t> masks;
+    for (uint32_t mask = 1; mask < 4096; ++mask) {
+        if (ChordDetector::count_pitch_classes(static_cast<uint16_t>(mask)) < 2) continue;
+        bool matched = false;
+        for (int root = 0; root < 12 && !matched; ++root) {
+            uint16_t rotated = ChordDetector::rotate_mask(static_cast<uint16_t>(mask), root);
+            matched = (mask & (1 << root)) && ChordDetector::PATTERN_INDEX.best[rotated] != ChordDetector::PATTERN_NONE;
+        }
+        if (!matched) masks.push_back(static_cast<uint16_t>(mask));
+    }
+
+    std::mt19937 rng(seed);
+    ChordPool pool;
+    for (size_t i = 0; i < ChordPool::SIZE; ++i) pool.add(voice(masks[rng() % masks.size()], rng));
+    pool.finish();
+    return pool;
+}
+
+// Note-on/off stream of a player changing between random 3-5 note chords
+static std::vector<NoteEvent> event_stream(size_t chord_count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<NoteEvent> events;
+    std::vector<int> held;
+    uint32_t tick = 0;
+    for (size_t c = 0; c < chord_count; ++c) {
+        for (int note : held) events.push_back({tick, static_cast<uint8_t>(note), 0, 0});
+        held.clear();
+        int pcs[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+        std::shuffle(pcs, pcs + 12, rng);
+        uint16_t mask = 0;
+        for (int n = 0; n < 3 + static_cast<int>(rng() % 3); ++n) mask |= static_cast<uint16_t>(1 << pcs[n]);
+        held = voice(mask, rng);
+        tick += 480;
+        for (int note : held) events.push_back({tick, static_cast<uint8_t>(note), 0, 1});
+    }
+    // Release the last chord so the stream can be replayed in a loop
+    for (int note : held) events.push_back({tick + 480, static_cast<uint8_t>(note), 0, 0});
+    return events;
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double min_time = 0.2;
+    const char* json_path = nullptr;
+    // p99.9 budgets: about 2x the measured real-time path, and below what a fallback to the pattern
+    // search (analyze_chord_reference, 1.1-6 us warm) or an extra pass over the tables would cost
+    double budget_ns = 1500.0;
+    double cold_budget_ns = 10000.0;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--benchmark_filter=", 19) == 0) {
+            filter = arg + 19;
+        } else if (std::strncmp(arg, "--benchmark_min_time=", 21) == 0) {
+            min_time = std::atof(arg + 21);
+        } else if (std::strncmp(arg, "--benchmark_out=", 16) == 0) {
+            json_path = arg + 16;
+        } else if (std::strncmp(arg, "--realtime_budget_ns=", 21) == 0) {
+            budget_ns = std::atof(arg + 21);
+        } else if (std::strncmp(arg, "--realtime_cold_budget_ns=", 26) == 0) {
+            cold_budget_ns = std::atof(arg + 26);
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--benchmark_filter=<substring>] [--benchmark_min_time=<seconds>] "
+                         "[--benchmark_out=<file.json>] [--realtime_budget_ns=<ns>] [--realtime_cold_budget_ns=<ns>]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+
+    // Build the lookup table before anything is timed
+    prepare_realtime();
+
+    BenchmarkRunner runner(filter, min_time);
+    runner.print_header();
+
+    std::vector<ChordPool> pools;
+    for (int n = 2; n <= 12; ++n) pools.push_back(random_pool(n, 1000 + n));
+    const ChordPool& four_notes = pools[2];
+    ChordPool no_match = no_match_pool(7);
+
+    for (bool use_slash : {false, true}) {
+        std::string slash = use_slash ? "/slash:1" : "/slash:0";
+        for (int n = 2; n <= 12; ++n) {
+            const ChordPool& pool = pools[n - 2];
+            runner.run("analyze_chord_fast/notes:" + std::to_string(n) + slash, [&](size_t i) {
+                do_not_optimize(analyze_chord_fast(pool.chord(i), pool.count(i), use_slash));
+            });
+        }
+        runner.run("analyze_chord_fast/no_match" + slash, [&](size_t i) {
+            do_not_optimize(analyze_chord_fast(no_match.chord(i), no_match.count(i), use_slash));
+        });
+        for (int n : {3, 12}) {
+            const ChordPool& pool = pools[n - 2];
+            runner.run("analyze_chord_realtime/notes:" + std::to_string(n) + slash, [&](size_t i) {
+                do_not_optimize(analyze_chord_realtime(pool.chord(i), pool.count(i), use_slash));
+            });
+        }
+        runner.run("analyze_chord_realtime/no_match" + slash, [&](size_t i) {
+            do_not_optimize(analyze_chord_realtime(no_match.chord(i), no_match.count(i), use_slash));
+        });
+    }
+
+    // Tolerant matching of voicings with no exact reading: shared neighbor table vs. probing each set in range
+    for (int distance : {1, 2}) {
+        std::string suffix = "/distance:" + std::to_string(distance) + "/slash:1";
+        ChordDetector::ToleranceOptions options;
+        options.max_distance = distance;
+        ChordDetector::tolerance_table(distance);
+        runner.run("analyze_chord_tolerant/no_match" + suffix, [&](size_t i) {
+            do_not_optimize(analyze_chord_tolerant(no_match.chord(i), no_match.count(i), true, distance));
+        });
+        runner.run("search_tolerant/no_match" + suffix, [&](size_t i) {
+            size_t c = i & (ChordPool::SIZE - 1);
+            do_not_optimize(ChordDetector::search_tolerant(ChordDetector::lookup_table(), no_match.pc_masks[c],
+                                                           no_match.bass_pcs[c], true, options));
+        });
+    }
+
+    // Original string-scanning algorithm, for comparison against the table-driven path
+    for (int n : {3, 4, 6, 12}) {
+        const ChordPool& pool = pools[n - 2];
+        runner.run("analyze_chord_reference/notes:" + std::to_string(n) + "/slash:1", [&](size_t i) {
+            ChordResult r = ChordDetector::analyze_chord_reference(pool.chord(i), pool.count(i), false, true);
+            do_not_optimize(r);
+        });
+    }
+    runner.run("analyze_chord_reference/no_match/slash:1", [&](size_t i) {
+        ChordResult r = ChordDetector::analyze_chord_reference(no_match.chord(i), no_match.count(i), false, true);
+        do_not_optimize(r);
+    });
+
+    for (bool use_slash : {false, true}) {
+        std::string slash = use_slash ? "/slash:1" : "/slash:0";
+        runner.run("get_chord_name/notes:4" + slash, [&](size_t i) {
+            std::string name = get_chord_name(four_notes.chord(i), four_notes.count(i), false, use_slash);
+            do_not_optimize(name);
+        });
+        runner.run("get_chord_name_view/notes:4" + slash, [&](size_t i) {
+            do_not_optimize(get_chord_name_view(four_notes.chord(i), four_notes.count(i), false, use_slash));
+        });
+        runner.run("analyze_chord/notes:4" + slash, [&](size_t i) {
+            ChordResult r = analyze_chord(four_notes.chord(i), four_notes.count(i), false, use_slash);
+            do_not_optimize(r);
+        });
+    }
+
+    // Opt-in outputs: pitch classes only, the chord name only, and a lazy view read for the root and slash flag
+    runner.run("analyze_chord/notes:4/slash:1/fields:none", [&](size_t i) {
+        ChordResult r = analyze_chord(four_notes.chord(i), four_notes.count(i), false, true, ChordDetector::FIELDS_NONE);
+        do_not_optimize(r);
+    });
+    runner.run("analyze_chord/notes:4/slash:1/fields:chord_name", [&](size_t i) {
+        ChordResult r = analyze_chord(four_notes.chord(i), four_notes.count(i), false, true, ChordDetector::FIELD_CHORD_NAME);
+        do_not_optimize(r);
+    });
+    runner.run("analyze_chord_view/notes:4/slash:1/root", [&](size_t i) {
+        ChordView view = analyze_chord_view(four_notes.chord(i), four_notes.count(i), false, true);
+        do_not_optimize(view.root_pitch_class() + view.is_slash_chord());
+    });
+    runner.run("analyze_chord_view/notes:4/slash:1/full_name", [&](size_t i) {
+        do_not_optimize(analyze_chord_view(four_notes.chord(i), four_notes.count(i), false, true).full_name());
+    });
+
+    for (int n : {3, 4, 6}) {
+        const ChordPool& pool = pools[n - 2];
+        runner.run("get_detailed_analysis/notes:" + std::to_string(n), [&](size_t i) {
+            DetailedAnalysis r = get_detailed_analysis(pool.chord(i), pool.count(i));
+            do_not_optimize(r);
+        });
+    }
+    // Bulk output into an arena, reset once per batch of 1024 chords; reported per chord
+    ChordDetector::AnalysisArena arena;
+    runner.run("get_detailed_analysis_batch/arena/notes:4", [&](size_t) {
+        arena.reset();
+        do_not_optimize(get_detailed_analysis_batch(four_notes.notes.data(), four_notes.offsets.data(), ChordPool::SIZE, arena));
+    }, ChordPool::SIZE);
+    runner.run("analyze_chords_batch/arena/notes:4/slash:1", [&](size_t) {
+        arena.reset();
+        do_not_optimize(analyze_chords_batch(four_notes.notes.data(), four_notes.offsets.data(), ChordPool::SIZE, arena, false, true));
+    }, ChordPool::SIZE);
+    runner.run("get_detailed_analysis/notes:4/fields:intervals", [&](size_t i) {
+        DetailedAnalysis r = get_detailed_analysis(four_notes.chord(i), four_notes.count(i), false, ChordDetector::FIELD_INTERVALS);
+        do_not_optimize(r);
+    });
+
+    for (int n : {3, 4, 6}) {
+        const ChordPool& pool = pools[n - 2];
+        runner.run("get_detailed_analysis_compact/notes:" + std::to_string(n), [&](size_t i) {
+            DetailedAnalysisCompact r;
+            get_detailed_analysis(pool.chord(i), pool.count(i), r);
+            do_not_optimize(r);
+        });
+    }
+
+    runner.run("format_chord/notes:4/slash:1", [&](size_t i) {
+        char buf[ChordDetector::CHORD_NAME_CAPACITY];
+        PackedChordResult chord = analyze_chord_fast(four_notes.chord(i), four_notes.count(i), true);
+        do_not_optimize(format_chord(chord, buf, sizeof(buf)));
+    });
+
+    runner.run("analyze_chord_candidates/notes:4", [&](size_t i) {
+        CandidateBuffer<8> candidates;
+        analyze_chord_candidates(four_notes.chord(i), four_notes.count(i), candidates);
+        do_not_optimize(candidates);
+    });
+
+    // Pattern search per (pitch-class set, bass), as run for every table slot and every memo cache miss;
+    // the pair computes the plain and slash winners from one candidate pass
+    for (bool use_slash : {false, true}) {
+        runner.run(std::string("search_pitch_class_set/notes:4") + (use_slash ? "/slash:1" : "/slash:0"), [&](size_t i) {
+            size_t c = i & (ChordPool::SIZE - 1);
+            do_not_optimize(ChordDetector::search_pitch_class_set(four_notes.pc_masks[c], four_notes.bass_pcs[c], use_slash));
+        });
+    }
+    runner.run("search_pitch_class_set_pair/notes:4", [&](size_t i) {
+        size_t c = i & (ChordPool::SIZE - 1);
+        do_not_optimize(ChordDetector::search_pitch_class_set_pair(four_notes.pc_masks[c], four_notes.bass_pcs[c]));
+    });
+
+    // Custom vocabularies: precomputed table vs. pattern search behind the thread-local memo cache.
+    // distinct:128 repeats a few voicings like real material; distinct:1024 overflows the cache.
+    ChordDictionary table_dictionary;
+    ChordDictionary cached_dictionary(nullptr, 0, true, ChordDictionary::Mode::Cached);
+    runner.run("ChordDictionary/table/notes:4/slash:1", [&](size_t i) {
+        do_not_optimize(analyze_chord_fast(table_dictionary, four_notes.chord(i), four_notes.count(i), true));
+    });
+    for (size_t distinct : {size_t(128), ChordPool::SIZE}) {
+        runner.run("ChordDictionary/cached/distinct:" + std::to_string(distinct) + "/slash:1", [&](size_t i) {
+            size_t c = i % distinct;
+            do_not_optimize(analyze_chord_fast(cached_dictionary, four_notes.chord(c), four_notes.count(c), true));
+        });
+    }
+
+    // Batch APIs, reported per chord
+    std::vector<PackedChordResult> out(ChordPool::SIZE);
+    for (bool use_slash : {false, true}) {
+        std::string slash = use_slash ? "/slash:1" : "/slash:0";
+        runner.run("analyze_chords_batch/masks:1024" + slash, [&](size_t) {
+            analyze_chords_batch(four_notes.pc_masks.data(), four_notes.bass_pcs.data(), ChordPool::SIZE, out.data(),
+                                 use_slash);
+            do_not_optimize(out[0]);
+        }, ChordPool::SIZE);
+        runner.run("analyze_chords_batch/notes:1024" + slash, [&](size_t) {
+            analyze_chords_batch(four_notes.notes.data(), four_notes.offsets.data(), ChordPool::SIZE, out.data(),
+                                 use_slash);
+            do_not_optimize(out[0]);
+        }, ChordPool::SIZE);
+    }
+
+    // Live input, reported per note event
+    std::vector<NoteEvent> events = event_stream(4096, 11);
+    for (bool use_slash : {false, true}) {
+        ChordTracker tracker(use_slash);
+        runner.run(std::string("ChordTracker/apply") + (use_slash ? "/slash:1" : "/slash:0"), [&](size_t i) {
+            do_not_optimize(tracker.apply(events[i % events.size()]));
+        });
+    }
+
+    // 128 channels playing at once, interleaved by tick and processed in blocks of 256; reported per event
+    std::vector<NoteEvent> multi_channel;
+    for (uint8_t channel = 0; channel < 128; ++channel) {
+        for (NoteEvent event : event_stream(64, 100 + channel)) {
+            event.channel = channel;
+            multi_channel.push_back(event);
+        }
+    }
+    std::stable_sort(multi_channel.begin(), multi_channel.end(),
+                     [](const NoteEvent& a, const NoteEvent& b) { return a.tick < b.tick; });
+    constexpr size_t BLOCK = 256;
+    size_t blocks = multi_channel.size() / BLOCK;
+    std::vector<ChordTracker> channel_trackers(128, ChordTracker(true));
+    runner.run("ChordTracker[128]/apply/slash:1", [&](size_t i) {
+        const NoteEvent* block = multi_channel.data() + (i % blocks) * BLOCK;
+        for (size_t e = 0; e < BLOCK; ++e) do_not_optimize(channel_trackers[block[e].channel].apply(block[e]));
+    }, BLOCK);
+    ChordDetector::ChordTrackerBank bank(128, true);
+    runner.run("ChordTrackerBank/process/slash:1", [&](size_t i) {
+        do_not_optimize(bank.process(multi_channel.data() + (i % blocks) * BLOCK, BLOCK));
+    }, BLOCK);
+    ChordDetector::ChordTrackerBank merged_bank(128, true);
+    for (uint32_t channel = 0; channel < 128; channel += 2) merged_bank.merge({channel, channel + 1});
+    runner.run("ChordTrackerBank/process/merged:64/slash:1", [&](size_t i) {
+        do_not_optimize(merged_bank.process(multi_channel.data() + (i % blocks) * BLOCK, BLOCK));
+    }, BLOCK);
+
+    // Live input with key tracking: chord tracker plus O(1) key window update per event
+    ChordDetector::ChordKeyTracker key_tracker(true);
+    runner.run("ChordKeyTracker/apply/slash:1", [&](size_t i) {
+        do_not_optimize(key_tracker.apply(events[i % events.size()]));
+    });
+    runner.run("ChordKeyTracker/apply+key/slash:1", [&](size_t i) {
+        key_tracker.apply(events[i % events.size()]);
+        do_not_optimize(key_tracker.key());
+    });
+
+    // Audio front end: random chroma frames, reported per frame
+    std::mt19937 chroma_rng(13);
+    std::uniform_real_distribution<float> level(0.0f, 1.0f);
+    std::vector<float> chroma(ChordPool::SIZE * 12), bass_chroma(ChordPool::SIZE * 12);
+    for (float& bin : chroma) bin = level(chroma_rng);
+    for (float& bin : bass_chroma) bin = level(chroma_rng);
+    ChordDetector::ChromaChordDetector chroma_detector;
+    runner.run("ChromaChordDetector/analyze", [&](size_t i) {
+        size_t frame = (i & (ChordPool::SIZE - 1)) * 12;
+        do_not_optimize(chroma_detector.analyze(chroma.data() + frame, bass_chroma.data() + frame));
+    });
+    runner.run("ChromaChordDetector/analyze_block:1024", [&](size_t) {
+        chroma_detector.analyze_block(chroma.data(), bass_chroma.data(), ChordPool::SIZE, 12, out.data());
+        do_not_optimize(out[0]);
+    }, ChordPool::SIZE);
+
+    // One second of 48 kHz audio at a 128-sample hop (375 frames), as an interleaved [chroma | bass] feature matrix;
+    // reported per second of audio, so ns/op over 1e9 is the fraction of one core real-time tracking needs
+    constexpr size_t hop_frames = 48000 / 128;
+    std::vector<float> features(hop_frames * 24);
+    for (float& bin : features) bin = level(chroma_rng);
+    std::vector<PackedChordResult> hop_out(hop_frames);
+    runner.run("ChromaChordDetector/analyze_block:1s@48kHz/hop:128", [&](size_t) {
+        chroma_detector.analyze_block(features.data(), features.data() + 12, hop_frames, 24, hop_out.data());
+        do_not_optimize(hop_out[0]);
+    });
+
+    // Sequence decoding of per-frame top-K candidates, reported per frame
+    std::vector<ScoredChord> scored(ChordPool::SIZE * 8);
+    std::vector<size_t> scored_counts(ChordPool::SIZE);
+    for (size_t i = 0; i < ChordPool::SIZE; ++i) {
+        CandidateBuffer<8> candidates;
+        analyze_chord_candidates(four_notes.chord(i / 8), four_notes.count(i / 8), candidates);   // Chords last 8 frames
+        scored_counts[i] = ChordDetector::scored_candidates(candidates, scored.data() + i * 8, true);
+    }
+    ChordDetector::ChordSequenceDecoder decoder;
+    runner.run("ChordSequenceDecoder/push/lag:8", [&](size_t i) {
+        size_t frame = i & (ChordPool::SIZE - 1);
+        do_not_optimize(decoder.push(scored.data() + frame * 8, scored_counts[frame]));
+    });
+
+    // Progression features per chord: numeral, root motion, voice leading from the previous voicing
+    std::vector<PackedChordResult> progression_chords(ChordPool::SIZE);
+    analyze_chords_batch(four_notes.notes.data(), four_notes.offsets.data(), ChordPool::SIZE, progression_chords.data(), true);
+    ChordDetector::ProgressionAnalyzer progression;
+    runner.run("ProgressionAnalyzer/push/notes:4", [&](size_t i) {
+        ChordDetector::ProgressionStep step;
+        size_t c = i & (ChordPool::SIZE - 1);
+        progression.push(progression_chords[c], four_notes.chord(c), four_notes.count(c), step);
+        do_not_optimize(step);
+    });
+
+    // Binary annotations: encoding and decoding one chord change per record, 480 ticks apart
+    ChordDetector::AnnotationWriter annotation_writer;
+    runner.run("AnnotationWriter/add", [&](size_t i) {
+        do_not_optimize(annotation_writer.add(uint64_t(i) * 480, progression_chords[i & (ChordPool::SIZE - 1)]));
+    });
+    ChordDetector::AnnotationWriter annotation_source;
+    for (size_t i = 0; i < 64 * ChordPool::SIZE; ++i) annotation_source.add(uint64_t(i) * 480, progression_chords[i & (ChordPool::SIZE - 1)]);
+    const std::vector<uint8_t>& annotation = annotation_source.finish();
+    ChordDetector::AnnotationReader annotation_reader(annotation.data(), annotation.size());
+    runner.run("AnnotationReader/next", [&](size_t) {
+        ChordDetector::ChordChange change;
+        if (!annotation_reader.next(change)) annotation_reader.rewind();
+        do_not_optimize(change);
+    });
+    runner.run("AnnotationReader/seek", [&](size_t i) {
+        do_not_optimize(annotation_reader.seek((i * 2654435761u) % (64 * ChordPool::SIZE * 480)));
+    });
+
+    // Real-time budget: single calls over dense, unmatched and random voicings, warm and from cold caches
+    std::vector<const ChordPool*> adversarial = {&pools[10], &no_match, &four_notes, &pools[1]};
+    auto mixed = [&](size_t i) -> const ChordPool& { return *adversarial[i & 3]; };
+    for (bool evict : {false, true}) {
+        std::string cache = evict ? "/cold" : "/warm";
+        runner.run_worst_case("analyze_chord_realtime/slash:1" + cache, [&](size_t i) {
+            do_not_optimize(analyze_chord_realtime(mixed(i).chord(i >> 2), mixed(i).count(i >> 2), true));
+        }, evict);
+        runner.run_worst_case("analyze_chord_realtime+format_chord/slash:1" + cache, [&](size_t i) {
+            char buf[ChordDetector::CHORD_NAME_CAPACITY];
+            PackedChordResult chord = analyze_chord_realtime(mixed(i).chord(i >> 2), mixed(i).count(i >> 2), true);
+            do_not_optimize(format_chord(chord, buf, sizeof(buf)).size());
+        }, evict);
+    }
+    runner.run_worst_case("analyze_chord_fast/slash:1/warm", [&](size_t i) {
+        do_not_optimize(analyze_chord_fast(mixed(i).chord(i >> 2), mixed(i).count(i >> 2), true));
+    }, false);
+
+    std::printf("\n");
+    bool within_budget = runner.check_budgets(budget_ns, cold_budget_ns);
+
+    if (json_path && !runner.write_json(json_path)) {
+        std::fprintf(stderr, "cannot write %s\n", json_path);
+        return 1;
+    }
+    return within_budget ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include "chord_detector.h"
+#include "chord_detector_c.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * Compiled chord detector library: the C ABI over the header's inline engine.
+ * The lookup tables come from chord_detector_tables.cpp, generated at build time.
+ */
+
+static_assert(sizeof(cd_result) == sizeof(PackedChordResult), "cd_result must mirror PackedChordResult");
+static_assert(offsetof(cd_result, pattern_id) == offsetof(PackedChordResult, pattern_id), "cd_result layout");
+static_assert(offsetof(cd_result, flags) == offsetof(PackedChordResult, flags), "cd_result layout");
+static_assert(CD_PATTERN_NONE == ChordDetector::PATTERN_NONE && CD_NO_PITCH_CLASS == ChordDetector::NO_PITCH_CLASS,
+              "C sentinels must match the C++ ones");
+static_assert(CD_FLAG_MATCHED == ChordDetector::CHORD_FLAG_MATCHED && CD_FLAG_SLASH == ChordDetector::CHORD_FLAG_SLASH,
+              "C flags must match the C++ ones");
+
+static_assert(CD_NAME_CAPACITY == ChordDetector::CHORD_NAME_CAPACITY, "C name capacity must match");
+
+namespace {
+    cd_result to_c(const PackedChordResult& chord) {
+        return {chord.root_pc, chord.bass_pc, chord.pattern_id, chord.flags};
+    }
+
+    // Results are produced in stack blocks and copied out; identical layouts make that a memcpy
+    constexpr size_t BATCH_BLOCK = 256;
+
+    // Pattern suffixes in pattern_id order, built once at compile time
+    struct SuffixTable {
+        const char* names[ChordDetector::NUM_PATTERNS];
+    };
+
+    constexpr SuffixTable make_suffix_table() {
+        SuffixTable table = {};
+        for (size_t i = 0; i < ChordDetector::NUM_PATTERNS; ++i) table.names[i] = ChordDetector::CHORD_PATTERNS[i].name;
+        return table;
+    }
+
+    constexpr SuffixTable SUFFIXES = make_suffix_table();
+}
+
+extern "C" {
+
+uint32_t cd_abi_version(void) {
+    return CD_ABI_VERSION;
+}
+
+cd_result cd_analyze(const int* notes, size_t count, int use_slash) {
+    int note_count = count > static_cast<size_t>(INT_MAX) ? INT_MAX : static_cast<int>(count);
+    return to_c(analyze_chord_fast(notes, note_count, use_slash != 0));
+}
+
+cd_result cd_lookup(uint16_t pc_mask, uint8_t bass_pc, int use_slash) {
+    int bass = bass_pc < 12 ? bass_pc : -1;
+    return to_c(ChordDetector::lookup_chord(pc_mask, bass, use_slash != 0));
+}
+
+void cd_analyze_batch(const uint16_t* pc_masks, const uint8_t* bass_pcs, size_t n, cd_result* out, int use_slash) {
+    PackedChordResult block[BATCH_BLOCK];
+    for (size_t begin = 0; begin < n; begin += BATCH_BLOCK) {
+        size_t count = n - begin < BATCH_BLOCK ? n - begin : BATCH_BLOCK;
+        analyze_chords_batch(pc_masks + begin, bass_pcs + begin, count, block, use_slash != 0);
+        std::memcpy(out + begin, block, count * sizeof(cd_result));
+    }
+}
+
+void cd_analyze_notes_batch(const int* notes, const size_t* offsets, size_t chord_count, cd_result* out,
+                            int use_slash) {
+    PackedChordResult block[BATCH_BLOCK];
+    for (size_t begin = 0; begin < chord_count; begin += BATCH_BLOCK) {
+        size_t count = chord_count - begin < BATCH_BLOCK ? chord_count - begin : BATCH_BLOCK;
+        analyze_chords_batch(notes, offsets + begin, count, block, use_slash != 0);
+        std::memcpy(out + begin, block, count * sizeof(cd_result));
+    }
+}
+
+size_t cd_format(const cd_result* chord, int use_flats, char* buf, size_t cap) {
+    if (!buf || cap == 0) return 0;
+    // Caller-owned results may hold anything; only in-range ones reach the note and suffix tables
+    if (!chord || chord->root_pc >= 12 || chord->pattern_id >= ChordDetector::NUM_PATTERNS ||
+        ((chord->flags & ChordDetector::CHORD_FLAG_SLASH) && chord->bass_pc >= 12)) {
+        buf[0] = '\0';
+        return 0;
+    }
+    PackedChordResult packed = {chord->root_pc, chord->bass_pc, chord->pattern_id, chord->flags};
+    return format_chord(packed, buf, cap, use_flats != 0).size();
+}
+
+size_t cd_pattern_count(void) {
+    return ChordDetector::NUM_PATTERNS;
+}
+
+const char* const* cd_pattern_suffixes(void) {
+    return SUFFIXES.names;
+}
+
+const char* cd_pattern_suffix(uint16_t pattern_id) {
+    return ChordDetector::pattern_suffix(pattern_id);
+}
+
+const char* cd_note_name(uint8_t pitch_class, int use_flats) {
+    if (pitch_class >= 12) return "";
+    return (use_flats ? ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP)[pitch_class];
+}
+
+}
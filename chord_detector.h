@@ -2,9 +2,17 @@
 
 #include <array>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 
+#ifdef CHORD_DETECTOR_STATS
+#include <mutex>
+#include <type_traits>
+#endif
+
 /**
  * Unified high-performance chord detector - optimized for real-time usage
  * Detects chord names from MIDI note numbers with optional slash chord support
@@ -17,8 +25,219 @@
  *
  *   // Slash chord detection
  *   std::string slash = get_chord_name({64, 67, 72}, false, true); // Returns "C/E"
+ *
+ *   // Allocation-free detection, names formatted only when displayed
+ *   PackedChordResult packed = analyze_chord_fast({64, 67, 72}, true);
+ *   char buf[ChordDetector::CHORD_NAME_CAPACITY];
+ *   std::string_view name = format_chord(packed, buf, sizeof(buf)); // "C/E"
+ *
+ * Header-only by default. Linking chord_detector_static / chord_detector_shared instead defines
+ * CHORD_DETECTOR_PRECOMPUTED_TABLES and takes the lookup tables from the library's .rodata.
  */
 
+// Symbol visibility for the compiled library
+#ifndef CHORD_DETECTOR_API
+#if defined(_WIN32) && defined(CHORD_DETECTOR_SHARED)
+#ifdef CHORD_DETECTOR_BUILDING
+#define CHORD_DETECTOR_API __declspec(dllexport)
+#else
+#define CHORD_DETECTOR_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+#define CHORD_DETECTOR_API __attribute__((visibility("default")))
+#else
+#define CHORD_DETECTOR_API
+#endif
+#endif
+
+// Opt-in hot-path counters. Define CHORD_DETECTOR_STATS for the whole program (CMake option
+// CHORD_DETECTOR_STATS) to enable them; otherwise every hook compiles to nothing and stats() is all zeros.
+// Each thread counts into its own block with plain relaxed load + store (no atomic read-modify-write);
+// stats() sums the blocks of all threads, including exited ones, when asked.
+namespace ChordDetector {
+    enum class Counter : uint8_t {
+        AnalyzeChord,               // Calls per API; wrappers count their inner calls too
+        GetChordName,
+        GetChordNameView,
+        AnalyzeChordFast,
+        AnalyzeChordRealtime,
+        AnalyzeChordTolerant,
+        AnalyzeChordCandidates,
+        DetailedAnalysis,
+        BatchCalls,
+        BatchChords,                // Chords analyzed by batch calls
+        ReferenceCalls,             // analyze_chord_reference
+        TableLookups,               // (pitch-class set, bass) table probes, any engine
+        RootsPassed,                // Roots that are present with at least 2 intervals
+        PatternCompares,            // Patterns compared (reference scan) or probed (pattern index)
+        SlashOverrides,             // Weak winners (priority < 50) replaced by a slash reading
+        SentinelHits,               // "?" readings: skipped candidates, or the reference C-D-F special case
+        TrackerHits,                // ChordTracker events that kept the current chord without a lookup
+        TrackerMisses,              // ChordTracker events that looked the chord up again
+        MemoHits,                   // Memo cache lookups answered from the cache
+        MemoMisses,                 // Memo cache lookups that ran the pattern search
+        Count
+    };
+
+    constexpr size_t NUM_COUNTERS = static_cast<size_t>(Counter::Count);
+
+    constexpr const char* counter_name(Counter counter) {
+        constexpr const char* names[NUM_COUNTERS] = {
+            "analyze_chord", "get_chord_name", "get_chord_name_view", "analyze_chord_fast", "analyze_chord_realtime",
+            "analyze_chord_tolerant", "analyze_chord_candidates", "detailed_analysis", "batch_calls", "batch_chords",
+            "reference_calls", "table_lookups", "roots_passed", "pattern_compares", "slash_overrides", "sentinel_hits",
+            "tracker_hits", "tracker_misses", "memo_hits", "memo_misses"};
+        return counter < Counter::Count ? names[static_cast<size_t>(counter)] : "";
+    }
+
+    // Snapshot of the counters
+    struct Stats {
+        uint64_t counts[NUM_COUNTERS] = {};
+
+        uint64_t operator[](Counter counter) const { return counts[static_cast<size_t>(counter)]; }
+
+        Stats& operator+=(const Stats& other) {
+            for (size_t i = 0; i < NUM_COUNTERS; ++i) counts[i] += other.counts[i];
+            return *this;
+        }
+
+        Stats& operator-=(const Stats& other) {
+            for (size_t i = 0; i < NUM_COUNTERS; ++i) counts[i] -= other.counts[i];
+            return *this;
+        }
+    };
+
+#ifdef CHORD_DETECTOR_STATS
+    constexpr bool STATS_ENABLED = true;
+
+    namespace detail {
+        struct ThreadCounters;
+
+        struct StatsRegistry {
+            std::mutex mutex;
+            ThreadCounters* head = nullptr;     // Live threads
+            Stats retired;                      // Sum of exited threads
+            Stats baseline;                     // Aggregate at the last reset_stats()
+        };
+
+        inline StatsRegistry& stats_registry() {
+            static StatsRegistry registry;
+            return registry;
+        }
+
+        // Written only by its own thread; other threads read it with relaxed loads
+        struct ThreadCounters {
+            std::atomic<uint64_t> counts[NUM_COUNTERS];
+            ThreadCounters* next = nullptr;
+            bool paused = false;                // Set while building tables
+
+            ThreadCounters() {
+                for (std::atomic<uint64_t>& count : counts) count.store(0, std::memory_order_relaxed);
+                StatsRegistry& registry = stats_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                next = registry.head;
+                registry.head = this;
+            }
+
+            ~ThreadCounters() {
+                StatsRegistry& registry = stats_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.retired += snapshot();
+                for (ThreadCounters** link = &registry.head; *link; link = &(*link)->next) {
+                    if (*link == this) {
+                        *link = next;
+                        break;
+                    }
+                }
+            }
+
+            Stats snapshot() const {
+                Stats stats;
+                for (size_t i = 0; i < NUM_COUNTERS; ++i) stats.counts[i] = counts[i].load(std::memory_order_relaxed);
+                return stats;
+            }
+        };
+
+        inline ThreadCounters& thread_counters() {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+
+        inline void add_count(Counter counter, uint64_t n) {
+            ThreadCounters& counters = thread_counters();
+            if (counters.paused) return;
+            std::atomic<uint64_t>& count = counters.counts[static_cast<size_t>(counter)];
+            count.store(count.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        // Callable from constexpr functions; nothing is counted during constant evaluation
+        constexpr void count(Counter counter, uint64_t n) {
+#if defined(__cpp_lib_is_constant_evaluated)
+            if (!std::is_constant_evaluated()) add_count(counter, n);
+#else
+            if (!__builtin_is_constant_evaluated()) add_count(counter, n);
+#endif
+        }
+
+        // Suspends counting on this thread for its lifetime (table construction is not traffic)
+        class StatsPause {
+        public:
+            StatsPause() : counters_(thread_counters()), previous_(counters_.paused) { counters_.paused = true; }
+            ~StatsPause() { counters_.paused = previous_; }
+            StatsPause(const StatsPause&) = delete;
+            StatsPause& operator=(const StatsPause&) = delete;
+
+        private:
+            ThreadCounters& counters_;
+            bool previous_;
+        };
+
+        inline Stats aggregate_stats() {
+            StatsRegistry& registry = stats_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            Stats total = registry.retired;
+            for (ThreadCounters* counters = registry.head; counters; counters = counters->next) {
+                total += counters->snapshot();
+            }
+            return total;
+        }
+    }
+
+    // Sum over all threads since the last reset_stats()
+    inline Stats stats() {
+        Stats total = detail::aggregate_stats();
+        std::lock_guard<std::mutex> lock(detail::stats_registry().mutex);
+        total -= detail::stats_registry().baseline;
+        return total;
+    }
+
+    // Calling thread only, since the thread started (reset_stats() does not affect it)
+    inline Stats thread_stats() {
+        return detail::thread_counters().snapshot();
+    }
+
+    // Start stats() from zero again; counters are only ever written by their own threads
+    inline void reset_stats() {
+        Stats total = detail::aggregate_stats();
+        std::lock_guard<std::mutex> lock(detail::stats_registry().mutex);
+        detail::stats_registry().baseline = total;
+    }
+}
+
+#define CHORD_DETECTOR_COUNT(counter, n) ::ChordDetector::detail::count(::ChordDetector::Counter::counter, (n))
+#define CHORD_DETECTOR_STATS_PAUSE() ::ChordDetector::detail::StatsPause chord_detector_stats_pause_
+#else
+    constexpr bool STATS_ENABLED = false;
+
+    inline Stats stats() { return Stats(); }
+    inline Stats thread_stats() { return Stats(); }
+    inline void reset_stats() {}
+}
+
+#define CHORD_DETECTOR_COUNT(counter, n) ((void)0)
+#define CHORD_DETECTOR_STATS_PAUSE() ((void)0)
+#endif
+
 // Chord analysis result structure
 struct ChordResult {
     std::string full_name;      // Complete chord name (e.g., "C/E", "Am7", "G")
@@ -29,6 +248,63 @@ struct ChordResult {
     int bass_pitch_class;       // Bass note (0-11)
 };
 
+// Compact chord analysis result - trivially copyable, no heap storage
+struct PackedChordResult {
+    uint8_t root_pc;            // Root note (0-11), ChordDetector::NO_PITCH_CLASS if nothing matched
+    uint8_t bass_pc;            // Bass note (0-11), ChordDetector::NO_PITCH_CLASS if no valid notes
+    uint16_t pattern_id;        // Index into CHORD_PATTERNS, or a ChordDetector::PATTERN_* sentinel
+    uint16_t flags;             // ChordDetector::CHORD_FLAG_* bits
+};
+
+// One (root, pattern) interpretation of a chord
+struct ChordCandidate {
+    uint8_t root_pc;            // Root note (0-11)
+    uint8_t bass_pc;            // Bass note (0-11)
+    uint16_t pattern_id;        // Index into the pattern table
+    int16_t priority;           // Effective priority (pattern priority, +30 in root position)
+    uint16_t flags;             // CHORD_FLAG_MATCHED, plus CHORD_FLAG_SLASH when root != bass
+};
+
+// A chord reading with a caller-defined score (higher is better), e.g. for sequence decoding
+struct ScoredChord {
+    PackedChordResult chord;
+    float score;
+};
+
+// Fixed-capacity candidate list ranked by priority (highest first); equal priorities keep insertion order.
+// Lives on the stack; candidates beyond the capacity are dropped.
+template<size_t K>
+class CandidateBuffer {
+public:
+    static constexpr size_t CAPACITY = K;
+
+    constexpr CandidateBuffer() : items_{}, count_(0) {}
+
+    constexpr void clear() { count_ = 0; }
+    constexpr size_t size() const { return count_; }
+    constexpr bool empty() const { return count_ == 0; }
+    constexpr const ChordCandidate& operator[](size_t i) const { return items_[i]; }
+    const ChordCandidate* begin() const { return items_; }
+    const ChordCandidate* end() const { return items_ + count_; }
+
+    // Returns false if the candidate ranked below a full buffer
+    constexpr bool push(const ChordCandidate& candidate) {
+        size_t pos = count_;
+        while (pos > 0 && items_[pos - 1].priority < candidate.priority) --pos;
+        if (pos >= K) return false;
+
+        size_t last = count_ < K ? count_ : K - 1;
+        for (size_t i = last; i > pos; --i) items_[i] = items_[i - 1];
+        items_[pos] = candidate;
+        if (count_ < K) ++count_;
+        return true;
+    }
+
+private:
+    ChordCandidate items_[K > 0 ? K : 1];
+    size_t count_;
+};
+
 namespace ChordDetector {
     // Maximum number of notes we can handle
     constexpr int MAX_NOTES = 12;
@@ -41,7 +317,7 @@ namespace ChordDetector {
     };
 
     // Enhanced chord patterns with omit5 and add11 support
-    constexpr ChordPattern CHORD_PATTERNS[] = {
+    inline constexpr ChordPattern CHORD_PATTERNS[] = {
         // Extended chords (highest priority due to specificity)
         {(1<<0)|(1<<2)|(1<<4)|(1<<5)|(1<<7)|(1<<10), "11",     100},  // Dom11: R,M2,M3,P4,P5,m7
         {(1<<0)|(1<<2)|(1<<4)|(1<<5)|(1<<7)|(1<<11), "M11",  100},  // Maj11: R,M2,M3,P4,P5,M7
@@ -151,16 +427,16 @@ namespace ChordDetector {
     constexpr size_t NUM_PATTERNS = sizeof(CHORD_PATTERNS) / sizeof(ChordPattern);
 
     // Note name lookup tables
-    constexpr const char* NOTE_NAMES_SHARP[] = {
+    inline constexpr const char* NOTE_NAMES_SHARP[] = {
         "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
     };
 
-    constexpr const char* NOTE_NAMES_FLAT[] = {
+    inline constexpr const char* NOTE_NAMES_FLAT[] = {
         "C", "Db", "D", "Eb", "E", "F", "Gb", "G", "Ab", "A", "Bb", "B"
     };
 
     // Optimized interval calculation and sorting
-    inline void insertion_sort(int* arr, int n) {
+    constexpr void insertion_sort(int* arr, int n) {
         for (int i = 1; i < n; ++i) {
             int key = arr[i];
             int j = i - 1;
@@ -173,11 +449,11 @@ namespace ChordDetector {
     }
 
     // Create interval bitmask from sorted intervals
-    inline uint16_t create_interval_mask(const int* intervals, int count) {
+    constexpr uint16_t create_interval_mask(const int* intervals, int count) {
         uint16_t mask = 0;
         for (int i = 0; i < count; ++i) {
             if (intervals[i] >= 0 && intervals[i] < 12) {
-                mask |= (1 << intervals[i]);
+                mask |= static_cast<uint16_t>(1 << intervals[i]);
             }
         }
         return mask;
@@ -221,6 +497,8 @@ namespace ChordDetector {
             }
 
             if (!has_root || interval_count < 2) continue;
+            CHORD_DETECTOR_COUNT(RootsPassed, 1);
+            CHORD_DETECTOR_COUNT(PatternCompares, NUM_PATTERNS);
 
             insertion_sort(intervals, interval_count);
             uint16_t mask = create_interval_mask(intervals, interval_count);
@@ -237,6 +515,7 @@ namespace ChordDetector {
                     if (strcmp(pattern.name, "?") == 0) {
                         // For C-D-F (intervals 0,2,5 from C), this should be Dm/C
                         if (mask == ((1<<0)|(1<<2)|(1<<5))) { // M2 + P4 from bass
+                            CHORD_DETECTOR_COUNT(SentinelHits, 1);
                             // Check if it forms a minor chord from the second note
                             int second_note = (bass_pitch_class + 2) % 12; // D if bass is C
                             bool forms_minor = true;
@@ -276,127 +555,1413 @@ namespace ChordDetector {
 
         return best_result;
     }
-}
 
-// Main chord analysis function - enhanced for omit5 and add11
-ChordResult analyze_chord(const int* midi_notes, int note_count, bool use_flats = false, bool use_slash = false) {
-    ChordResult result = {"", "", "", false, -1, -1};
+    // Reference chord analysis - the original per-call root/pattern scan.
+    // Kept as the specification the lookup table is validated against.
+    inline ChordResult analyze_chord_reference(const int* midi_notes, int note_count, bool use_flats = false, bool use_slash = false) {
+        ChordResult result = {"", "", "", false, -1, -1};
+        CHORD_DETECTOR_COUNT(ReferenceCalls, 1);
 
-    if (note_count <= 0) return result;
+        if (note_count <= 0) return result;
 
-    const char* const* note_names = use_flats ?
-        ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP;
+        const char* const* note_names = use_flats ?
+            NOTE_NAMES_FLAT : NOTE_NAMES_SHARP;
+
+        // Find bass note (lowest MIDI note for slash chord detection)
+        int bass_midi = midi_notes[0];
+        for (int i = 1; i < note_count; ++i) {
+            if (midi_notes[i] < bass_midi) {
+                bass_midi = midi_notes[i];
+            }
+        }
+        int bass_pitch_class = bass_midi % 12;
+
+        // Try each note as root
+        int best_priority = -1;
+        ChordResult best_slash_result = {"", "", "", false, -1, -1};
+
+        for (int root_candidate = 0; root_candidate < 12; ++root_candidate) {
+            // Build intervals from this root
+            int intervals[MAX_NOTES];
+            int interval_count = 0;
+            bool has_root = false;
+
+            for (int i = 0; i < note_count; ++i) {
+                int midi = midi_notes[i];
+                if (midi < 0 || midi > 127) continue;
+
+                int pc = midi % 12;
+                int interval = (pc - root_candidate + 12) % 12;
+
+                if (interval == 0) has_root = true;
+
+                // Add interval if not already present
+                bool already_present = false;
+                for (int j = 0; j < interval_count; ++j) {
+                    if (intervals[j] == interval) {
+                        already_present = true;
+                        break;
+                    }
+                }
+                if (!already_present && interval_count < MAX_NOTES) {
+                    intervals[interval_count++] = interval;
+                }
+            }
+
+            if (!has_root || interval_count < 2) continue;
+            CHORD_DETECTOR_COUNT(RootsPassed, 1);
+            CHORD_DETECTOR_COUNT(PatternCompares, NUM_PATTERNS);
+
+            insertion_sort(intervals, interval_count);
+            uint16_t mask = create_interval_mask(intervals, interval_count);
 
-    // Find bass note (lowest MIDI note for slash chord detection)
-    int bass_midi = midi_notes[0];
-    for (int i = 1; i < note_count; ++i) {
-        if (midi_notes[i] < bass_midi) {
-            bass_midi = midi_notes[i];
+            // Find best pattern match
+            for (size_t p = 0; p < NUM_PATTERNS; ++p) {
+                const ChordPattern& pattern = CHORD_PATTERNS[p];
+
+                if (pattern.mask != mask) continue;
+
+                int priority = pattern.priority;
+
+                // Bonus for root position (root = bass)
+                if (root_candidate == bass_pitch_class) {
+                    priority += 30;
+                }
+
+                if (priority > best_priority) {
+                    std::string root_name = note_names[root_candidate];
+                    std::string bass_name = note_names[bass_pitch_class];
+
+                    bool is_slash = (root_candidate != bass_pitch_class) && use_slash;
+
+                    result = {
+                        is_slash ? root_name + pattern.name + "/" + bass_name : root_name + pattern.name,
+                        root_name + pattern.name,
+                        bass_name,
+                        is_slash,
+                        root_candidate,
+                        bass_pitch_class
+                    };
+                    best_priority = priority;
+                }
+            }
         }
+
+        // Enhanced slash chord analysis for special cases
+        if (use_slash) {
+            ChordResult slash_result = analyze_for_slash_chord(
+                midi_notes, note_count, bass_pitch_class, note_names);
+
+            // Use slash result if it has higher priority or if no root position found
+            if (!slash_result.full_name.empty() &&
+                (slash_result.root_pitch_class != slash_result.bass_pitch_class) &&
+                best_priority < 50) {
+                CHORD_DETECTOR_COUNT(SlashOverrides, 1);
+                result = slash_result;
+            }
+        }
+
+        return result;
     }
-    int bass_pitch_class = bass_midi % 12;
 
-    // Try each note as root
-    int best_priority = -1;
-    ChordResult best_slash_result = {"", "", "", false, -1, -1};
+    // Pattern id sentinels used by the lookup table
+    constexpr uint16_t PATTERN_NONE = 0xFFFF;          // No pattern matched
+    constexpr uint8_t NO_PITCH_CLASS = 0xFF;
+
+    // PackedChordResult flags
+    constexpr uint16_t CHORD_FLAG_MATCHED = 1 << 0;    // A pattern matched (pattern_id is valid)
+    constexpr uint16_t CHORD_FLAG_SLASH = 1 << 1;      // Written as a slash chord (bass != root)
+
+    // Buffer size that fits any formatted chord name, including the terminating NUL
+    constexpr size_t CHORD_NAME_CAPACITY = 32;
+
+    // Optional outputs of analyze_chord, to_chord_result and get_detailed_analysis. Pitch classes and
+    // the slash flag are always filled; skipped strings stay empty and skipped arrays get no entries.
+    constexpr uint32_t FIELD_FULL_NAME = 1 << 0;       // "C/E"
+    constexpr uint32_t FIELD_CHORD_NAME = 1 << 1;      // "C"
+    constexpr uint32_t FIELD_BASS_NOTE = 1 << 2;       // "E"
+    constexpr uint32_t FIELD_NOTE_NAMES = 1 << 3;      // Detailed analysis: note names
+    constexpr uint32_t FIELD_INTERVALS = 1 << 4;       // Detailed analysis: intervals from the root
+    constexpr uint32_t FIELD_INVERSION = 1 << 5;       // Detailed analysis: inversion_type string
+    constexpr uint32_t FIELDS_NONE = 0;
+    constexpr uint32_t FIELDS_NAMES = FIELD_FULL_NAME | FIELD_CHORD_NAME | FIELD_BASS_NOTE;
+    constexpr uint32_t FIELDS_ALL = FIELDS_NAMES | FIELD_NOTE_NAMES | FIELD_INTERVALS | FIELD_INVERSION;
+
+    // String equality usable in constant expressions
+    constexpr bool names_equal(const char* a, const char* b) {
+        while (*a && *a == *b) {
+            ++a;
+            ++b;
+        }
+        return *a == *b;
+    }
+
+    // Number of pitch classes in a 12-bit mask
+    constexpr int count_pitch_classes(uint16_t mask) {
+        int count = 0;
+        for (; mask; mask &= static_cast<uint16_t>(mask - 1)) ++count;
+        return count;
+    }
+
+    // Index of the lowest set bit of a non-zero word
+    inline int lowest_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(bits);
+#else
+        int index = 0;
+        while (!(bits & 1)) {
+            bits >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
 
-    for (int root_candidate = 0; root_candidate < 12; ++root_candidate) {
-        // Build intervals from this root
-        int intervals[ChordDetector::MAX_NOTES];
-        int interval_count = 0;
-        bool has_root = false;
+    // Interval bitmask of a pitch-class set seen from the given root
+    constexpr uint16_t rotate_mask(uint16_t pc_mask, int root) {
+        return static_cast<uint16_t>(((pc_mask >> root) | (pc_mask << (12 - root))) & 0xFFF);
+    }
 
+    // Pitch-class set of the valid notes (0-127); bass is the lowest valid note's pitch class, -1 if none
+    constexpr uint16_t pitch_class_mask(const int* midi_notes, int note_count, int& bass_pitch_class) {
+        uint16_t mask = 0;
+        int bass_midi = 128;
         for (int i = 0; i < note_count; ++i) {
             int midi = midi_notes[i];
             if (midi < 0 || midi > 127) continue;
+            mask |= static_cast<uint16_t>(1 << (midi % 12));
+            if (midi < bass_midi) bass_midi = midi;
+        }
+        bass_pitch_class = bass_midi < 128 ? bass_midi % 12 : -1;
+        return mask;
+    }
+
+    // Note slots scanned by analyze_chord_realtime
+    constexpr int REALTIME_MAX_NOTES = 16;
+
+    // Pitch class of each MIDI note, avoiding a division on the real-time path
+    inline constexpr std::array<uint8_t, 128> MIDI_PITCH_CLASS = [] {
+        std::array<uint8_t, 128> table = {};
+        for (int midi = 0; midi < 128; ++midi) table[midi] = static_cast<uint8_t>(midi % 12);
+        return table;
+    }();
+
+    // Hides a value from the optimizer; keeps it from cutting fixed-work loops short
+    inline uint32_t opaque(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm("" : "+r"(value));
+#endif
+        return value;
+    }
+
+    // pitch_class_mask over a fixed REALTIME_MAX_NOTES slots without branches. Returns the bass pitch
+    // class, NO_PITCH_CLASS if no note is valid. Slots past note_count re-read note 0 and are masked off;
+    // the slot mask is hidden from the optimizer so it cannot turn them back into an early exit.
+    inline uint8_t realtime_voicing(const int* midi_notes, int note_count, uint16_t& pc_mask) {
+        int no_note = -1;
+        const int* notes = note_count > 0 ? midi_notes : &no_note;
+        int used = note_count < 0 ? 0 : (note_count > REALTIME_MAX_NOTES ? REALTIME_MAX_NOTES : note_count);
+        uint32_t slots = opaque((uint32_t(1) << used) - 1);
+        uint32_t mask = 0;
+        uint32_t bass_midi = 255;
+        for (int i = 0; i < REALTIME_MAX_NOTES; ++i) {
+            uint32_t in_use = (slots >> i) & 1;
+            uint32_t midi = static_cast<uint32_t>(notes[i & -static_cast<int>(in_use)]);
+            uint32_t valid = static_cast<uint32_t>(midi < 128) & in_use;
+            uint32_t clamped = midi & 127;
+            mask |= valid << MIDI_PITCH_CLASS[clamped];
+            uint32_t candidate = clamped | ((valid ^ 1) << 7);     // 128 or more when not valid
+            bass_midi = candidate < bass_midi ? candidate : bass_midi;
+        }
+        pc_mask = static_cast<uint16_t>(mask);
+        uint32_t missing = bass_midi >> 7;
+        return static_cast<uint8_t>(MIDI_PITCH_CLASS[bass_midi & 127] | (missing * NO_PITCH_CLASS));
+    }
+
+    // Winning reading for one (pitch-class set, bass) pair
+    struct LookupEntry {
+        uint16_t pattern_id;    // Index into CHORD_PATTERNS, or a PATTERN_* sentinel
+        uint8_t root_pc;        // Root pitch class (0-11), NO_PITCH_CLASS if nothing matched
+        uint8_t flags;          // CHORD_FLAG_* bits of the reading
+        int16_t priority;       // Effective priority of the winner (including root position bonus)
+    };
+
+    // Collision-free index from interval mask to patterns, generated at compile time.
+    // best[mask] is the highest priority pattern with that mask (the earliest table entry wins ties);
+    // order[first[mask] .. first[mask + 1]) lists every pattern with that mask in table order.
+    template<size_t N>
+    struct PatternIndex {
+        static constexpr size_t NUM_MASKS = 1 << 12;
+
+        uint16_t best[NUM_MASKS] = {};
+        uint16_t first[NUM_MASKS + 1] = {};
+        uint16_t order[N] = {};
+    };
+
+    template<size_t N>
+    constexpr PatternIndex<N> build_pattern_index(const ChordPattern (&patterns)[N]) {
+        PatternIndex<N> index;
+        for (size_t mask = 0; mask < index.NUM_MASKS; ++mask) index.best[mask] = PATTERN_NONE;
+
+        // Counting sort by mask keeps table order within each bucket
+        for (size_t p = 0; p < N; ++p) ++index.first[(patterns[p].mask & 0xFFF) + 1];
+        for (size_t mask = 0; mask < index.NUM_MASKS; ++mask) index.first[mask + 1] += index.first[mask];
+
+        uint16_t fill[PatternIndex<N>::NUM_MASKS] = {};
+        for (size_t p = 0; p < N; ++p) {
+            size_t mask = patterns[p].mask & 0xFFF;
+            index.order[index.first[mask] + fill[mask]++] = static_cast<uint16_t>(p);
+
+            uint16_t current = index.best[mask];
+            if (current == PATTERN_NONE || patterns[p].priority > patterns[current].priority) {
+                index.best[mask] = static_cast<uint16_t>(p);
+            }
+        }
+        return index;
+    }
+
+    inline constexpr PatternIndex<NUM_PATTERNS> PATTERN_INDEX = build_pattern_index(CHORD_PATTERNS);
+    static_assert(PATTERN_INDEX.first[PATTERN_INDEX.NUM_MASKS] == NUM_PATTERNS, "Every pattern is indexed once");
+
+    // Non-owning view of a pattern table and its index; the built-in one and each ChordDictionary provide one
+    struct PatternSet {
+        const ChordPattern* patterns;
+        size_t count;
+        const uint16_t* best;   // PatternIndex::best
+        const uint16_t* first;  // PatternIndex::first
+        const uint16_t* order;  // PatternIndex::order
+    };
 
-            int pc = midi % 12;
-            int interval = (pc - root_candidate + 12) % 12;
+    inline constexpr PatternSet BUILTIN_PATTERNS = {
+        CHORD_PATTERNS, NUM_PATTERNS, PATTERN_INDEX.best, PATTERN_INDEX.first, PATTERN_INDEX.order
+    };
+
+    // Chord suffix for a pattern id within a pattern set (empty for PATTERN_NONE)
+    constexpr const char* pattern_suffix(const PatternSet& set, uint16_t pattern_id) {
+        return pattern_id < set.count ? set.patterns[pattern_id].name : "";
+    }
+
+    constexpr const char* pattern_suffix(uint16_t pattern_id) {
+        return pattern_suffix(BUILTIN_PATTERNS, pattern_id);
+    }
+
+    // "?" marks ambiguous interval sets that are never reported as a slash reading
+    constexpr bool is_sentinel_pattern(const PatternSet& set, uint16_t pattern_id) {
+        return names_equal(set.patterns[pattern_id].name, "?");
+    }
+
+    // Enumerate (root, pattern) interpretations of a pitch-class set into a CandidateBuffer, in scan order
+    // (root 0-11, then table order), so equal priorities rank like analyze_chord_reference's strict > scan.
+    // With all_patterns = false only the candidates chord selection can pick are produced: per root the best
+    // pattern and, if that is a sentinel, the best non-sentinel one - at most 24 candidates.
+    template<typename Buffer>
+    constexpr void collect_candidates(const PatternSet& set, uint16_t pc_mask, int bass_pc, Buffer& out,
+                                      bool all_patterns = true) {
+        if (count_pitch_classes(pc_mask) < 2) return;
 
-            if (interval == 0) has_root = true;
+        auto push = [&](uint16_t p, int root) {
+            // Bonus for root position (root = bass)
+            int priority = set.patterns[p].priority + (root == bass_pc ? 30 : 0);
+            if (priority < 0) return;   // Never beats the reference scan's initial best_priority of -1
+            out.push({static_cast<uint8_t>(root), static_cast<uint8_t>(bass_pc), p, static_cast<int16_t>(priority),
+                      static_cast<uint16_t>(CHORD_FLAG_MATCHED | (root != bass_pc ? CHORD_FLAG_SLASH : 0))});
+        };
+
+        for (int root = 0; root < 12; ++root) {
+            if (!(pc_mask & (1 << root))) continue;
+            uint16_t mask = rotate_mask(pc_mask, root);
+            CHORD_DETECTOR_COUNT(RootsPassed, 1);
+
+            if (all_patterns) {
+                CHORD_DETECTOR_COUNT(PatternCompares, set.first[mask + 1] - set.first[mask]);
+                for (size_t i = set.first[mask]; i < set.first[mask + 1]; ++i) push(set.order[i], root);
+                continue;
+            }
 
-            // Add interval if not already present
-            bool already_present = false;
-            for (int j = 0; j < interval_count; ++j) {
-                if (intervals[j] == interval) {
-                    already_present = true;
-                    break;
+            uint16_t p = set.best[mask];
+            CHORD_DETECTOR_COUNT(PatternCompares, 1);
+            if (p == PATTERN_NONE) continue;
+            push(p, root);
+
+            if (is_sentinel_pattern(set, p)) {
+                CHORD_DETECTOR_COUNT(PatternCompares, set.first[mask + 1] - set.first[mask]);
+                uint16_t fallback = PATTERN_NONE;
+                for (size_t i = set.first[mask]; i < set.first[mask + 1]; ++i) {
+                    uint16_t q = set.order[i];
+                    if (is_sentinel_pattern(set, q)) continue;
+                    if (fallback == PATTERN_NONE || set.patterns[q].priority > set.patterns[fallback].priority) fallback = q;
                 }
+                if (fallback != PATTERN_NONE) push(fallback, root);
             }
-            if (!already_present && interval_count < ChordDetector::MAX_NOTES) {
-                intervals[interval_count++] = interval;
+        }
+    }
+
+    // Pick the reported chord from ranked candidates - the rules of analyze_chord_reference:
+    // the top candidate wins, and with use_slash a weak winner (priority < 50) gives way to the best
+    // reading over a non-bass root (the analyze_for_slash_chord pass).
+    // analyze_for_slash_chord's C-D-F "?" special case needs a note a fourth above the bass, which cannot
+    // be present when the interval set is exactly R,M2,P4, so over pitch-class sets the sentinel is just skipped.
+    template<typename Buffer>
+    constexpr LookupEntry select_chord(const PatternSet& set, const Buffer& candidates, int bass_pc, bool use_slash) {
+        if (candidates.empty()) return {PATTERN_NONE, NO_PITCH_CLASS, 0, -1};
+
+        const ChordCandidate& best = candidates[0];
+        LookupEntry result = {best.pattern_id, best.root_pc,
+                              static_cast<uint8_t>(CHORD_FLAG_MATCHED | (use_slash && best.root_pc != bass_pc ? CHORD_FLAG_SLASH : 0)),
+                              best.priority};
+        if (!use_slash || best.priority >= 50) return result;
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            const ChordCandidate& candidate = candidates[i];
+            if (candidate.root_pc == bass_pc) continue;
+            if (is_sentinel_pattern(set, candidate.pattern_id)) {
+                CHORD_DETECTOR_COUNT(SentinelHits, 1);
+                continue;
             }
+            CHORD_DETECTOR_COUNT(SlashOverrides, 1);
+            return {candidate.pattern_id, candidate.root_pc, CHORD_FLAG_MATCHED | CHORD_FLAG_SLASH, candidate.priority};
         }
+        return result;
+    }
 
-        if (!has_root || interval_count < 2) continue;
+    // Capacity that always holds collect_candidates(..., all_patterns = false)
+    constexpr size_t SELECTION_CANDIDATES = 24;
 
-        ChordDetector::insertion_sort(intervals, interval_count);
-        uint16_t mask = ChordDetector::create_interval_mask(intervals, interval_count);
+    // Mask-space port of analyze_chord_reference: same scan order, same priority rules.
+    // Each root costs one index probe instead of a scan over the pattern table.
+    // Usable in constant expressions, so detection results can be checked with static_assert.
+    constexpr LookupEntry search_pitch_class_set(const PatternSet& set, uint16_t pc_mask, int bass_pc, bool use_slash) {
+        CandidateBuffer<SELECTION_CANDIDATES> candidates;
+        collect_candidates(set, pc_mask, bass_pc, candidates, false);
+        return select_chord(set, candidates, bass_pc, use_slash);
+    }
 
-        // Find best pattern match
-        for (size_t p = 0; p < ChordDetector::NUM_PATTERNS; ++p) {
-            const ChordDetector::ChordPattern& pattern = ChordDetector::CHORD_PATTERNS[p];
+    constexpr LookupEntry search_pitch_class_set(uint16_t pc_mask, int bass_pc, bool use_slash) {
+        return search_pitch_class_set(BUILTIN_PATTERNS, pc_mask, bass_pc, use_slash);
+    }
 
-            if (pattern.mask != mask) continue;
+    // Winners without and with slash analysis
+    struct LookupEntryPair {
+        LookupEntry plain;
+        LookupEntry slash;
+    };
 
-            int priority = pattern.priority;
+    // Both readings from one candidate pass: the slash rules only re-rank the root-position winner
+    // against the same candidates, so nothing is searched twice
+    constexpr LookupEntryPair search_pitch_class_set_pair(const PatternSet& set, uint16_t pc_mask, int bass_pc) {
+        CandidateBuffer<SELECTION_CANDIDATES> candidates;
+        collect_candidates(set, pc_mask, bass_pc, candidates, false);
+        return {select_chord(set, candidates, bass_pc, false), select_chord(set, candidates, bass_pc, true)};
+    }
 
-            // Bonus for root position (root = bass)
-            if (root_candidate == bass_pitch_class) {
-                priority += 30;
+    constexpr LookupEntryPair search_pitch_class_set_pair(uint16_t pc_mask, int bass_pc) {
+        return search_pitch_class_set_pair(BUILTIN_PATTERNS, pc_mask, bass_pc);
+    }
+
+    // Precomputed winners for every (pitch-class set, bass) pair, with and without slash analysis
+    class LookupTable {
+    public:
+        static constexpr size_t NUM_MASKS = 1 << 12;
+        static constexpr size_t NUM_ENTRIES = NUM_MASKS * 12;
+
+        // Empty table; only useful as a target for assignment
+        LookupTable() = default;
+
+        explicit LookupTable(const PatternSet& set) : plain_(NUM_ENTRIES), slash_(NUM_ENTRIES) {
+            CHORD_DETECTOR_STATS_PAUSE();
+            for (size_t mask = 0; mask < NUM_MASKS; ++mask) {
+                for (int bass = 0; bass < 12; ++bass) {
+                    // The bass is always one of the notes; other slots stay empty
+                    if (!(mask & (1u << bass))) {
+                        plain_[mask * 12 + bass] = slash_[mask * 12 + bass] = {PATTERN_NONE, NO_PITCH_CLASS, 0, -1};
+                        continue;
+                    }
+                    LookupEntryPair entries = search_pitch_class_set_pair(set, static_cast<uint16_t>(mask), bass);
+                    plain_[mask * 12 + bass] = entries.plain;
+                    slash_[mask * 12 + bass] = entries.slash;
+                }
+            }
+            plain_data_ = plain_.data();
+            slash_data_ = slash_.data();
+        }
+
+        // View over NUM_ENTRIES precomputed entries per table that outlive it (nothing is copied)
+        LookupTable(const LookupEntry* plain, const LookupEntry* slash) : plain_data_(plain), slash_data_(slash) {}
+
+        // Moving keeps the vector buffers, so the data pointers stay valid; copies would not
+        LookupTable(const LookupTable&) = delete;
+        LookupTable& operator=(const LookupTable&) = delete;
+        LookupTable(LookupTable&&) = default;
+        LookupTable& operator=(LookupTable&&) = default;
+
+        // bass_pc must be 0-11; callers validate it (see lookup_chord)
+        const LookupEntry& find(uint16_t pc_mask, int bass_pc, bool use_slash) const {
+            size_t index = static_cast<size_t>(pc_mask & 0xFFF) * 12 + static_cast<size_t>(bass_pc);
+            return use_slash ? slash_data_[index] : plain_data_[index];
+        }
+
+        // Raw entries indexed by pc_mask * 12 + bass_pc, for batch kernels
+        const LookupEntry* data(bool use_slash) const {
+            return use_slash ? slash_data_ : plain_data_;
+        }
+
+    private:
+        std::vector<LookupEntry> plain_;            // Storage when built from a pattern set
+        std::vector<LookupEntry> slash_;
+        const LookupEntry* plain_data_ = nullptr;
+        const LookupEntry* slash_data_ = nullptr;
+    };
+
+#ifdef CHORD_DETECTOR_PRECOMPUTED_TABLES
+    // Built-in tables generated at build time and linked from the compiled library (.rodata)
+    CHORD_DETECTOR_API extern const LookupEntry PRECOMPUTED_PLAIN_TABLE[LookupTable::NUM_ENTRIES];
+    CHORD_DETECTOR_API extern const LookupEntry PRECOMPUTED_SLASH_TABLE[LookupTable::NUM_ENTRIES];
+
+    // Shared table over the linked .rodata entries; nothing is computed at startup
+    inline const LookupTable& lookup_table() {
+        static const LookupTable table(PRECOMPUTED_PLAIN_TABLE, PRECOMPUTED_SLASH_TABLE);
+        return table;
+    }
+#else
+    // Shared table, built once on first use (thread-safe static initialization)
+    inline const LookupTable& lookup_table() {
+        static const LookupTable table(BUILTIN_PATTERNS);
+        return table;
+    }
+#endif
+
+    // Packed result for a pitch-class set and bass (bass_pc < 0 means no valid notes; values past 11 are unmatched too)
+    inline PackedChordResult lookup_chord(const LookupTable& table, uint16_t pc_mask, int bass_pc, bool use_slash) {
+        if (bass_pc < 0 || bass_pc >= 12) return {NO_PITCH_CLASS, NO_PITCH_CLASS, PATTERN_NONE, 0};
+        CHORD_DETECTOR_COUNT(TableLookups, 1);
+
+        const LookupEntry& entry = table.find(pc_mask, bass_pc, use_slash);
+        return {entry.root_pc, static_cast<uint8_t>(bass_pc), entry.pattern_id, entry.flags};
+    }
+
+    inline PackedChordResult lookup_chord(uint16_t pc_mask, int bass_pc, bool use_slash) {
+        return lookup_chord(lookup_table(), pc_mask, bass_pc, use_slash);
+    }
+
+    // Batch kernel shared by analyze_chords_batch overloads; bass values outside 0-11 produce an unmatched result
+    inline void lookup_chords(const LookupTable& lookup, const uint16_t* pc_masks, const uint8_t* bass_pcs, size_t n,
+                              PackedChordResult* out, bool use_slash) {
+        const LookupEntry* table = lookup.data(use_slash);
+        constexpr size_t prefetch_distance = 8;
+        CHORD_DETECTOR_COUNT(TableLookups, n);
+
+        for (size_t i = 0; i < n; ++i) {
+#if defined(__GNUC__) || defined(__clang__)
+            if (i + prefetch_distance < n && bass_pcs[i + prefetch_distance] < 12) {
+                __builtin_prefetch(table + static_cast<size_t>(pc_masks[i + prefetch_distance] & 0xFFF) * 12 +
+                                   bass_pcs[i + prefetch_distance]);
+            }
+#endif
+            uint8_t bass = bass_pcs[i];
+            bool has_bass = bass < 12;
+            // Slot 0 (empty set) is the unmatched entry, so invalid input needs no separate path
+            size_t index = has_bass ? static_cast<size_t>(pc_masks[i] & 0xFFF) * 12 + bass : 0;
+            const LookupEntry& entry = table[index];
+
+            out[i].root_pc = entry.root_pc;
+            out[i].bass_pc = has_bass ? bass : NO_PITCH_CLASS;
+            out[i].pattern_id = entry.pattern_id;
+            out[i].flags = entry.flags;
+        }
+    }
+
+    // Tolerant matching: a voicing with a passing tone or a missing chord tone is read as the best
+    // pattern within max_distance added or removed pitch classes. Every candidate set is itself a
+    // (pitch-class set, bass) slot of the exact table, so a probe is one entry load; the bass pitch
+    // class is never removed. An exact match always wins. Otherwise the score is the entry priority
+    // minus distance_penalty per edit; ties prefer fewer edits, then removals over additions.
+    constexpr int MAX_TOLERANCE = 3;
+
+    struct ToleranceOptions {
+        int max_distance = 1;           // Pitch classes added or removed, 0 to MAX_TOLERANCE
+        int distance_penalty = 30;      // Priority lost per edit
+    };
+
+    struct TolerantChord {
+        PackedChordResult chord;
+        uint16_t extra;                 // Pitch classes left out of the reading (e.g. a passing tone)
+        uint16_t missing;               // Pattern pitch classes not present in the input
+        uint8_t distance;               // Number of edits: popcount(extra | missing)
+    };
+
+    // Every flip set of 1 to MAX_TOLERANCE pitch classes, grouped by size: end[d] is the end of size d
+    struct ToleranceFlips {
+        uint16_t masks[12 + 66 + 220] = {};
+        uint16_t end[MAX_TOLERANCE + 1] = {};
+    };
+
+    constexpr ToleranceFlips build_tolerance_flips() {
+        ToleranceFlips flips;
+        uint16_t n = 0;
+        for (int distance = 1; distance <= MAX_TOLERANCE; ++distance) {
+            for (uint16_t mask = 1; mask < (1 << 12); ++mask) {
+                if (count_pitch_classes(mask) == distance) flips.masks[n++] = mask;
+            }
+            flips.end[distance] = n;
+        }
+        return flips;
+    }
+
+    inline constexpr ToleranceFlips TOLERANCE_FLIPS = build_tolerance_flips();
+
+    // Probe every pitch-class set within options.max_distance of pc_mask (bass_pc must be 0-11)
+    inline TolerantChord search_tolerant(const LookupTable& table, uint16_t pc_mask, int bass_pc, bool use_slash,
+                                         const ToleranceOptions& options = ToleranceOptions()) {
+        pc_mask &= 0xFFF;
+        const LookupEntry& exact = table.find(pc_mask, bass_pc, use_slash);
+        TolerantChord result = {{exact.root_pc, static_cast<uint8_t>(bass_pc), exact.pattern_id, exact.flags}, 0, 0, 0};
+        CHORD_DETECTOR_COUNT(TableLookups, 1);
+        if (exact.flags & CHORD_FLAG_MATCHED) return result;
+
+        int max_distance = options.max_distance < MAX_TOLERANCE ? options.max_distance : MAX_TOLERANCE;
+        uint16_t bass_bit = static_cast<uint16_t>(1u << bass_pc);
+        uint16_t best_flip = 0;
+        int best_score = 0, best_removed = 0;
+        for (int distance = 1; distance <= max_distance; ++distance) {
+            for (size_t i = TOLERANCE_FLIPS.end[distance - 1]; i < TOLERANCE_FLIPS.end[distance]; ++i) {
+                uint16_t flip = TOLERANCE_FLIPS.masks[i];
+                if (flip & bass_bit) continue;
+                const LookupEntry& entry = table.find(pc_mask ^ flip, bass_pc, use_slash);
+                CHORD_DETECTOR_COUNT(TableLookups, 1);
+                if (!(entry.flags & CHORD_FLAG_MATCHED)) continue;
+
+                // Flips come in order of size, so an equal score only wins on more removals
+                int score = entry.priority - options.distance_penalty * distance;
+                int removed = count_pitch_classes(flip & pc_mask);
+                if (best_flip == 0 || score > best_score ||
+                    (score == best_score && distance == count_pitch_classes(best_flip) && removed > best_removed)) {
+                    best_flip = flip;
+                    best_score = score;
+                    best_removed = removed;
+                    result.chord = {entry.root_pc, static_cast<uint8_t>(bass_pc), entry.pattern_id, entry.flags};
+                }
+            }
+        }
+        result.extra = best_flip & pc_mask;
+        result.missing = best_flip & static_cast<uint16_t>(~pc_mask);
+        result.distance = static_cast<uint8_t>(count_pitch_classes(best_flip));
+        return result;
+    }
+
+    // Precomputed neighbor table: the winning pitch-class set of search_tolerant for every
+    // (pitch-class set, bass) slot, so a tolerant lookup costs two loads - the neighbor, then its
+    // exact entry - whatever the distance. Built from an exact table that must outlive it.
+    class ToleranceTable {
+    public:
+        static constexpr uint16_t NO_NEIGHBOR = 0xFFFF;     // Nothing within the distance
+
+        explicit ToleranceTable(const LookupTable& table, const ToleranceOptions& options = ToleranceOptions())
+            : table_(&table), options_(options), plain_(LookupTable::NUM_ENTRIES), slash_(LookupTable::NUM_ENTRIES) {
+            CHORD_DETECTOR_STATS_PAUSE();
+            for (size_t mask = 0; mask < LookupTable::NUM_MASKS; ++mask) {
+                for (int bass = 0; bass < 12; ++bass) {
+                    size_t index = mask * 12 + static_cast<size_t>(bass);
+                    if (!(mask & (1u << bass))) {
+                        plain_[index] = slash_[index] = NO_NEIGHBOR;
+                        continue;
+                    }
+                    plain_[index] = neighbor(search_tolerant(table, static_cast<uint16_t>(mask), bass, false, options), mask);
+                    slash_[index] = neighbor(search_tolerant(table, static_cast<uint16_t>(mask), bass, true, options), mask);
+                }
+            }
+        }
+
+        // Same result as search_tolerant with this table's options; bass_pc < 0 means no valid notes,
+        // values past 11 are unmatched too (as in lookup_chord)
+        TolerantChord find(uint16_t pc_mask, int bass_pc, bool use_slash) const {
+            if (bass_pc < 0 || bass_pc >= 12) return {{NO_PITCH_CLASS, NO_PITCH_CLASS, PATTERN_NONE, 0}, 0, 0, 0};
+            pc_mask &= 0xFFF;
+            size_t index = static_cast<size_t>(pc_mask) * 12 + static_cast<size_t>(bass_pc);
+            uint16_t target = (use_slash ? slash_ : plain_)[index];
+            if (target == NO_NEIGHBOR) return {{NO_PITCH_CLASS, static_cast<uint8_t>(bass_pc), PATTERN_NONE, 0}, 0, 0, 0};
+
+            CHORD_DETECTOR_COUNT(TableLookups, 1);
+            const LookupEntry& entry = table_->find(target, bass_pc, use_slash);
+            uint16_t flip = target ^ pc_mask;
+            return {{entry.root_pc, static_cast<uint8_t>(bass_pc), entry.pattern_id, entry.flags},
+                    static_cast<uint16_t>(flip & pc_mask), static_cast<uint16_t>(flip & target),
+                    static_cast<uint8_t>(count_pitch_classes(flip))};
+        }
+
+        const LookupTable& table() const { return *table_; }
+        const ToleranceOptions& options() const { return options_; }
+
+    private:
+        static uint16_t neighbor(const TolerantChord& match, size_t mask) {
+            if (!(match.chord.flags & CHORD_FLAG_MATCHED)) return NO_NEIGHBOR;
+            return static_cast<uint16_t>((mask & ~size_t(match.extra)) | match.missing);
+        }
+
+        const LookupTable* table_;
+        ToleranceOptions options_;
+        std::vector<uint16_t> plain_;
+        std::vector<uint16_t> slash_;
+    };
+
+    // Shared neighbor tables over the built-in table with default penalties, one per distance (1 to
+    // MAX_TOLERANCE), each built on first use
+    inline const ToleranceTable& tolerance_table(int max_distance) {
+        auto build = [](int distance) {
+            ToleranceOptions options;
+            options.max_distance = distance;
+            return ToleranceTable(lookup_table(), options);
+        };
+        if (max_distance <= 1) {
+            static const ToleranceTable one = build(1);
+            return one;
+        }
+        if (max_distance == 2) {
+            static const ToleranceTable two = build(2);
+            return two;
+        }
+        static const ToleranceTable three = build(3);
+        return three;
+    }
+
+    // Write "<root><suffix>[/<bass>]" into buf, truncated to fit and NUL-terminated
+    inline std::string_view format_chord_name(const PackedChordResult& chord, const char* suffix,
+                                              char* buf, size_t cap, bool use_flats) {
+        if (cap == 0) return std::string_view();
+
+        size_t length = 0;
+        auto append = [&](const char* text) {
+            for (; *text && length + 1 < cap; ++text) buf[length++] = *text;
+        };
+
+        if (chord.flags & CHORD_FLAG_MATCHED) {
+            const char* const* note_names = use_flats ? NOTE_NAMES_FLAT : NOTE_NAMES_SHARP;
+            append(note_names[chord.root_pc]);
+            append(suffix);
+            if (chord.flags & CHORD_FLAG_SLASH) {
+                append("/");
+                append(note_names[chord.bass_pc]);
+            }
+        }
+
+        buf[length] = '\0';
+        return std::string_view(buf, length);
+    }
+
+    // Expand a packed result into the string-based ChordResult
+    inline ChordResult expand_chord(const PackedChordResult& chord, const char* suffix, bool use_flats,
+                                    uint32_t fields = FIELDS_ALL) {
+        ChordResult result = {"", "", "", false, -1, -1};
+        if (!(chord.flags & CHORD_FLAG_MATCHED)) return result;
+
+        const char* const* note_names = use_flats ? NOTE_NAMES_FLAT : NOTE_NAMES_SHARP;
+
+        result.is_slash_chord = (chord.flags & CHORD_FLAG_SLASH) != 0;
+        if (fields & FIELDS_NAMES) {
+            std::string chord_name = std::string(note_names[chord.root_pc]) + suffix;
+            if (fields & FIELD_FULL_NAME) {
+                result.full_name = result.is_slash_chord ? chord_name + "/" + note_names[chord.bass_pc] : chord_name;
+            }
+            if (fields & FIELD_CHORD_NAME) result.chord_name = std::move(chord_name);
+        }
+        if (fields & FIELD_BASS_NOTE) result.bass_note = note_names[chord.bass_pc];
+        result.root_pitch_class = chord.root_pc;
+        result.bass_pitch_class = chord.bass_pc;
+        return result;
+    }
+
+    // True if both results name the same chord (the bass only counts when it is written)
+    inline bool same_chord(const PackedChordResult& a, const PackedChordResult& b) {
+        if (a.root_pc != b.root_pc || a.pattern_id != b.pattern_id || a.flags != b.flags) return false;
+        return !(a.flags & CHORD_FLAG_SLASH) || a.bass_pc == b.bass_pc;
+    }
+
+    // Every chord name of a pattern set, pre-rendered into one contiguous NUL-terminated string pool:
+    // accidental style x pattern x root x (12 slash basses + no slash). Immutable once built, so views
+    // into it can be handed out and shared between threads.
+    class NamePool {
+    public:
+        explicit NamePool(const PatternSet& set) : pattern_count_(set.count) {
+            offsets_.resize(2 * pattern_count_ * 12 * BASS_SLOTS);
+            size_t capacity = 0;
+            for (size_t p = 0; p < pattern_count_; ++p) {
+                capacity += 2 * 12 * BASS_SLOTS * (std::strlen(set.patterns[p].name) + 6);
+            }
+            chars_.reserve(capacity);
+
+            // Each entry is sized from its parts and formatted in place, so names of any length are kept in full
+            for (int flats = 0; flats < 2; ++flats) {
+                const char* const* note_names = flats ? NOTE_NAMES_FLAT : NOTE_NAMES_SHARP;
+                for (size_t p = 0; p < pattern_count_; ++p) {
+                    size_t suffix_length = std::strlen(set.patterns[p].name);
+                    for (int root = 0; root < 12; ++root) {
+                        for (int slot = 0; slot < BASS_SLOTS; ++slot) {
+                            bool slash = slot < 12;
+                            PackedChordResult chord = {static_cast<uint8_t>(root), static_cast<uint8_t>(slash ? slot : root),
+                                                       static_cast<uint16_t>(p),
+                                                       static_cast<uint16_t>(CHORD_FLAG_MATCHED | (slash ? CHORD_FLAG_SLASH : 0))};
+                            size_t length = std::strlen(note_names[root]) + suffix_length + (slash ? std::strlen(note_names[slot]) + 1 : 0);
+                            size_t offset = chars_.size();
+                            offsets_[index(flats != 0, p, root, slot)] = static_cast<uint32_t>(offset);
+                            chars_.resize(offset + length + 1);
+                            format_chord_name(chord, set.patterns[p].name, chars_.data() + offset, length + 1, flats != 0);
+                        }
+                    }
+                }
             }
+        }
+
+        NamePool(const NamePool&) = delete;
+        NamePool& operator=(const NamePool&) = delete;
+
+        // Full name ("G7/B"); empty when nothing matched
+        std::string_view full_name(const PackedChordResult& chord, bool use_flats = false) const {
+            return view(find(chord, (chord.flags & CHORD_FLAG_SLASH) ? chord.bass_pc : 12, use_flats));
+        }
+
+        // Chord part without the bass ("G7")
+        std::string_view chord_name(const PackedChordResult& chord, bool use_flats = false) const {
+            return view(find(chord, 12, use_flats));
+        }
+
+        // NUL-terminated full name, valid for the pool's lifetime
+        const char* c_str(const PackedChordResult& chord, bool use_flats = false) const {
+            size_t i = find(chord, (chord.flags & CHORD_FLAG_SLASH) ? chord.bass_pc : 12, use_flats);
+            return i == NO_ENTRY ? "" : chars_.data() + offsets_[i];
+        }
+
+        size_t size_bytes() const { return chars_.size(); }
+
+    private:
+        static constexpr int BASS_SLOTS = 13;           // Slash bass 0-11, or 12 for no slash
+        static constexpr size_t NO_ENTRY = ~size_t(0);
+
+        size_t index(bool use_flats, size_t pattern_id, int root, int slot) const {
+            return ((static_cast<size_t>(use_flats) * pattern_count_ + pattern_id) * 12 + root) * BASS_SLOTS + slot;
+        }
 
-            if (priority > best_priority) {
-                std::string root_name = note_names[root_candidate];
-                std::string bass_name = note_names[bass_pitch_class];
-
-                bool is_slash = (root_candidate != bass_pitch_class) && use_slash;
-
-                result = {
-                    is_slash ? root_name + pattern.name + "/" + bass_name : root_name + pattern.name,
-                    root_name + pattern.name,
-                    bass_name,
-                    is_slash,
-                    root_candidate,
-                    bass_pitch_class
-                };
-                best_priority = priority;
+        size_t find(const PackedChordResult& chord, int slot, bool use_flats) const {
+            if (!(chord.flags & CHORD_FLAG_MATCHED) || chord.pattern_id >= pattern_count_ || chord.root_pc >= 12 ||
+                slot > 12) {
+                return NO_ENTRY;
             }
+            return index(use_flats, chord.pattern_id, chord.root_pc, slot);
+        }
+
+        std::string_view view(size_t i) const {
+            if (i == NO_ENTRY) return std::string_view();
+            size_t end = i + 1 < offsets_.size() ? offsets_[i + 1] - 1 : chars_.size() - 1;
+            return std::string_view(chars_.data() + offsets_[i], end - offsets_[i]);
         }
+
+        size_t pattern_count_;
+        std::vector<char> chars_;
+        std::vector<uint32_t> offsets_;
+    };
+
+    // Pool of the built-in names, built once on first use (thread-safe static initialization)
+    inline const NamePool& name_pool() {
+        static const NamePool pool(BUILTIN_PATTERNS);
+        return pool;
     }
 
-    // Enhanced slash chord analysis for special cases
-    if (use_slash) {
-        ChordResult slash_result = ChordDetector::analyze_for_slash_chord(
-            midi_notes, note_count, bass_pitch_class, note_names);
+    // Two-way set-associative cache of packed results keyed on (owner, pitch-class set, bass, use_slash).
+    // Not synchronized: each thread uses its own (thread_memo_cache()); owner ids keep vocabularies apart.
+    template<size_t SETS>
+    class MemoCache {
+        static_assert(SETS > 0 && (SETS & (SETS - 1)) == 0, "SETS must be a power of two");
+
+    public:
+        static constexpr size_t CAPACITY = 2 * SETS;
+
+        MemoCache() { clear(); }
+
+        void clear() {
+            for (Set& set : sets_) set.keys[0] = set.keys[1] = 0;
+        }
+
+        // On a hit fills out and makes the entry the most recently used of its set
+        bool find(uint32_t owner, uint16_t pc_mask, int bass_pc, bool use_slash, PackedChordResult& out) {
+            uint64_t key = make_key(owner, pc_mask, bass_pc, use_slash);
+            Set& set = sets_[index(key)];
+            if (set.keys[0] == key) {
+                out = set.values[0];
+                return true;
+            }
+            if (set.keys[1] != key) return false;
+
+            out = set.values[1];
+            set.keys[1] = set.keys[0];
+            set.values[1] = set.values[0];
+            set.keys[0] = key;
+            set.values[0] = out;
+            return true;
+        }
+
+        // Insert as the most recently used entry, evicting the set's least recently used one
+        void insert(uint32_t owner, uint16_t pc_mask, int bass_pc, bool use_slash, const PackedChordResult& value) {
+            uint64_t key = make_key(owner, pc_mask, bass_pc, use_slash);
+            Set& set = sets_[index(key)];
+            set.keys[1] = set.keys[0];
+            set.values[1] = set.values[0];
+            set.keys[0] = key;
+            set.values[0] = value;
+        }
+
+    private:
+        struct Set {
+            uint64_t keys[2];               // 0 = empty; most recently used first
+            PackedChordResult values[2];
+        };
 
-        // Use slash result if it has higher priority or if no root position found
-        if (!slash_result.full_name.empty() &&
-            (slash_result.root_pitch_class != slash_result.bass_pitch_class) &&
-            best_priority < 50) {
-            result = slash_result;
+        static uint64_t make_key(uint32_t owner, uint16_t pc_mask, int bass_pc, bool use_slash) {
+            return (uint64_t(owner) << 32) | (1u << 17) | (use_slash ? 1u << 16 : 0u) |
+                   (static_cast<uint32_t>(bass_pc & 0xF) << 12) | (pc_mask & 0xFFFu);
         }
+
+        static size_t index(uint64_t key) {
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (SETS - 1);
+        }
+
+        Set sets_[SETS];
+    };
+
+    // 512 entries (8 KB): room for the few hundred distinct voicings typical material repeats
+    constexpr size_t MEMO_CACHE_SETS = 256;
+
+    inline MemoCache<MEMO_CACHE_SETS>& thread_memo_cache() {
+        thread_local MemoCache<MEMO_CACHE_SETS> cache;
+        return cache;
+    }
+
+    // Owner id for a new memo cache client
+    inline uint32_t next_memo_owner() {
+        static std::atomic<uint32_t> next{0};
+        return next.fetch_add(1, std::memory_order_relaxed);
     }
+}
+
+// User-extensible chord vocabulary with the same {mask, name, priority} schema as CHORD_PATTERNS.
+// Construction builds the dictionary's own pattern index and (pitch-class set, bass) table, so lookups
+// cost the same as the built-in path. Mode::Cached skips the table (no 98K-search build) and answers
+// lookups with the pattern search behind the calling thread's memo cache instead.
+// A constructed dictionary is immutable and safe to share across threads.
+// Pattern ids in results refer to this dictionary; built-in patterns keep their CHORD_PATTERNS ids when
+// include_builtin is set, and earlier entries win priority ties.
+// Ids are 16-bit: user patterns past MAX_PATTERNS are not added, and ok()/dropped() report it.
+// Ranked priorities are 16-bit too: user priorities above MAX_PRIORITY are clamped, and ok()/clamped() report it.
+class ChordDictionary {
+public:
+    // Built-in plus user patterns; ids must stay below the PATTERN_NONE sentinel
+    static constexpr size_t MAX_PATTERNS = ChordDetector::PATTERN_NONE - 1;
+    // Highest user priority whose root-position bonus still fits the int16_t candidate priority
+    static constexpr int MAX_PRIORITY = INT16_MAX - 30;
+
+    enum class Mode : uint8_t {
+        Table,      // Precomputed (pitch-class set, bass) table
+        Cached      // Pattern search behind a thread-local memo cache; nothing precomputed
+    };
+
+    // Built-in vocabulary
+    ChordDictionary() : ChordDictionary(nullptr, 0, true) {}
+
+    // Built-in vocabulary (optional) followed by user patterns; names are copied
+    ChordDictionary(const ChordDetector::ChordPattern* extra, size_t count, bool include_builtin = true,
+                    Mode mode = Mode::Table)
+        : mode_(mode), owner_(ChordDetector::next_memo_owner()) {
+        size_t builtin_count = include_builtin ? ChordDetector::NUM_PATTERNS : 0;
+        if (count > MAX_PATTERNS - builtin_count) {
+            dropped_ = count - (MAX_PATTERNS - builtin_count);
+            count = MAX_PATTERNS - builtin_count;
+        }
+
+        size_t name_bytes = 0;
+        for (size_t p = 0; p < count; ++p) name_bytes += std::strlen(extra[p].name) + 1;
+        names_.reserve(name_bytes);
+
+        patterns_.reserve(builtin_count + count);
+        for (size_t p = 0; p < builtin_count; ++p) patterns_.push_back(ChordDetector::CHORD_PATTERNS[p]);
+
+        std::vector<size_t> name_offsets;
+        for (size_t p = 0; p < count; ++p) {
+            name_offsets.push_back(names_.size());
+            names_.insert(names_.end(), extra[p].name, extra[p].name + std::strlen(extra[p].name) + 1);
+            int priority = extra[p].priority;
+            if (priority > MAX_PRIORITY) {
+                priority = MAX_PRIORITY;
+                ++clamped_;
+            }
+            patterns_.push_back({static_cast<uint16_t>(extra[p].mask & 0xFFF), nullptr, priority});
+        }
+        // names_ is fully reserved, so the pointers stay valid
+        for (size_t p = 0; p < count; ++p) patterns_[builtin_count + p].name = names_.data() + name_offsets[p];
 
+        build_index();
+        if (mode_ == Mode::Table) table_ = ChordDetector::LookupTable(pattern_set());
+    }
+
+    ChordDictionary(std::initializer_list<ChordDetector::ChordPattern> extra, bool include_builtin = true,
+                    Mode mode = Mode::Table)
+        : ChordDictionary(extra.begin(), extra.size(), include_builtin, mode) {}
+
+    explicit ChordDictionary(const std::vector<ChordDetector::ChordPattern>& extra, bool include_builtin = true,
+                             Mode mode = Mode::Table)
+        : ChordDictionary(extra.data(), extra.size(), include_builtin, mode) {}
+
+    // Pattern names point into this object; moving keeps them valid, copying would not
+    ChordDictionary(const ChordDictionary&) = delete;
+    ChordDictionary& operator=(const ChordDictionary&) = delete;
+    ChordDictionary(ChordDictionary&&) = default;
+    ChordDictionary& operator=(ChordDictionary&&) = default;
+
+    size_t size() const { return patterns_.size(); }
+    const ChordDetector::ChordPattern& pattern(uint16_t pattern_id) const { return patterns_[pattern_id]; }
+
+    // False when user patterns past MAX_PATTERNS were left out or priorities were clamped to MAX_PRIORITY;
+    // the rest of the dictionary still works
+    bool ok() const { return dropped_ == 0 && clamped_ == 0; }
+    const char* error() const {
+        if (dropped_) return "too many patterns: ids past MAX_PATTERNS were dropped";
+        if (clamped_) return "priority out of range: priorities above MAX_PRIORITY were clamped";
+        return "";
+    }
+    size_t dropped() const { return dropped_; }     // User patterns that were not added (the last ones given)
+    size_t clamped() const { return clamped_; }     // User patterns whose priority was lowered to MAX_PRIORITY
+    const char* suffix(uint16_t pattern_id) const { return ChordDetector::pattern_suffix(pattern_set(), pattern_id); }
+
+    ChordDetector::PatternSet pattern_set() const {
+        return {patterns_.data(), patterns_.size(), best_.data(), first_.data(), order_.data()};
+    }
+
+    Mode mode() const { return mode_; }
+    bool tabulated() const { return mode_ == Mode::Table; }
+
+    // Empty unless tabulated()
+    const ChordDetector::LookupTable& table() const { return table_; }
+
+    PackedChordResult lookup(uint16_t pc_mask, int bass_pc, bool use_slash = false) const {
+        // Checked before either mode, so both agree and no invalid key reaches the memo cache
+        if (bass_pc < 0 || bass_pc >= 12) return {ChordDetector::NO_PITCH_CLASS, ChordDetector::NO_PITCH_CLASS, ChordDetector::PATTERN_NONE, 0};
+        if (tabulated()) return ChordDetector::lookup_chord(table_, pc_mask, bass_pc, use_slash);
+
+        pc_mask &= 0xFFF;
+        PackedChordResult result;
+        auto& cache = ChordDetector::thread_memo_cache();
+        if (cache.find(owner_, pc_mask, bass_pc, use_slash, result)) {
+            CHORD_DETECTOR_COUNT(MemoHits, 1);
+            return result;
+        }
+        CHORD_DETECTOR_COUNT(MemoMisses, 1);
+
+        // Same entry the table would hold; slots whose bass is not one of the notes stay unmatched
+        ChordDetector::LookupEntry entry = {ChordDetector::PATTERN_NONE, ChordDetector::NO_PITCH_CLASS, 0, -1};
+        if (pc_mask & (1 << bass_pc)) entry = ChordDetector::search_pitch_class_set(pattern_set(), pc_mask, bass_pc, use_slash);
+        result = {entry.root_pc, static_cast<uint8_t>(bass_pc), entry.pattern_id, entry.flags};
+        cache.insert(owner_, pc_mask, bass_pc, use_slash, result);
+        return result;
+    }
+
+private:
+    // Runtime counterpart of build_pattern_index
+    void build_index() {
+        constexpr size_t num_masks = ChordDetector::LookupTable::NUM_MASKS;
+        best_.assign(num_masks, ChordDetector::PATTERN_NONE);
+        first_.assign(num_masks + 1, 0);
+        order_.assign(patterns_.size(), 0);
+
+        for (const ChordDetector::ChordPattern& pattern : patterns_) ++first_[pattern.mask + 1];
+        for (size_t mask = 0; mask < num_masks; ++mask) first_[mask + 1] = static_cast<uint16_t>(first_[mask + 1] + first_[mask]);
+
+        std::vector<uint16_t> fill(num_masks, 0);
+        for (size_t p = 0; p < patterns_.size(); ++p) {
+            uint16_t mask = patterns_[p].mask;
+            order_[first_[mask] + fill[mask]++] = static_cast<uint16_t>(p);
+
+            uint16_t current = best_[mask];
+            if (current == ChordDetector::PATTERN_NONE || patterns_[p].priority > patterns_[current].priority) {
+                best_[mask] = static_cast<uint16_t>(p);
+            }
+        }
+    }
+
+    std::vector<char> names_;
+    std::vector<ChordDetector::ChordPattern> patterns_;
+    std::vector<uint16_t> best_;
+    std::vector<uint16_t> first_;
+    std::vector<uint16_t> order_;
+    ChordDetector::LookupTable table_;
+    Mode mode_;
+    uint32_t owner_;                // Memo cache key of this vocabulary
+    size_t dropped_ = 0;
+    size_t clamped_ = 0;
+};
+
+// Allocation-free chord analysis - single lookup in the precomputed (pitch-class set, bass) table
+inline PackedChordResult analyze_chord_fast(const int* midi_notes, int note_count, bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(AnalyzeChordFast, 1);
+    int bass_pitch_class;
+    uint16_t pc_mask = ChordDetector::pitch_class_mask(midi_notes, note_count, bass_pitch_class);
+    return ChordDetector::lookup_chord(pc_mask, bass_pitch_class, use_slash);
+}
+
+// Convenience overloads for allocation-free analysis
+inline PackedChordResult analyze_chord_fast(const std::vector<int>& midi_notes, bool use_slash = false) {
+    return analyze_chord_fast(midi_notes.data(), static_cast<int>(midi_notes.size()), use_slash);
+}
+
+inline PackedChordResult analyze_chord_fast(std::initializer_list<int> midi_notes, bool use_slash = false) {
+    return analyze_chord_fast(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_slash);
+}
+
+template<size_t N>
+PackedChordResult analyze_chord_fast(const std::array<int, N>& midi_notes, bool use_slash = false) {
+    return analyze_chord_fast(midi_notes.data(), static_cast<int>(N), use_slash);
+}
+
+template<size_t N>
+PackedChordResult analyze_chord_fast(const int (&midi_notes)[N], bool use_slash = false) {
+    return analyze_chord_fast(midi_notes, static_cast<int>(N), use_slash);
+}
+
+// Compile-time chord analysis - same result as analyze_chord_fast, computed by the pattern search
+// instead of the lookup table so it can run in constant expressions:
+//   static_assert(analyze_chord_constexpr({60, 64, 65}).pattern_id == ...);
+constexpr PackedChordResult analyze_chord_constexpr(const int* midi_notes, int note_count, bool use_slash = false) {
+    int bass_pitch_class = -1;
+    uint16_t pc_mask = ChordDetector::pitch_class_mask(midi_notes, note_count, bass_pitch_class);
+    if (bass_pitch_class < 0) {
+        return {ChordDetector::NO_PITCH_CLASS, ChordDetector::NO_PITCH_CLASS, ChordDetector::PATTERN_NONE, 0};
+    }
+
+    ChordDetector::LookupEntry entry = ChordDetector::search_pitch_class_set(pc_mask, bass_pitch_class, use_slash);
+    return {entry.root_pc, static_cast<uint8_t>(bass_pitch_class), entry.pattern_id, entry.flags};
+}
+
+constexpr PackedChordResult analyze_chord_constexpr(std::initializer_list<int> midi_notes, bool use_slash = false) {
+    return analyze_chord_constexpr(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_slash);
+}
+
+template<size_t N>
+constexpr PackedChordResult analyze_chord_constexpr(const std::array<int, N>& midi_notes, bool use_slash = false) {
+    return analyze_chord_constexpr(midi_notes.data(), static_cast<int>(N), use_slash);
+}
+
+template<size_t N>
+constexpr PackedChordResult analyze_chord_constexpr(const int (&midi_notes)[N], bool use_slash = false) {
+    return analyze_chord_constexpr(midi_notes, static_cast<int>(N), use_slash);
+}
+
+// Top-K interpretations in a single pass, ranked like analyze_chord ranks them: out[0] is the chord
+// analyze_chord reports without slash analysis. Each candidate carries root, bass, pattern id,
+// effective priority and whether it is a slash reading (root != bass). out is cleared first.
+template<size_t K>
+void analyze_chord_candidates(const int* midi_notes, int note_count, CandidateBuffer<K>& out) {
+    CHORD_DETECTOR_COUNT(AnalyzeChordCandidates, 1);
+    out.clear();
+    int bass_pitch_class;
+    uint16_t pc_mask = ChordDetector::pitch_class_mask(midi_notes, note_count, bass_pitch_class);
+    if (bass_pitch_class >= 0) {
+        ChordDetector::collect_candidates(ChordDetector::BUILTIN_PATTERNS, pc_mask, bass_pitch_class, out);
+    }
+}
+
+template<size_t K>
+void analyze_chord_candidates(std::initializer_list<int> midi_notes, CandidateBuffer<K>& out) {
+    analyze_chord_candidates(midi_notes.begin(), static_cast<int>(midi_notes.size()), out);
+}
+
+template<size_t K>
+void analyze_chord_candidates(const std::vector<int>& midi_notes, CandidateBuffer<K>& out) {
+    analyze_chord_candidates(midi_notes.data(), static_cast<int>(midi_notes.size()), out);
+}
+
+// Select the reported chord from candidates without re-running detection; gives analyze_chord_fast's
+// result whenever the buffer was not truncated (size() < CAPACITY)
+template<size_t K>
+PackedChordResult select_chord(const CandidateBuffer<K>& candidates, bool use_slash = false) {
+    if (candidates.empty()) {
+        return {ChordDetector::NO_PITCH_CLASS, ChordDetector::NO_PITCH_CLASS, ChordDetector::PATTERN_NONE, 0};
+    }
+    int bass_pc = candidates[0].bass_pc;
+    ChordDetector::LookupEntry entry =
+        ChordDetector::select_chord(ChordDetector::BUILTIN_PATTERNS, candidates, bass_pc, use_slash);
+    return {entry.root_pc, static_cast<uint8_t>(bass_pc), entry.pattern_id, entry.flags};
+}
+
+// Candidate as a packed result, written as a slash chord when it is a slash reading
+inline PackedChordResult to_packed_result(const ChordCandidate& candidate) {
+    return {candidate.root_pc, candidate.bass_pc, candidate.pattern_id, candidate.flags};
+}
+
+// Pitch-class sets and bass notes for a flat note buffer; chord i is notes[offsets[i]] .. notes[offsets[i + 1] - 1].
+// offsets holds chord_count + 1 entries. Chords without valid notes get bass ChordDetector::NO_PITCH_CLASS.
+inline void pitch_class_sets_from_notes(const int* notes, const size_t* offsets, size_t chord_count,
+                                        uint16_t* pc_masks, uint8_t* bass_pcs) {
+    for (size_t i = 0; i < chord_count; ++i) {
+        int bass_pitch_class;
+        pc_masks[i] = ChordDetector::pitch_class_mask(notes + offsets[i],
+                                                      static_cast<int>(offsets[i + 1] - offsets[i]), bass_pitch_class);
+        bass_pcs[i] = bass_pitch_class < 0 ? ChordDetector::NO_PITCH_CLASS : static_cast<uint8_t>(bass_pitch_class);
+    }
+}
+
+// Batch analysis over structure-of-arrays input; out[i] is identical to analyze_chord_fast for chord i.
+// Bass values outside 0-11 produce an unmatched result.
+inline void analyze_chords_batch(const uint16_t* pc_masks, const uint8_t* bass_pcs, size_t n,
+                                 PackedChordResult* out, bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(BatchCalls, 1);
+    CHORD_DETECTOR_COUNT(BatchChords, n);
+    ChordDetector::lookup_chords(ChordDetector::lookup_table(), pc_masks, bass_pcs, n, out, use_slash);
+}
+
+// Batch analysis straight from a flat note buffer (see pitch_class_sets_from_notes for the layout)
+inline void analyze_chords_batch(const int* notes, const size_t* offsets, size_t chord_count,
+                                 PackedChordResult* out, bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(BatchCalls, 1);
+    CHORD_DETECTOR_COUNT(BatchChords, chord_count);
+    constexpr size_t block = 256;
+    uint16_t pc_masks[block];
+    uint8_t bass_pcs[block];
+
+    for (size_t begin = 0; begin < chord_count; begin += block) {
+        size_t count = chord_count - begin < block ? chord_count - begin : block;
+        pitch_class_sets_from_notes(notes, offsets + begin, count, pc_masks, bass_pcs);
+        ChordDetector::lookup_chords(ChordDetector::lookup_table(), pc_masks, bass_pcs, count, out + begin, use_slash);
+    }
+}
+
+// Write the full chord name (e.g. "C/E") into buf; the result is truncated to fit and always NUL-terminated.
+// Returns a view of the written characters; empty when nothing matched or cap is 0.
+inline std::string_view format_chord(const PackedChordResult& chord, char* buf, size_t cap, bool use_flats = false) {
+    return ChordDetector::format_chord_name(chord, ChordDetector::pattern_suffix(chord.pattern_id), buf, cap, use_flats);
+}
+
+// Fixed-latency real-time mode. analyze_chord_realtime does the same work for every input: all
+// REALTIME_MAX_NOTES slots are scanned with selects instead of branches, the plain or slash table
+// is picked by pointer, and exactly one entry is loaded, so there is no early exit, no pattern
+// search and no second pass for slash chords. Results equal analyze_chord_fast for up to
+// REALTIME_MAX_NOTES notes; further notes are ignored. Call prepare_realtime() once outside the
+// audio thread so the first callback does not build tables or fault their pages in.
+
+// Build the shared tables and name pool and read every cache line of the tables and every pattern
+// name once, so later analyze_chord_realtime and format_chord calls never initialize or page-fault.
+// Returns a checksum of the data read, only there to keep the reads from being optimized out.
+inline uint32_t prepare_realtime() {
+    const ChordDetector::LookupTable& table = ChordDetector::lookup_table();
+    ChordDetector::name_pool();
+    uint32_t checksum = 0;
+    for (int use_slash = 0; use_slash < 2; ++use_slash) {
+        const ChordDetector::LookupEntry* entries = table.data(use_slash != 0);
+        for (size_t i = 0; i < ChordDetector::LookupTable::NUM_ENTRIES; i += 64 / sizeof(ChordDetector::LookupEntry)) {
+            checksum += entries[i].pattern_id;
+        }
+    }
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    for (uint16_t pattern = 0; pattern < ChordDetector::NUM_PATTERNS; ++pattern) {
+        PackedChordResult chord = {0, 0, pattern, ChordDetector::CHORD_FLAG_MATCHED};
+        checksum += static_cast<uint32_t>(format_chord(chord, buf, sizeof(buf)).size());
+    }
+    return checksum;
+}
+
+// Bounded-latency analysis with no data-dependent branches; see prepare_realtime()
+inline PackedChordResult analyze_chord_realtime(const int* midi_notes, int note_count, bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(AnalyzeChordRealtime, 1);
+    CHORD_DETECTOR_COUNT(TableLookups, 1);
+    uint16_t pc_mask;
+    uint8_t bass_pc = ChordDetector::realtime_voicing(midi_notes, note_count, pc_mask);
+
+    // Without notes, mask 0 with bass 0 is an empty table slot: the entry is unmatched either way
+    const ChordDetector::LookupEntry* entries = ChordDetector::lookup_table().data(use_slash);
+    size_t bass_index = bass_pc * static_cast<size_t>(bass_pc != ChordDetector::NO_PITCH_CLASS);
+    const ChordDetector::LookupEntry& entry = entries[static_cast<size_t>(pc_mask) * 12 + bass_index];
+    return {entry.root_pc, bass_pc, entry.pattern_id, entry.flags};
+}
+
+template<size_t N>
+PackedChordResult analyze_chord_realtime(const std::array<int, N>& midi_notes, bool use_slash = false) {
+    return analyze_chord_realtime(midi_notes.data(), static_cast<int>(N), use_slash);
+}
+
+// Tolerant analysis: the exact reading if there is one, else the best within max_distance (0 to
+// ChordDetector::MAX_TOLERANCE) added or removed pitch classes, e.g. C-E-G-F# reads as C with F#
+// in extra. Two table loads via the shared neighbor table; see ChordDetector::ToleranceTable for
+// custom vocabularies or penalties.
+inline ChordDetector::TolerantChord analyze_chord_tolerant(const int* midi_notes, int note_count, bool use_slash = false,
+                                                           int max_distance = 1) {
+    CHORD_DETECTOR_COUNT(AnalyzeChordTolerant, 1);
+    int bass_pitch_class;
+    uint16_t pc_mask = ChordDetector::pitch_class_mask(midi_notes, note_count, bass_pitch_class);
+    if (max_distance <= 0) return {ChordDetector::lookup_chord(pc_mask, bass_pitch_class, use_slash), 0, 0, 0};
+    return ChordDetector::tolerance_table(max_distance).find(pc_mask, bass_pitch_class, use_slash);
+}
+
+inline ChordDetector::TolerantChord analyze_chord_tolerant(std::initializer_list<int> midi_notes, bool use_slash = false,
+                                                           int max_distance = 1) {
+    return analyze_chord_tolerant(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_slash, max_distance);
+}
+
+inline ChordDetector::TolerantChord analyze_chord_tolerant(const std::vector<int>& midi_notes, bool use_slash = false,
+                                                           int max_distance = 1) {
+    return analyze_chord_tolerant(midi_notes.data(), static_cast<int>(midi_notes.size()), use_slash, max_distance);
+}
+
+// Expand a packed result into the string-based ChordResult; names are copied from the name pool
+inline ChordResult to_chord_result(const PackedChordResult& chord, bool use_flats = false,
+                                   uint32_t fields = ChordDetector::FIELDS_ALL) {
+    ChordResult result = {"", "", "", false, -1, -1};
+    if (!(chord.flags & ChordDetector::CHORD_FLAG_MATCHED)) return result;
+
+    if (fields & (ChordDetector::FIELD_FULL_NAME | ChordDetector::FIELD_CHORD_NAME)) {
+        const ChordDetector::NamePool& pool = ChordDetector::name_pool();
+        if (fields & ChordDetector::FIELD_FULL_NAME) result.full_name = pool.full_name(chord, use_flats);
+        if (fields & ChordDetector::FIELD_CHORD_NAME) result.chord_name = pool.chord_name(chord, use_flats);
+    }
+    if (fields & ChordDetector::FIELD_BASS_NOTE) {
+        result.bass_note = (use_flats ? ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP)[chord.bass_pc];
+    }
+    result.is_slash_chord = (chord.flags & ChordDetector::CHORD_FLAG_SLASH) != 0;
+    result.root_pitch_class = chord.root_pc;
+    result.bass_pitch_class = chord.bass_pc;
     return result;
 }
 
+// Dictionary-based analysis: same rules as the built-in functions over a custom vocabulary
+inline PackedChordResult analyze_chord_fast(const ChordDictionary& dictionary, const int* midi_notes, int note_count,
+                                            bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(AnalyzeChordFast, 1);
+    int bass_pitch_class;
+    uint16_t pc_mask = ChordDetector::pitch_class_mask(midi_notes, note_count, bass_pitch_class);
+    return dictionary.lookup(pc_mask, bass_pitch_class, use_slash);
+}
+
+inline PackedChordResult analyze_chord_fast(const ChordDictionary& dictionary, std::initializer_list<int> midi_notes,
+                                            bool use_slash = false) {
+    return analyze_chord_fast(dictionary, midi_notes.begin(), static_cast<int>(midi_notes.size()), use_slash);
+}
+
+inline PackedChordResult analyze_chord_fast(const ChordDictionary& dictionary, const std::vector<int>& midi_notes,
+                                            bool use_slash = false) {
+    return analyze_chord_fast(dictionary, midi_notes.data(), static_cast<int>(midi_notes.size()), use_slash);
+}
+
+inline void analyze_chords_batch(const ChordDictionary& dictionary, const uint16_t* pc_masks, const uint8_t* bass_pcs,
+                                 size_t n, PackedChordResult* out, bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(BatchCalls, 1);
+    CHORD_DETECTOR_COUNT(BatchChords, n);
+    if (dictionary.tabulated()) {
+        ChordDetector::lookup_chords(dictionary.table(), pc_masks, bass_pcs, n, out, use_slash);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) out[i] = dictionary.lookup(pc_masks[i], bass_pcs[i] < 12 ? bass_pcs[i] : -1, use_slash);
+}
+
+inline std::string_view format_chord(const PackedChordResult& chord, const ChordDictionary& dictionary,
+                                     char* buf, size_t cap, bool use_flats = false) {
+    return ChordDetector::format_chord_name(chord, dictionary.suffix(chord.pattern_id), buf, cap, use_flats);
+}
+
+inline ChordResult to_chord_result(const PackedChordResult& chord, const ChordDictionary& dictionary,
+                                   bool use_flats = false, uint32_t fields = ChordDetector::FIELDS_ALL) {
+    return ChordDetector::expand_chord(chord, dictionary.suffix(chord.pattern_id), use_flats, fields);
+}
+
+inline ChordResult analyze_chord(const ChordDictionary& dictionary, const int* midi_notes, int note_count,
+                                 bool use_flats = false, bool use_slash = false,
+                                 uint32_t fields = ChordDetector::FIELDS_ALL) {
+    CHORD_DETECTOR_COUNT(AnalyzeChord, 1);
+    return to_chord_result(analyze_chord_fast(dictionary, midi_notes, note_count, use_slash), dictionary, use_flats, fields);
+}
+
+inline ChordResult analyze_chord(const ChordDictionary& dictionary, std::initializer_list<int> midi_notes,
+                                 bool use_flats = false, bool use_slash = false,
+                                 uint32_t fields = ChordDetector::FIELDS_ALL) {
+    return analyze_chord(dictionary, midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, use_slash, fields);
+}
+
+inline ChordResult analyze_chord(const ChordDictionary& dictionary, const std::vector<int>& midi_notes,
+                                 bool use_flats = false, bool use_slash = false,
+                                 uint32_t fields = ChordDetector::FIELDS_ALL) {
+    return analyze_chord(dictionary, midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats, use_slash, fields);
+}
+
+template<size_t K>
+void analyze_chord_candidates(const ChordDictionary& dictionary, const int* midi_notes, int note_count,
+                              CandidateBuffer<K>& out) {
+    CHORD_DETECTOR_COUNT(AnalyzeChordCandidates, 1);
+    out.clear();
+    int bass_pitch_class;
+    uint16_t pc_mask = ChordDetector::pitch_class_mask(midi_notes, note_count, bass_pitch_class);
+    if (bass_pitch_class >= 0) {
+        ChordDetector::collect_candidates(dictionary.pattern_set(), pc_mask, bass_pitch_class, out);
+    }
+}
+
+template<size_t K>
+void analyze_chord_candidates(const ChordDictionary& dictionary, std::initializer_list<int> midi_notes,
+                              CandidateBuffer<K>& out) {
+    analyze_chord_candidates(dictionary, midi_notes.begin(), static_cast<int>(midi_notes.size()), out);
+}
+
+template<size_t K>
+PackedChordResult select_chord(const ChordDictionary& dictionary, const CandidateBuffer<K>& candidates,
+                               bool use_slash = false) {
+    if (candidates.empty()) {
+        return {ChordDetector::NO_PITCH_CLASS, ChordDetector::NO_PITCH_CLASS, ChordDetector::PATTERN_NONE, 0};
+    }
+    int bass_pc = candidates[0].bass_pc;
+    ChordDetector::LookupEntry entry =
+        ChordDetector::select_chord(dictionary.pattern_set(), candidates, bass_pc, use_slash);
+    return {entry.root_pc, static_cast<uint8_t>(bass_pc), entry.pattern_id, entry.flags};
+}
 
+// Main chord analysis function; fields (ChordDetector::FIELD_* bits) selects the strings to fill
+inline ChordResult analyze_chord(const int* midi_notes, int note_count, bool use_flats = false, bool use_slash = false,
+                                 uint32_t fields = ChordDetector::FIELDS_ALL) {
+    CHORD_DETECTOR_COUNT(AnalyzeChord, 1);
+    return to_chord_result(analyze_chord_fast(midi_notes, note_count, use_slash), use_flats, fields);
+}
 
 // Simple chord name function
-std::string get_chord_name(const int* midi_notes, int note_count, bool use_flats = false, bool use_slash = false) {
-    return analyze_chord(midi_notes, note_count, use_flats, use_slash).full_name;
+inline std::string get_chord_name(const int* midi_notes, int note_count, bool use_flats = false, bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(GetChordName, 1);
+    return std::string(ChordDetector::name_pool().full_name(analyze_chord_fast(midi_notes, note_count, use_slash), use_flats));
+}
+
+// Chord name as a view into the shared name pool: no string is built per call
+inline std::string_view get_chord_name_view(const int* midi_notes, int note_count, bool use_flats = false,
+                                            bool use_slash = false) {
+    CHORD_DETECTOR_COUNT(GetChordNameView, 1);
+    return ChordDetector::name_pool().full_name(analyze_chord_fast(midi_notes, note_count, use_slash), use_flats);
+}
+
+inline std::string_view get_chord_name_view(std::initializer_list<int> midi_notes, bool use_flats = false,
+                                            bool use_slash = false) {
+    return get_chord_name_view(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
+}
+
+inline std::string_view get_chord_name_view(const std::vector<int>& midi_notes, bool use_flats = false,
+                                            bool use_slash = false) {
+    return get_chord_name_view(midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
+}
+
+// Pooled name of a packed result
+inline std::string_view chord_name_view(const PackedChordResult& chord, bool use_flats = false) {
+    return ChordDetector::name_pool().full_name(chord, use_flats);
 }
 
 // Convenience overloads
-ChordResult analyze_chord(const std::vector<int>& midi_notes, bool use_flats = false, bool use_slash = false) {
-    return analyze_chord(midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
+inline ChordResult analyze_chord(const std::vector<int>& midi_notes, bool use_flats = false, bool use_slash = false,
+                                 uint32_t fields = ChordDetector::FIELDS_ALL) {
+    return analyze_chord(midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats, use_slash, fields);
 }
 
-ChordResult analyze_chord(std::initializer_list<int> midi_notes, bool use_flats = false, bool use_slash = false) {
-    return analyze_chord(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
+inline ChordResult analyze_chord(std::initializer_list<int> midi_notes, bool use_flats = false, bool use_slash = false,
+                                 uint32_t fields = ChordDetector::FIELDS_ALL) {
+    return analyze_chord(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, use_slash, fields);
 }
 
+// Fixed-size arrays take no fields argument: analyze_chord(array, count, use_flats, use_slash) would
+// otherwise also match (array, use_flats, use_slash, fields)
 template<size_t N>
 ChordResult analyze_chord(const std::array<int, N>& midi_notes, bool use_flats = false, bool use_slash = false) {
     return analyze_chord(midi_notes.data(), static_cast<int>(N), use_flats, use_slash);
@@ -407,11 +1972,11 @@ ChordResult analyze_chord(const int (&midi_notes)[N], bool use_flats = false, bo
     return analyze_chord(midi_notes, static_cast<int>(N), use_flats, use_slash);
 }
 
-std::string get_chord_name(const std::vector<int>& midi_notes, bool use_flats = false, bool use_slash = false) {
+inline std::string get_chord_name(const std::vector<int>& midi_notes, bool use_flats = false, bool use_slash = false) {
     return get_chord_name(midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
 }
 
-std::string get_chord_name(std::initializer_list<int> midi_notes, bool use_flats = false, bool use_slash = false) {
+inline std::string get_chord_name(std::initializer_list<int> midi_notes, bool use_flats = false, bool use_slash = false) {
     return get_chord_name(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
 }
 
@@ -425,21 +1990,148 @@ std::string get_chord_name(const int (&midi_notes)[N], bool use_flats = false, b
     return get_chord_name(midi_notes, static_cast<int>(N), use_flats, use_slash);
 }
 
-// Inversion type detection helper
-inline std::string get_inversion_type(const ChordResult& chord) {
-    if (!chord.is_slash_chord) return "root";
+// Inversion of a chord as a value instead of a string
+enum class Inversion : uint8_t {
+    Root,                       // Root in bass (or no slash)
+    First,                      // 3rd in bass
+    Second,                     // 5th in bass
+    Third,                      // 7th in bass
+    Other
+};
 
-    int interval = (chord.bass_pitch_class - chord.root_pitch_class + 12) % 12;
-    switch (interval) {
-        case 0: return "root";
+// Same names as get_inversion_type
+constexpr const char* inversion_name(Inversion inversion) {
+    switch (inversion) {
+        case Inversion::Root: return "root";
+        case Inversion::First: return "1st";
+        case Inversion::Second: return "2nd";
+        case Inversion::Third: return "3rd";
+        default: return "other";
+    }
+}
+
+// Inversion for the bass this many semitones above the root (any integer)
+constexpr Inversion inversion_from_interval(int bass_above_root) {
+    switch (((bass_above_root % 12) + 12) % 12) {
+        case 0: return Inversion::Root;
         case 3:
-        case 4: return "1st";  // 3rd in bass
+        case 4: return Inversion::First;
         case 6:
-        case 7: return "2nd";  // 5th in bass
+        case 7: return Inversion::Second;
         case 10:
-        case 11: return "3rd"; // 7th in bass
-        default: return "other";
+        case 11: return Inversion::Third;
+        default: return Inversion::Other;
+    }
+}
+
+constexpr Inversion get_inversion(const PackedChordResult& chord) {
+    if (!(chord.flags & ChordDetector::CHORD_FLAG_SLASH)) return Inversion::Root;
+    return inversion_from_interval(chord.bass_pc - chord.root_pc);
+}
+
+inline Inversion get_inversion(const ChordResult& chord) {
+    if (!chord.is_slash_chord) return Inversion::Root;
+    return inversion_from_interval(chord.bass_pitch_class - chord.root_pitch_class);
+}
+
+// String form of get_inversion ("root", "1st", "2nd", "3rd", "other")
+inline std::string get_inversion_type(const ChordResult& chord) {
+    return inversion_name(get_inversion(chord));
+}
+
+// Lazily named chord result: construction costs one table lookup, accessors compute only what is
+// asked for. Names are views into the shared name pool, or for a dictionary formatted into the view
+// on first use; they stay valid as long as the view (and the dictionary).
+class ChordView {
+public:
+    explicit ChordView(const PackedChordResult& chord, bool use_flats = false) : chord_(chord), use_flats_(use_flats) {}
+
+    // Names from a custom vocabulary; the dictionary must outlive the view
+    ChordView(const PackedChordResult& chord, const ChordDictionary& dictionary, bool use_flats = false)
+        : chord_(chord), suffix_(dictionary.suffix(chord.pattern_id)), use_flats_(use_flats) {}
+
+    bool matched() const { return (chord_.flags & ChordDetector::CHORD_FLAG_MATCHED) != 0; }
+    bool is_slash_chord() const { return (chord_.flags & ChordDetector::CHORD_FLAG_SLASH) != 0; }
+
+    // Same values as ChordResult: -1 if nothing matched
+    int root_pitch_class() const { return matched() ? chord_.root_pc : -1; }
+    int bass_pitch_class() const { return matched() ? chord_.bass_pc : -1; }
+    Inversion inversion() const { return get_inversion(chord_); }
+
+    std::string_view full_name() const {
+        if (!matched()) return std::string_view();
+        if (!suffix_) return ChordDetector::name_pool().full_name(chord_, use_flats_);
+        return formatted();
+    }
+
+    // Name without the "/bass" part
+    std::string_view chord_name() const {
+        if (!matched()) return std::string_view();
+        if (!suffix_) return ChordDetector::name_pool().chord_name(chord_, use_flats_);
+        const char* root = (use_flats_ ? ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP)[chord_.root_pc];
+        return formatted().substr(0, std::strlen(root) + std::strlen(suffix_));
+    }
+
+    std::string_view bass_note() const {
+        if (!matched()) return std::string_view();
+        return (use_flats_ ? ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP)[chord_.bass_pc];
+    }
+
+    const PackedChordResult& packed() const { return chord_; }
+
+    ChordResult to_result(uint32_t fields = ChordDetector::FIELDS_ALL) const {
+        if (!suffix_) return to_chord_result(chord_, use_flats_, fields);
+        return ChordDetector::expand_chord(chord_, suffix_, use_flats_, fields);
+    }
+
+private:
+    // Formatted once; names that do not fit the inline buffer are built in long_name_ instead of cut off
+    std::string_view formatted() const {
+        if (name_length_ == NOT_FORMATTED) {
+            const char* const* note_names = use_flats_ ? ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP;
+            size_t length = std::strlen(note_names[chord_.root_pc]) + std::strlen(suffix_) +
+                            (is_slash_chord() ? std::strlen(note_names[chord_.bass_pc]) + 1 : 0);
+            char* buf = name_;
+            if (length >= sizeof(name_)) {
+                long_name_.resize(length);
+                buf = &long_name_[0];
+            }
+            name_length_ = ChordDetector::format_chord_name(chord_, suffix_, buf, length + 1, use_flats_).size();
+        }
+        return std::string_view(name_length_ < sizeof(name_) ? name_ : long_name_.data(), name_length_);
     }
+
+    static constexpr size_t NOT_FORMATTED = std::string_view::npos;
+
+    PackedChordResult chord_;
+    const char* suffix_ = nullptr;      // Dictionary pattern name; null for the built-in name pool
+    bool use_flats_;
+    mutable size_t name_length_ = NOT_FORMATTED;
+    mutable char name_[ChordDetector::CHORD_NAME_CAPACITY];
+    mutable std::string long_name_;     // Only for names of CHORD_NAME_CAPACITY bytes or more
+};
+
+// Analysis without building any string; see ChordView
+inline ChordView analyze_chord_view(const int* midi_notes, int note_count, bool use_flats = false, bool use_slash = false) {
+    return ChordView(analyze_chord_fast(midi_notes, note_count, use_slash), use_flats);
+}
+
+inline ChordView analyze_chord_view(std::initializer_list<int> midi_notes, bool use_flats = false, bool use_slash = false) {
+    return analyze_chord_view(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
+}
+
+inline ChordView analyze_chord_view(const std::vector<int>& midi_notes, bool use_flats = false, bool use_slash = false) {
+    return analyze_chord_view(midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
+}
+
+inline ChordView analyze_chord_view(const ChordDictionary& dictionary, const int* midi_notes, int note_count,
+                                    bool use_flats = false, bool use_slash = false) {
+    return ChordView(analyze_chord_fast(dictionary, midi_notes, note_count, use_slash), dictionary, use_flats);
+}
+
+inline ChordView analyze_chord_view(const ChordDictionary& dictionary, std::initializer_list<int> midi_notes,
+                                    bool use_flats = false, bool use_slash = false) {
+    return analyze_chord_view(dictionary, midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, use_slash);
 }
 
 // Detailed analysis helper
@@ -450,10 +2142,14 @@ struct DetailedAnalysis {
     std::vector<int> intervals_from_root;
 };
 
-DetailedAnalysis get_detailed_analysis(const int* midi_notes, int note_count, bool use_flats = false) {
+// fields (ChordDetector::FIELD_* bits) selects the chord strings, inversion_type and arrays to fill
+inline DetailedAnalysis get_detailed_analysis(const int* midi_notes, int note_count, bool use_flats = false,
+                                              uint32_t fields = ChordDetector::FIELDS_ALL) {
+    CHORD_DETECTOR_COUNT(DetailedAnalysis, 1);
     DetailedAnalysis analysis;
-    analysis.chord = analyze_chord(midi_notes, note_count, use_flats, true);
-    analysis.inversion_type = get_inversion_type(analysis.chord);
+    analysis.chord = analyze_chord(midi_notes, note_count, use_flats, true, fields);
+    if (fields & ChordDetector::FIELD_INVERSION) analysis.inversion_type = get_inversion_type(analysis.chord);
+    if (!(fields & (ChordDetector::FIELD_NOTE_NAMES | ChordDetector::FIELD_INTERVALS))) return analysis;
 
     const char* const* note_names = use_flats ?
         ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP;
@@ -467,10 +2163,12 @@ DetailedAnalysis get_detailed_analysis(const int* midi_notes, int note_count, bo
         }
     }
 
+    bool want_names = (fields & ChordDetector::FIELD_NOTE_NAMES) != 0;
+    bool want_intervals = (fields & ChordDetector::FIELD_INTERVALS) != 0;
     for (int i = 0; i < 12; ++i) {
         if (active[i]) {
-            analysis.note_names.push_back(note_names[i]);
-            if (analysis.chord.root_pitch_class >= 0) {
+            if (want_names) analysis.note_names.push_back(note_names[i]);
+            if (want_intervals && analysis.chord.root_pitch_class >= 0) {
                 int interval = (i - analysis.chord.root_pitch_class + 12) % 12;
                 analysis.intervals_from_root.push_back(interval);
             }
@@ -481,14 +2179,17 @@ DetailedAnalysis get_detailed_analysis(const int* midi_notes, int note_count, bo
 }
 
 // Convenience overloads for detailed analysis
-DetailedAnalysis get_detailed_analysis(const std::vector<int>& midi_notes, bool use_flats = false) {
-    return get_detailed_analysis(midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats);
+inline DetailedAnalysis get_detailed_analysis(const std::vector<int>& midi_notes, bool use_flats = false,
+                                              uint32_t fields = ChordDetector::FIELDS_ALL) {
+    return get_detailed_analysis(midi_notes.data(), static_cast<int>(midi_notes.size()), use_flats, fields);
 }
 
-DetailedAnalysis get_detailed_analysis(std::initializer_list<int> midi_notes, bool use_flats = false) {
-    return get_detailed_analysis(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats);
+inline DetailedAnalysis get_detailed_analysis(std::initializer_list<int> midi_notes, bool use_flats = false,
+                                              uint32_t fields = ChordDetector::FIELDS_ALL) {
+    return get_detailed_analysis(midi_notes.begin(), static_cast<int>(midi_notes.size()), use_flats, fields);
 }
 
+// No fields argument, as for analyze_chord on fixed-size arrays
 template<size_t N>
 DetailedAnalysis get_detailed_analysis(const std::array<int, N>& midi_notes, bool use_flats = false) {
     return get_detailed_analysis(midi_notes.data(), static_cast<int>(N), use_flats);
@@ -498,3 +2199,164 @@ template<size_t N>
 DetailedAnalysis get_detailed_analysis(const int (&midi_notes)[N], bool use_flats = false) {
     return get_detailed_analysis(midi_notes, static_cast<int>(N), use_flats);
 }
+
+// Allocation-free counterpart of DetailedAnalysis: fixed arrays, static note-name strings
+struct DetailedAnalysisCompact {
+    PackedChordResult chord;                    // Analyzed with slash detection, like get_detailed_analysis
+    Inversion inversion;
+    uint8_t note_count;                         // Unique pitch classes, ascending from C (0 without FIELD_NOTE_NAMES)
+    uint8_t interval_count;                     // Pitch class count if a chord matched (and FIELD_INTERVALS), otherwise 0
+    const char* note_names[12];                 // Entries of NOTE_NAMES_SHARP / NOTE_NAMES_FLAT
+    uint8_t intervals_from_root[12];
+    char full_name[ChordDetector::CHORD_NAME_CAPACITY];    // NUL-terminated, e.g. "G7/B"
+};
+
+// Fill a DetailedAnalysisCompact in place; never allocates. Without FIELD_FULL_NAME the name is
+// empty; without FIELD_NOTE_NAMES or FIELD_INTERVALS that array is left unfilled and its count is 0.
+inline void get_detailed_analysis(const int* midi_notes, int note_count, DetailedAnalysisCompact& out,
+                                  bool use_flats = false, uint32_t fields = ChordDetector::FIELDS_ALL) {
+    CHORD_DETECTOR_COUNT(DetailedAnalysis, 1);
+    out.chord = analyze_chord_fast(midi_notes, note_count, true);
+    out.inversion = get_inversion(out.chord);
+    if (fields & ChordDetector::FIELD_FULL_NAME) format_chord(out.chord, out.full_name, sizeof(out.full_name), use_flats);
+    else out.full_name[0] = '\0';
+
+    const char* const* note_names = use_flats ?
+        ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP;
+
+    int bass_pitch_class;
+    uint16_t pc_mask = ChordDetector::pitch_class_mask(midi_notes, note_count, bass_pitch_class);
+    bool want_names = (fields & ChordDetector::FIELD_NOTE_NAMES) != 0;
+    bool want_intervals = (fields & ChordDetector::FIELD_INTERVALS) && out.chord.pattern_id != ChordDetector::PATTERN_NONE;
+
+    out.note_count = 0;
+    out.interval_count = 0;
+    if (!want_names && !want_intervals) return;
+    for (int pc = 0; pc < 12; ++pc) {
+        if (!(pc_mask & (1 << pc))) continue;
+        if (want_names) out.note_names[out.note_count++] = note_names[pc];
+        if (want_intervals) out.intervals_from_root[out.interval_count++] = static_cast<uint8_t>((pc - out.chord.root_pc + 12) % 12);
+    }
+}
+
+inline void get_detailed_analysis(const std::vector<int>& midi_notes, DetailedAnalysisCompact& out,
+                                  bool use_flats = false, uint32_t fields = ChordDetector::FIELDS_ALL) {
+    get_detailed_analysis(midi_notes.data(), static_cast<int>(midi_notes.size()), out, use_flats, fields);
+}
+
+inline void get_detailed_analysis(std::initializer_list<int> midi_notes, DetailedAnalysisCompact& out,
+                                  bool use_flats = false, uint32_t fields = ChordDetector::FIELDS_ALL) {
+    get_detailed_analysis(midi_notes.begin(), static_cast<int>(midi_notes.size()), out, use_flats, fields);
+}
+
+// Timestamped note event for the stream-based APIs
+struct NoteEvent {
+    uint32_t tick;              // Time in caller-defined units (MIDI ticks, samples, ...)
+    uint8_t note;               // MIDI note number (0-127)
+    uint8_t channel;            // MIDI channel or track
+    uint8_t on;                 // 1 = note-on, 0 = note-off
+};
+
+// Incremental chord tracker for live note-on/note-off input.
+// Each event is O(1) and allocation-free; the chord is only looked up again when the
+// held pitch-class set or the bass pitch class changes.
+class ChordTracker {
+public:
+    explicit ChordTracker(bool use_slash = false)
+        : table_(&ChordDetector::lookup_table()), use_slash_(use_slash) {
+        reset();
+    }
+
+    // Track chords from a custom vocabulary; the dictionary must outlive the tracker
+    explicit ChordTracker(const ChordDictionary& dictionary, bool use_slash = false)
+        : table_(dictionary.tabulated() ? &dictionary.table() : nullptr),
+          dictionary_(dictionary.tabulated() ? nullptr : &dictionary), use_slash_(use_slash) {
+        reset();
+    }
+
+    // Track chords from a specific lookup table; the table must outlive the tracker
+    explicit ChordTracker(const ChordDetector::LookupTable& table, bool use_slash = false)
+        : table_(&table), use_slash_(use_slash) {
+        reset();
+    }
+
+    // Returns true if the current chord changed
+    bool note_on(int midi) {
+        if (midi < 0 || midi > 127 || note_counts_[midi] == UINT16_MAX) return false;
+
+        if (note_counts_[midi]++ == 0) {
+            held_[midi >> 6] |= uint64_t(1) << (midi & 63);
+            if (pc_counts_[midi % 12]++ == 0) pc_mask_ |= static_cast<uint16_t>(1 << (midi % 12));
+        }
+        return update();
+    }
+
+    // Returns true if the current chord changed
+    bool note_off(int midi) {
+        if (midi < 0 || midi > 127 || note_counts_[midi] == 0) return false;
+
+        if (--note_counts_[midi] == 0) {
+            held_[midi >> 6] &= ~(uint64_t(1) << (midi & 63));
+            if (--pc_counts_[midi % 12] == 0) pc_mask_ &= static_cast<uint16_t>(~(1 << (midi % 12)));
+        }
+        return update();
+    }
+
+    // Returns true if the current chord changed
+    bool apply(const NoteEvent& event) {
+        return event.on ? note_on(event.note) : note_off(event.note);
+    }
+
+    // Release all notes
+    void reset() {
+        held_[0] = held_[1] = 0;
+        std::memset(note_counts_, 0, sizeof(note_counts_));
+        std::memset(pc_counts_, 0, sizeof(pc_counts_));
+        pc_mask_ = last_mask_ = 0;
+        bass_pc_ = -1;
+        current_ = {ChordDetector::NO_PITCH_CLASS, ChordDetector::NO_PITCH_CLASS, ChordDetector::PATTERN_NONE, 0};
+    }
+
+    const PackedChordResult& current() const { return current_; }
+    uint16_t pitch_class_mask() const { return pc_mask_; }
+
+    // Held notes per pitch class (12 entries), e.g. for a key estimator fed from the same state
+    const uint16_t* pitch_class_counts() const { return pc_counts_; }
+
+    // Lowest held MIDI note, -1 if nothing is held
+    int bass_note() const {
+        if (held_[0]) return ChordDetector::lowest_bit(held_[0]);
+        if (held_[1]) return 64 + ChordDetector::lowest_bit(held_[1]);
+        return -1;
+    }
+
+private:
+    bool update() {
+        int bass = bass_note();
+        int bass_pc = bass < 0 ? -1 : bass % 12;
+        if (bass_pc == bass_pc_ && pc_mask_ == last_mask_) {
+            CHORD_DETECTOR_COUNT(TrackerHits, 1);
+            return false;
+        }
+        CHORD_DETECTOR_COUNT(TrackerMisses, 1);
+
+        bass_pc_ = bass_pc;
+        last_mask_ = pc_mask_;
+        PackedChordResult next = table_ ? ChordDetector::lookup_chord(*table_, pc_mask_, bass_pc, use_slash_)
+                                        : dictionary_->lookup(pc_mask_, bass_pc, use_slash_);
+        bool changed = !ChordDetector::same_chord(next, current_);
+        current_ = next;
+        return changed;
+    }
+
+    const ChordDetector::LookupTable* table_;
+    const ChordDictionary* dictionary_ = nullptr;   // Untabulated vocabulary, used when table_ is null
+    bool use_slash_;
+    uint64_t held_[2];              // Held MIDI notes as a 128-bit set
+    uint16_t note_counts_[128];     // Note-on count per MIDI note
+    uint16_t pc_counts_[12];        // Held MIDI notes per pitch class
+    uint16_t pc_mask_;
+    uint16_t last_mask_;            // Pitch-class set of current_
+    int bass_pc_;                   // Bass pitch class of current_
+    PackedChordResult current_;
+};
@@ -0,0 +1,482 @@
+#pragma once
+
+#include "chord_detector.h"
+#include "chord_detector_midi.h"
+
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+/**
+ * Compact binary chord annotations: one record of a few bytes per chord change
+ * A file carries its own pattern-name dictionary, so results of any vocabulary can be named
+ * without it, and a block index, so readers seek by tick without decoding from the start.
+ * The reader works in place over a caller-owned buffer (e.g. an mmap'ed file); nothing is
+ * copied, and opening validates the header, dictionary, index and records in one linear pass.
+ *
+ * Layout (version 1, all integers little-endian, sections 8-byte aligned):
+ *   header     64 bytes: "CDAN", u16 version, u16 header size, u32 ticks per quarter,
+ *              u32 pattern count, u64 record count, u32 block count, u32 records per block,
+ *              u64 names offset, u64 index offset, u64 data offset, u64 file size
+ *   names      u32 offsets[pattern count + 1] into the following NUL-terminated name bytes
+ *   index      32 bytes per block: u64 first tick, u64 first record, u64 data offset
+ *              (from the data section), u32 byte size, u32 record count
+ *   data       records: varint tick delta (from the previous record of the block, or from the
+ *              block's first tick), u8 root << 4 | bass (15 = none), varint pattern id << 2 | flags
+ *              (unmatched records store 0: no pattern is kept for them)
+ *
+ * Usage:
+ *   ChordDetector::AnnotationWriter writer;
+ *   while (midi.next(change)) writer.add(change);
+ *   writer.save("song.cdan");
+ *
+ *   ChordDetector::AnnotationReader reader(mapped_data, mapped_size);   // or a path
+ *   reader.seek(tick);                                                  // chord in effect at tick
+ *   while (reader.next(change)) ... reader.format(change.chord, buf, sizeof(buf)) ...
+ */
+
+namespace ChordDetector {
+    constexpr uint8_t ANNOTATION_MAGIC[4] = {'C', 'D', 'A', 'N'};
+    constexpr uint16_t ANNOTATION_VERSION = 1;
+    constexpr size_t ANNOTATION_HEADER_SIZE = 64;
+    constexpr size_t ANNOTATION_INDEX_ENTRY_SIZE = 32;
+
+    // Longest record: 10-byte tick delta, root/bass byte, 3-byte pattern code
+    constexpr size_t ANNOTATION_MAX_RECORD_SIZE = 14;
+
+    struct AnnotationOptions {
+        uint32_t records_per_block = 256;   // Seek granularity: records decoded at most per seek
+        uint32_t ticks_per_quarter = 0;     // Informational (e.g. MidiChordReader::division()), 0 if unknown
+    };
+
+    // One entry of the block index
+    struct AnnotationBlock {
+        uint64_t first_tick;
+        uint64_t first_record;
+        uint64_t data_offset;       // From the start of the data section
+        uint32_t byte_size;
+        uint32_t record_count;
+    };
+
+    namespace detail {
+        inline void store_le(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+            for (size_t i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+
+        inline void store_le_at(uint8_t* out, uint64_t value, size_t bytes) {
+            for (size_t i = 0; i < bytes; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+
+        inline uint64_t load_le(const uint8_t* in, size_t bytes) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < bytes; ++i) value |= uint64_t(in[i]) << (8 * i);
+            return value;
+        }
+
+        inline void store_varint(std::vector<uint8_t>& out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        // Returns the position after the varint, nullptr if it is truncated or longer than 64 bits
+        inline const uint8_t* load_varint(const uint8_t* in, const uint8_t* end, uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && in < end; shift += 7) {
+                uint8_t byte = *in++;
+                value |= uint64_t(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return in;
+            }
+            return nullptr;
+        }
+    }
+
+    class AnnotationWriter {
+    public:
+        explicit AnnotationWriter(const AnnotationOptions& options = AnnotationOptions())
+            : AnnotationWriter(BUILTIN_PATTERNS, options) {}
+
+        // Names are taken from the dictionary's patterns, so its pattern ids can be written.
+        // The dictionary must outlive the writer.
+        explicit AnnotationWriter(const ChordDictionary& dictionary, const AnnotationOptions& options = AnnotationOptions())
+            : AnnotationWriter(dictionary.pattern_set(), options) {}
+
+        AnnotationWriter(const PatternSet& set, const AnnotationOptions& options) : set_(set), options_(options) {
+            if (options_.records_per_block == 0) options_.records_per_block = 1;
+        }
+
+        // Append a chord change. Ticks must not decrease; returns false (and writes nothing) if one
+        // does, if a matched chord's pattern id is not in the vocabulary or its root or bass is not 0-11,
+        // or after finish().
+        bool add(uint64_t tick, const PackedChordResult& chord) {
+            bool matched = (chord.flags & CHORD_FLAG_MATCHED) != 0;
+            if (finished_ || (record_count_ > 0 && tick < last_tick_) ||
+                (matched && (chord.pattern_id >= set_.count || chord.root_pc >= 12 || chord.bass_pc >= 12))) {
+                return false;
+            }
+
+            if (record_count_ % options_.records_per_block == 0) {
+                blocks_.push_back({tick, record_count_, data_.size(), 0, 0});
+                last_tick_ = tick;
+            }
+            AnnotationBlock& block = blocks_.back();
+            detail::store_varint(data_, tick - last_tick_);
+            data_.push_back(static_cast<uint8_t>((nibble(chord.root_pc) << 4) | nibble(chord.bass_pc)));
+            detail::store_varint(data_, matched ? (uint64_t(chord.pattern_id) << 2) | (chord.flags & 3) : 0);
+            block.byte_size = static_cast<uint32_t>(data_.size() - block.data_offset);
+            ++block.record_count;
+            ++record_count_;
+            last_tick_ = tick;
+            return true;
+        }
+
+        bool add(const ChordChange& change) { return add(change.tick, change.chord); }
+
+        uint64_t record_count() const { return record_count_; }
+
+        // Complete file image; the writer accepts no more records afterwards
+        const std::vector<uint8_t>& finish() {
+            if (finished_) return image_;
+            finished_ = true;
+
+            std::vector<uint8_t> names;
+            std::vector<uint32_t> name_offsets;
+            for (size_t p = 0; p < set_.count; ++p) {
+                name_offsets.push_back(static_cast<uint32_t>(names.size()));
+                for (const char* c = set_.patterns[p].name; *c; ++c) names.push_back(static_cast<uint8_t>(*c));
+                names.push_back(0);
+            }
+            name_offsets.push_back(static_cast<uint32_t>(names.size()));
+
+            auto align = [](size_t offset) { return (offset + 7) & ~size_t(7); };
+            size_t names_offset = ANNOTATION_HEADER_SIZE;
+            size_t index_offset = align(names_offset + name_offsets.size() * 4 + names.size());
+            size_t data_offset = index_offset + blocks_.size() * ANNOTATION_INDEX_ENTRY_SIZE;
+            size_t file_size = data_offset + data_.size();
+
+            image_.clear();
+            image_.reserve(file_size);
+            for (uint8_t byte : ANNOTATION_MAGIC) image_.push_back(byte);
+            detail::store_le(image_, ANNOTATION_VERSION, 2);
+            detail::store_le(image_, ANNOTATION_HEADER_SIZE, 2);
+            detail::store_le(image_, options_.ticks_per_quarter, 4);
+            detail::store_le(image_, set_.count, 4);
+            detail::store_le(image_, record_count_, 8);
+            detail::store_le(image_, blocks_.size(), 4);
+            detail::store_le(image_, options_.records_per_block, 4);
+            detail::store_le(image_, names_offset, 8);
+            detail::store_le(image_, index_offset, 8);
+            detail::store_le(image_, data_offset, 8);
+            detail::store_le(image_, file_size, 8);
+
+            for (uint32_t offset : name_offsets) detail::store_le(image_, offset, 4);
+            image_.insert(image_.end(), names.begin(), names.end());
+            image_.resize(index_offset, 0);
+
+            for (const AnnotationBlock& block : blocks_) {
+                detail::store_le(image_, block.first_tick, 8);
+                detail::store_le(image_, block.first_record, 8);
+                detail::store_le(image_, block.data_offset, 8);
+                detail::store_le(image_, block.byte_size, 4);
+                detail::store_le(image_, block.record_count, 4);
+            }
+            image_.insert(image_.end(), data_.begin(), data_.end());
+
+            data_ = std::vector<uint8_t>();
+            blocks_ = std::vector<AnnotationBlock>();
+            return image_;
+        }
+
+        // finish() and write the image to a file; returns false on I/O errors
+        bool save(const char* path) {
+            const std::vector<uint8_t>& image = finish();
+            std::FILE* file = std::fopen(path, "wb");
+            if (!file) return false;
+            bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+            return std::fclose(file) == 0 && written;
+        }
+
+    private:
+        static uint8_t nibble(uint8_t pitch_class) { return pitch_class < 12 ? pitch_class : 15; }
+
+        PatternSet set_;
+        AnnotationOptions options_;
+        std::vector<uint8_t> data_;
+        std::vector<AnnotationBlock> blocks_;
+        std::vector<uint8_t> image_;
+        uint64_t record_count_ = 0;
+        uint64_t last_tick_ = 0;
+        bool finished_ = false;
+    };
+
+    class AnnotationReader {
+    public:
+        // Read in place from a caller-owned buffer that outlives the reader
+        AnnotationReader(const uint8_t* data, size_t size) : data_(data), size_(size) { open(); }
+
+        // Read a whole file into memory owned by the reader
+        explicit AnnotationReader(const char* path) {
+            std::FILE* file = std::fopen(path, "rb");
+            if (!file) {
+                fail("cannot open file");
+                return;
+            }
+            uint8_t chunk[4096];
+            for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;) owned_.insert(owned_.end(), chunk, chunk + n);
+            bool read_error = std::ferror(file) != 0;
+            std::fclose(file);
+            if (read_error) {
+                fail("read error");
+                return;
+            }
+            data_ = owned_.data();
+            size_ = owned_.size();
+            open();
+        }
+
+        // Moving would leave data_ pointing into the source's buffer
+        AnnotationReader(const AnnotationReader&) = delete;
+        AnnotationReader& operator=(const AnnotationReader&) = delete;
+
+        bool ok() const { return error_ == nullptr; }
+        const char* error() const { return error_ ? error_ : ""; }
+
+        uint16_t version() const { return version_; }
+        uint32_t ticks_per_quarter() const { return ticks_per_quarter_; }
+        uint64_t record_count() const { return record_count_; }
+        uint32_t block_count() const { return block_count_; }
+        uint32_t pattern_count() const { return pattern_count_; }
+
+        // Name of a pattern in the embedded dictionary (a view into the buffer), "" if out of range
+        std::string_view pattern_name(uint16_t pattern_id) const {
+            if (!ok() || pattern_id >= pattern_count_) return std::string_view();
+            const uint8_t* offsets = data_ + names_offset_;
+            uint32_t begin = static_cast<uint32_t>(detail::load_le(offsets + pattern_id * 4, 4));
+            uint32_t end = static_cast<uint32_t>(detail::load_le(offsets + pattern_id * 4 + 4, 4));
+            return std::string_view(reinterpret_cast<const char*>(names_ + begin), end - begin - 1);
+        }
+
+        AnnotationBlock block(size_t index) const {
+            const uint8_t* entry = data_ + index_offset_ + index * ANNOTATION_INDEX_ENTRY_SIZE;
+            return {detail::load_le(entry, 8), detail::load_le(entry + 8, 8), detail::load_le(entry + 16, 8),
+                    static_cast<uint32_t>(detail::load_le(entry + 24, 4)), static_cast<uint32_t>(detail::load_le(entry + 28, 4))};
+        }
+
+        // Last block starting at or before tick (0 if tick precedes every block)
+        size_t find_block(uint64_t tick) const {
+            size_t low = 0, high = block_count_;
+            while (high - low > 1) {
+                size_t middle = low + (high - low) / 2;
+                if (block(middle).first_tick <= tick) low = middle;
+                else high = middle;
+            }
+            return low;
+        }
+
+        // Back to the first record
+        void rewind() { start_block(0); }
+
+        // Position on the chord in effect at tick: the last record at or before it (the first record
+        // if tick precedes them all). Decodes at most one block. Returns false if the file is empty.
+        bool seek(uint64_t tick) {
+            if (!ok() || block_count_ == 0) return false;
+            start_block(find_block(tick));
+
+            Cursor keep = cursor_;
+            ChordChange change;
+            while (cursor_.remaining > 0) {
+                Cursor before = cursor_;
+                if (!decode(cursor_, change)) return false;
+                if (change.tick > tick) break;
+                keep = before;
+            }
+            cursor_ = keep;
+            return true;
+        }
+
+        // Next record; false at the end or when a record is corrupt (see error())
+        bool next(ChordChange& change) {
+            if (!ok()) return false;
+            while (cursor_.remaining == 0) {
+                if (cursor_.block + 1 >= block_count_) return false;
+                start_block(cursor_.block + 1);
+            }
+            return decode(cursor_, change);
+        }
+
+        // Decode a whole block into out (which holds block(index).record_count entries); returns the count
+        size_t read_block(size_t index, ChordChange* out) {
+            if (!ok() || index >= block_count_) return 0;
+            Cursor cursor = block_cursor(index);
+            size_t count = 0;
+            while (cursor.remaining > 0 && decode(cursor, out[count])) ++count;
+            return count;
+        }
+
+        // Names from the embedded dictionary, so files of custom vocabularies need no ChordDictionary
+        std::string_view format(const PackedChordResult& chord, char* buf, size_t cap, bool use_flats = false) const {
+            return format_chord_name(chord, suffix_of(chord), buf, cap, use_flats);
+        }
+
+        ChordResult to_chord_result(const PackedChordResult& chord, bool use_flats = false) const {
+            return expand_chord(chord, suffix_of(chord), use_flats);
+        }
+
+    private:
+        struct Cursor {
+            size_t block;
+            const uint8_t* pos;
+            const uint8_t* end;
+            uint32_t remaining;     // Records left in the block
+            uint64_t tick;          // Tick of the previous record (the block's first tick at its start)
+        };
+
+        void fail(const char* message) {
+            if (!error_) error_ = message;
+        }
+
+        // Validate header, dictionary, index and records, so reads of an open file stay in bounds and in order
+        void open() {
+            if (size_ < ANNOTATION_HEADER_SIZE || std::memcmp(data_, ANNOTATION_MAGIC, 4) != 0) {
+                fail("not a chord annotation file");
+                return;
+            }
+            version_ = static_cast<uint16_t>(detail::load_le(data_ + 4, 2));
+            if (version_ != ANNOTATION_VERSION) {
+                fail("unsupported annotation version");
+                return;
+            }
+            uint64_t header_size = detail::load_le(data_ + 6, 2);
+            ticks_per_quarter_ = static_cast<uint32_t>(detail::load_le(data_ + 8, 4));
+            pattern_count_ = static_cast<uint32_t>(detail::load_le(data_ + 12, 4));
+            record_count_ = detail::load_le(data_ + 16, 8);
+            block_count_ = static_cast<uint32_t>(detail::load_le(data_ + 24, 4));
+            names_offset_ = detail::load_le(data_ + 32, 8);
+            index_offset_ = detail::load_le(data_ + 40, 8);
+            data_offset_ = detail::load_le(data_ + 48, 8);
+            uint64_t file_size = detail::load_le(data_ + 56, 8);
+
+            uint64_t names_bytes = (uint64_t(pattern_count_) + 1) * 4;
+            // Offsets are compared before any are subtracted, so crafted values cannot wrap past a check
+            if (header_size < ANNOTATION_HEADER_SIZE || file_size > size_ || names_offset_ < header_size ||
+                names_offset_ > index_offset_ || names_bytes > index_offset_ - names_offset_ || index_offset_ > data_offset_ ||
+                data_offset_ - index_offset_ != uint64_t(block_count_) * ANNOTATION_INDEX_ENTRY_SIZE ||
+                data_offset_ > file_size) {
+                fail("truncated or corrupt annotation header");
+                return;
+            }
+            size_ = static_cast<size_t>(file_size);
+
+            // Every name lies inside the name bytes and ends in its NUL
+            names_ = data_ + names_offset_ + names_bytes;
+            uint64_t names_size = index_offset_ - names_offset_ - names_bytes;
+            const uint8_t* offsets = data_ + names_offset_;
+            for (uint32_t p = 0; p < pattern_count_; ++p) {
+                uint64_t begin = detail::load_le(offsets + p * 4, 4), end = detail::load_le(offsets + p * 4 + 4, 4);
+                if (begin >= end || end > names_size || names_[end - 1] != 0) {
+                    fail("corrupt pattern dictionary");
+                    return;
+                }
+            }
+
+            // Blocks tile the data section in order, with non-decreasing first ticks
+            uint64_t records = 0, data_end = 0, tick = 0;
+            for (uint32_t b = 0; b < block_count_; ++b) {
+                AnnotationBlock entry = block(b);
+                if (entry.first_record != records || entry.data_offset != data_end || entry.first_tick < tick) {
+                    fail("corrupt block index");
+                    return;
+                }
+                records += entry.record_count;
+                data_end += entry.byte_size;
+                tick = entry.first_tick;
+            }
+            if (records != record_count_ || data_offset_ + data_end != file_size) {
+                fail("corrupt block index");
+                return;
+            }
+
+            // Records fill their blocks exactly, and no block starts before the last record of the previous one
+            uint64_t last_tick = 0;
+            for (uint32_t b = 0; b < block_count_; ++b) {
+                Cursor cursor = block_cursor(b);
+                if (cursor.tick < last_tick) {
+                    fail("block starts before the previous block ends");
+                    return;
+                }
+                ChordChange change;
+                while (cursor.remaining > 0) {
+                    if (!decode(cursor, change)) return;
+                }
+                if (cursor.pos != cursor.end) {
+                    fail("corrupt record");
+                    return;
+                }
+                last_tick = cursor.tick;
+            }
+            rewind();
+        }
+
+        Cursor block_cursor(size_t index) const {
+            if (index >= block_count_) return {index, nullptr, nullptr, 0, 0};
+            AnnotationBlock entry = block(index);
+            const uint8_t* begin = data_ + data_offset_ + entry.data_offset;
+            return {index, begin, begin + entry.byte_size, entry.record_count, entry.first_tick};
+        }
+
+        void start_block(size_t index) { cursor_ = block_cursor(index); }
+
+        bool decode(Cursor& cursor, ChordChange& change) {
+            uint64_t delta, code;
+            const uint8_t* pos = detail::load_varint(cursor.pos, cursor.end, delta);
+            if (!pos || pos == cursor.end) {
+                fail("corrupt record");
+                return false;
+            }
+            uint8_t pitch_classes = *pos++;
+            pos = detail::load_varint(pos, cursor.end, code);
+            uint8_t root = pitch_classes >> 4, bass = pitch_classes & 15;
+            uint8_t flags = static_cast<uint8_t>(code & 3);
+            uint64_t pattern = code >> 2;
+            bool matched = (flags & CHORD_FLAG_MATCHED) != 0;
+            if (!pos || (matched && (pattern >= pattern_count_ || root >= 12 || bass >= 12)) || (!matched && code != 0) ||
+                cursor.tick + delta < cursor.tick) {
+                fail("corrupt record");
+                return false;
+            }
+
+            cursor.pos = pos;
+            cursor.tick += delta;
+            --cursor.remaining;
+            change.tick = cursor.tick;
+            change.chord = {root < 12 ? root : NO_PITCH_CLASS, bass < 12 ? bass : NO_PITCH_CLASS,
+                            matched ? static_cast<uint16_t>(pattern) : PATTERN_NONE, flags};
+            return true;
+        }
+
+        // Pattern name in place, at full length (open() checked that every name ends in its NUL); "" when unmatched
+        const char* suffix_of(const PackedChordResult& chord) const {
+            if (!(chord.flags & CHORD_FLAG_MATCHED) || !ok() || chord.pattern_id >= pattern_count_) return "";
+            return pattern_name(chord.pattern_id).data();
+        }
+
+        std::vector<uint8_t> owned_;        // File contents when opened from a path
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        const char* error_ = nullptr;
+
+        uint16_t version_ = 0;
+        uint32_t ticks_per_quarter_ = 0;
+        uint32_t pattern_count_ = 0;
+        uint64_t record_count_ = 0;
+        uint32_t block_count_ = 0;
+        uint64_t names_offset_ = 0;
+        uint64_t index_offset_ = 0;
+        uint64_t data_offset_ = 0;
+        const uint8_t* names_ = nullptr;
+
+        Cursor cursor_ = {0, nullptr, nullptr, 0, 0};
+    };
+}
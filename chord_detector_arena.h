@@ -0,0 +1,277 @@
+#pragma once
+
+#include "chord_detector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+/**
+ * Arena-backed bulk analysis: results of a whole batch live in one caller-owned arena and are
+ * released together by reset(), instead of each result owning its strings and vectors.
+ * The arena hands out memory from a few large blocks taken from an upstream memory_resource;
+ * reset() keeps the blocks, so a worker that analyzes batch after batch stops allocating once
+ * the arena has grown to its largest batch. It is itself a std::pmr::memory_resource, so pmr
+ * containers can share it.
+ *
+ * Result values are views: built-in chord names point into the shared name pool (never copied),
+ * names of custom vocabularies are formatted into the arena, and note-name and interval lists
+ * are arena arrays. Everything stays valid until the next reset() or release().
+ *
+ * Usage:
+ *   ChordDetector::AnalysisArena arena;                            // or (block_size, upstream)
+ *   for each batch:
+ *       arena.reset();
+ *       auto details = get_detailed_analysis_batch(notes, offsets, count, arena);
+ *       for (const ChordDetector::DetailedAnalysisView& d : details) use(d.chord.full_name, d.intervals_from_root);
+ */
+
+namespace ChordDetector {
+    // Read-only view of count contiguous elements
+    template<typename T>
+    struct Span {
+        const T* ptr = nullptr;
+        size_t count = 0;
+
+        const T* data() const { return ptr; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const T* begin() const { return ptr; }
+        const T* end() const { return ptr + count; }
+        const T& operator[](size_t i) const { return ptr[i]; }
+    };
+
+    // ChordResult with views instead of owned strings
+    struct ChordResultView {
+        std::string_view full_name;
+        std::string_view chord_name;
+        std::string_view bass_note;
+        bool is_slash_chord;
+        int root_pitch_class;       // -1 if nothing matched, as in ChordResult
+        int bass_pitch_class;
+    };
+
+    // DetailedAnalysis with views and arena arrays instead of owned containers
+    struct DetailedAnalysisView {
+        ChordResultView chord;
+        std::string_view inversion_type;            // Static string ("root", "1st", ...)
+        Span<std::string_view> note_names;          // Static note names, ascending from C
+        Span<int> intervals_from_root;              // Empty if nothing matched
+    };
+
+    class AnalysisArena : public std::pmr::memory_resource {
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        explicit AnalysisArena(size_t block_size = DEFAULT_BLOCK_SIZE,
+                               std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : block_size_(block_size ? block_size : DEFAULT_BLOCK_SIZE), upstream_(upstream) {}
+
+        // Views into the arena would dangle in a copy
+        AnalysisArena(const AnalysisArena&) = delete;
+        AnalysisArena& operator=(const AnalysisArena&) = delete;
+
+        ~AnalysisArena() override { release(); }
+
+        // Forget everything allocated so far; the blocks are kept for reuse
+        void reset() {
+            current_ = 0;
+            offset_ = 0;
+            used_ = 0;
+        }
+
+        // Forget everything and return the blocks to the upstream resource
+        void release() {
+            for (const Block& block : blocks_) upstream_->deallocate(block.data, block.size, block.alignment);
+            blocks_.clear();
+            reset();
+        }
+
+        // Uninitialized storage for count objects of T, valid until reset() or release()
+        template<typename T>
+        T* allocate_array(size_t count) {
+            if (count > SIZE_MAX / sizeof(T)) throw std::bad_array_new_length();
+            return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        // Copy of a string, NUL-terminated in the arena
+        std::string_view copy(std::string_view text) {
+            char* out = allocate_array<char>(text.size() + 1);
+            std::memcpy(out, text.data(), text.size());
+            out[text.size()] = '\0';
+            return std::string_view(out, text.size());
+        }
+
+        size_t used() const { return used_; }             // Bytes handed out since the last reset
+        size_t capacity() const {                           // Bytes held in blocks
+            size_t total = 0;
+            for (const Block& block : blocks_) total += block.size;
+            return total;
+        }
+        size_t block_count() const { return blocks_.size(); }
+
+    private:
+        struct Block {
+            char* data;
+            size_t size;
+            size_t alignment;       // As requested upstream, for deallocate
+        };
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            if (bytes == 0) bytes = 1;
+            for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+                const Block& block = blocks_[current_];
+                // Align the address, not the offset: over-aligned requests may exceed the block's alignment
+                uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+                size_t start = static_cast<size_t>(((base + offset_ + alignment - 1) & ~uintptr_t(alignment - 1)) - base);
+                if (start <= block.size && bytes <= block.size - start) {
+                    offset_ = start + bytes;
+                    used_ += bytes;
+                    return block.data + start;
+                }
+            }
+
+            // Blocks double in size, so a batch needs O(log size) upstream allocations the first time
+            // A new block is aligned for the request, so the request fits at its start
+            size_t size = blocks_.empty() ? block_size_ : blocks_.back().size * 2;
+            if (size < bytes) size = bytes;
+            size_t block_alignment = alignment > alignof(std::max_align_t) ? alignment : alignof(std::max_align_t);
+            blocks_.push_back({static_cast<char*>(upstream_->allocate(size, block_alignment)), size, block_alignment});
+            current_ = blocks_.size() - 1;
+            offset_ = 0;
+            return do_allocate(bytes, alignment);
+        }
+
+        // Memory is only reclaimed by reset() and release()
+        void do_deallocate(void*, size_t, size_t) override {}
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        size_t block_size_;
+        std::pmr::memory_resource* upstream_;
+        std::vector<Block> blocks_;
+        size_t current_ = 0;        // Block being filled
+        size_t offset_ = 0;         // Bytes used in it
+        size_t used_ = 0;
+    };
+
+    // Unmatched results have empty names and pitch classes of -1, as in ChordResult
+    inline ChordResultView unmatched_result_view() { return {{}, {}, {}, false, -1, -1}; }
+
+    // Views into the built-in name pool; nothing is allocated
+    inline ChordResultView chord_result_view(const PackedChordResult& chord, bool use_flats = false,
+                                             uint32_t fields = FIELDS_ALL) {
+        if (!(chord.flags & CHORD_FLAG_MATCHED)) return unmatched_result_view();
+        ChordResultView view = {{}, {}, {}, (chord.flags & CHORD_FLAG_SLASH) != 0, chord.root_pc, chord.bass_pc};
+        if (fields & (FIELD_FULL_NAME | FIELD_CHORD_NAME)) {
+            const NamePool& pool = name_pool();
+            if (fields & FIELD_FULL_NAME) view.full_name = pool.full_name(chord, use_flats);
+            if (fields & FIELD_CHORD_NAME) view.chord_name = pool.chord_name(chord, use_flats);
+        }
+        if (fields & FIELD_BASS_NOTE) view.bass_note = (use_flats ? NOTE_NAMES_FLAT : NOTE_NAMES_SHARP)[chord.bass_pc];
+        return view;
+    }
+
+    // Names of a custom vocabulary, formatted into the arena (the chord name shares the full name's bytes)
+    inline ChordResultView chord_result_view(const PackedChordResult& chord, const char* suffix, AnalysisArena& arena,
+                                             bool use_flats = false, uint32_t fields = FIELDS_ALL) {
+        if (!(chord.flags & CHORD_FLAG_MATCHED)) return unmatched_result_view();
+        ChordResultView view = {{}, {}, {}, (chord.flags & CHORD_FLAG_SLASH) != 0, chord.root_pc, chord.bass_pc};
+        const char* const* note_names = use_flats ? NOTE_NAMES_FLAT : NOTE_NAMES_SHARP;
+        std::string_view bass = note_names[chord.bass_pc];
+        if (fields & (FIELD_FULL_NAME | FIELD_CHORD_NAME)) {
+            // Sized from the suffix, so names of any length are formatted in full
+            size_t chord_length = std::strlen(note_names[chord.root_pc]) + std::strlen(suffix);
+            size_t length = chord_length + (view.is_slash_chord ? bass.size() + 1 : 0);
+            char* buf = arena.allocate_array<char>(length + 1);
+            std::string_view name = format_chord_name(chord, suffix, buf, length + 1, use_flats);
+            if (fields & FIELD_FULL_NAME) view.full_name = name;
+            if (fields & FIELD_CHORD_NAME) view.chord_name = name.substr(0, chord_length);
+        }
+        if (fields & FIELD_BASS_NOTE) view.bass_note = bass;
+        return view;
+    }
+}
+
+// Bulk analysis into an arena (see pitch_class_sets_from_notes for the note layout): out[i] holds
+// the same values as analyze_chord for chord i. The span and its names live until the arena is reset.
+inline ChordDetector::Span<ChordDetector::ChordResultView> analyze_chords_batch(
+        const int* notes, const size_t* offsets, size_t chord_count, ChordDetector::AnalysisArena& arena,
+        bool use_flats = false, bool use_slash = false, uint32_t fields = ChordDetector::FIELDS_ALL) {
+    ChordDetector::ChordResultView* out = arena.allocate_array<ChordDetector::ChordResultView>(chord_count);
+    constexpr size_t block = 256;
+    PackedChordResult packed[block];
+    for (size_t begin = 0; begin < chord_count; begin += block) {
+        size_t count = chord_count - begin < block ? chord_count - begin : block;
+        analyze_chords_batch(notes, offsets + begin, count, packed, use_slash);
+        for (size_t i = 0; i < count; ++i) out[begin + i] = ChordDetector::chord_result_view(packed[i], use_flats, fields);
+    }
+    return {out, chord_count};
+}
+
+inline ChordDetector::Span<ChordDetector::ChordResultView> analyze_chords_batch(
+        const ChordDictionary& dictionary, const int* notes, const size_t* offsets, size_t chord_count,
+        ChordDetector::AnalysisArena& arena, bool use_flats = false, bool use_slash = false,
+        uint32_t fields = ChordDetector::FIELDS_ALL) {
+    ChordDetector::ChordResultView* out = arena.allocate_array<ChordDetector::ChordResultView>(chord_count);
+    constexpr size_t block = 256;
+    uint16_t pc_masks[block];
+    uint8_t bass_pcs[block];
+    PackedChordResult packed[block];
+    for (size_t begin = 0; begin < chord_count; begin += block) {
+        size_t count = chord_count - begin < block ? chord_count - begin : block;
+        pitch_class_sets_from_notes(notes, offsets + begin, count, pc_masks, bass_pcs);
+        analyze_chords_batch(dictionary, pc_masks, bass_pcs, count, packed, use_slash);
+        for (size_t i = 0; i < count; ++i) {
+            out[begin + i] = ChordDetector::chord_result_view(packed[i], dictionary.suffix(packed[i].pattern_id), arena,
+                                                              use_flats, fields);
+        }
+    }
+    return {out, chord_count};
+}
+
+// Bulk get_detailed_analysis into an arena: the same values for chord i, with the note-name and
+// interval lists stored as arena arrays
+inline ChordDetector::Span<ChordDetector::DetailedAnalysisView> get_detailed_analysis_batch(
+        const int* notes, const size_t* offsets, size_t chord_count, ChordDetector::AnalysisArena& arena,
+        bool use_flats = false, uint32_t fields = ChordDetector::FIELDS_ALL) {
+    CHORD_DETECTOR_COUNT(DetailedAnalysis, chord_count);
+    ChordDetector::DetailedAnalysisView* out = arena.allocate_array<ChordDetector::DetailedAnalysisView>(chord_count);
+    const char* const* note_names = use_flats ? ChordDetector::NOTE_NAMES_FLAT : ChordDetector::NOTE_NAMES_SHARP;
+    bool want_names = (fields & ChordDetector::FIELD_NOTE_NAMES) != 0;
+    bool want_intervals = (fields & ChordDetector::FIELD_INTERVALS) != 0;
+
+    constexpr size_t block = 256;
+    uint16_t pc_masks[block];
+    uint8_t bass_pcs[block];
+    PackedChordResult packed[block];
+    for (size_t begin = 0; begin < chord_count; begin += block) {
+        size_t count = chord_count - begin < block ? chord_count - begin : block;
+        pitch_class_sets_from_notes(notes, offsets + begin, count, pc_masks, bass_pcs);
+        analyze_chords_batch(pc_masks, bass_pcs, count, packed, true);
+
+        for (size_t i = 0; i < count; ++i) {
+            ChordDetector::DetailedAnalysisView& d = out[begin + i];
+            d.chord = ChordDetector::chord_result_view(packed[i], use_flats, fields);
+            d.inversion_type = (fields & ChordDetector::FIELD_INVERSION) ? inversion_name(get_inversion(packed[i])) : "";
+
+            uint16_t mask = pc_masks[i];
+            size_t n = static_cast<size_t>(ChordDetector::count_pitch_classes(mask));
+            bool matched = want_intervals && (packed[i].flags & ChordDetector::CHORD_FLAG_MATCHED);
+            std::string_view* names = want_names ? arena.allocate_array<std::string_view>(n) : nullptr;
+            int* intervals = matched ? arena.allocate_array<int>(n) : nullptr;
+            size_t k = 0;
+            for (int pc = 0; pc < 12 && (names || intervals); ++pc) {
+                if (!(mask & (1 << pc))) continue;
+                if (names) names[k] = note_names[pc];
+                if (intervals) intervals[k] = (pc - packed[i].root_pc + 12) % 12;
+                ++k;
+            }
+            d.note_names = {names, names ? n : 0};
+            d.intervals_from_root = {intervals, intervals ? n : 0};
+        }
+    }
+    return {out, chord_count};
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "chord_detector.h"
+
+#include <initializer_list>
+#include <vector>
+
+/**
+ * Chord tracking for many MIDI channels at once (e.g. 128 channels per DAW session)
+ * Held-note state is kept as structure-of-arrays: a 128-bit note set, the bass note, the
+ * pitch-class set and the last result per channel. Events only mark their channel dirty;
+ * flush() looks each dirty channel up once, so a block of events costs one lookup per
+ * channel that changed, however many events it held. Merge groups (e.g. the two hands of
+ * a piano part on separate channels) are detected from the union of their channels.
+ * All storage is allocated at construction; processing never allocates.
+ *
+ * Usage:
+ *   ChordDetector::ChordTrackerBank bank(128, true);           // channels, use_slash
+ *   size_t piano = bank.merge({0, 1});                         // left + right hand
+ *   bank.process(events, event_count);                         // event.channel selects the channel
+ *   for (uint32_t channel : bank.changed_channels()) show(channel, bank.current(channel));
+ *   if (bank.group_changed(piano)) show_piano(bank.group_current(piano));
+ */
+
+namespace ChordDetector {
+    class ChordTrackerBank {
+    public:
+        static constexpr uint8_t NO_NOTE = 0xFF;
+
+        explicit ChordTrackerBank(size_t channel_count, bool use_slash = false)
+            : table_(&lookup_table()), use_slash_(use_slash) {
+            allocate(channel_count);
+        }
+
+        // Track chords from a custom vocabulary; the dictionary must outlive the bank
+        ChordTrackerBank(const ChordDictionary& dictionary, size_t channel_count, bool use_slash = false)
+            : table_(dictionary.tabulated() ? &dictionary.table() : nullptr),
+              dictionary_(dictionary.tabulated() ? nullptr : &dictionary), use_slash_(use_slash) {
+            allocate(channel_count);
+        }
+
+        size_t channel_count() const { return bass_.size(); }
+
+        // Detect a group of channels as one part from the union of their held notes. Returns the group
+        // index. Groups may overlap; adding one allocates, so set them up before processing.
+        size_t merge(const uint32_t* channels, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                if (channels[i] < channel_count()) group_members_.push_back(channels[i]);
+            }
+            group_offsets_.push_back(group_members_.size());
+            group_current_.push_back(EMPTY);
+            group_masks_.push_back(0);
+            group_changed_.push_back(0);
+            changed_groups_.reserve(group_current_.size());
+            return group_current_.size() - 1;
+        }
+
+        size_t merge(std::initializer_list<uint32_t> channels) {
+            return merge(channels.begin(), channels.size());
+        }
+
+        size_t group_count() const { return group_current_.size(); }
+
+        // Note state changes take effect at the next flush(). A note is held or not: repeated
+        // note-ons of one note on one channel are released by a single note-off.
+        void note_on(uint32_t channel, int midi) {
+            if (channel >= channel_count() || midi < 0 || midi > 127) return;
+            uint64_t& word = held_[channel * 2 + (midi >> 6)];
+            uint64_t bit = uint64_t(1) << (midi & 63);
+            if (word & bit) return;
+            word |= bit;
+            mark_dirty(channel);
+        }
+
+        void note_off(uint32_t channel, int midi) {
+            if (channel >= channel_count() || midi < 0 || midi > 127) return;
+            uint64_t& word = held_[channel * 2 + (midi >> 6)];
+            uint64_t bit = uint64_t(1) << (midi & 63);
+            if (!(word & bit)) return;
+            word &= ~bit;
+            mark_dirty(channel);
+        }
+
+        void apply(uint32_t channel, const NoteEvent& event) {
+            if (event.on) note_on(channel, event.note);
+            else note_off(channel, event.note);
+        }
+
+        // Look up every channel touched since the last flush, then every group with a touched member.
+        // Returns the number of channels whose chord changed (see changed_channels()).
+        size_t flush() {
+            // The previous flush's group flags are cleared even when nothing is dirty
+            for (uint32_t group : changed_groups_) group_changed_[group] = 0;
+            changed_.clear();
+            changed_groups_.clear();
+            if (dirty_count_ == 0) return 0;
+
+            for (size_t word = 0; word < dirty_.size(); ++word) {
+                for (uint64_t bits = dirty_[word]; bits; bits &= bits - 1) {
+                    uint32_t channel = static_cast<uint32_t>(word * 64 + lowest_bit(bits));
+                    if (refresh(channel)) changed_.push_back(channel);
+                }
+            }
+
+            for (size_t group = 0; group < group_current_.size(); ++group) {
+                group_changed_[group] = 0;
+                bool touched = false;
+                for (size_t i = group_offsets_[group]; i < group_offsets_[group + 1] && !touched; ++i) {
+                    uint32_t channel = group_members_[i];
+                    touched = (dirty_[channel >> 6] >> (channel & 63)) & 1;
+                }
+                if (touched && refresh_group(group)) {
+                    group_changed_[group] = 1;
+                    changed_groups_.push_back(static_cast<uint32_t>(group));
+                }
+            }
+
+            std::fill(dirty_.begin(), dirty_.end(), 0);
+            dirty_count_ = 0;
+            return changed_.size();
+        }
+
+        // One block of events, channel taken from event.channel, followed by flush()
+        size_t process(const NoteEvent* events, size_t count) {
+            for (size_t i = 0; i < count; ++i) apply(events[i].channel, events[i]);
+            return flush();
+        }
+
+        // One block of events on explicit channel indices, for banks of more than 256 channels
+        // (e.g. session * 16 + MIDI channel)
+        size_t process(const NoteEvent* events, const uint32_t* channels, size_t count) {
+            for (size_t i = 0; i < count; ++i) apply(channels[i], events[i]);
+            return flush();
+        }
+
+        // Channels and groups whose chord changed at the last flush(), ascending
+        const std::vector<uint32_t>& changed_channels() const { return changed_; }
+        const std::vector<uint32_t>& changed_groups() const { return changed_groups_; }
+        bool group_changed(size_t group) const { return group_changed_[group] != 0; }
+
+        const PackedChordResult& current(uint32_t channel) const { return current_[channel]; }
+        const PackedChordResult& group_current(size_t group) const { return group_current_[group]; }
+
+        // Pitch-class set and lowest held note as of the last flush(); NO_NOTE if nothing is held
+        uint16_t pitch_class_mask(uint32_t channel) const { return masks_[channel]; }
+        uint8_t bass_note(uint32_t channel) const { return bass_[channel]; }
+
+        // Held notes right now, as a 128-bit set: word 0 holds notes 0-63, word 1 notes 64-127
+        const uint64_t* held_notes(uint32_t channel) const { return held_.data() + channel * 2; }
+
+        // Release every note of one channel (takes effect at the next flush())
+        void release(uint32_t channel) {
+            if (channel >= channel_count()) return;
+            if (held_[channel * 2] | held_[channel * 2 + 1]) mark_dirty(channel);
+            held_[channel * 2] = held_[channel * 2 + 1] = 0;
+        }
+
+        // Release everything and forget all results; groups are kept
+        void reset() {
+            std::fill(held_.begin(), held_.end(), 0);
+            std::fill(bass_.begin(), bass_.end(), NO_NOTE);
+            std::fill(masks_.begin(), masks_.end(), 0);
+            std::fill(current_.begin(), current_.end(), EMPTY);
+            std::fill(dirty_.begin(), dirty_.end(), 0);
+            std::fill(group_current_.begin(), group_current_.end(), EMPTY);
+            std::fill(group_masks_.begin(), group_masks_.end(), 0);
+            std::fill(group_changed_.begin(), group_changed_.end(), 0);
+            dirty_count_ = 0;
+            changed_.clear();
+            changed_groups_.clear();
+        }
+
+    private:
+        static constexpr PackedChordResult EMPTY = {NO_PITCH_CLASS, NO_PITCH_CLASS, PATTERN_NONE, 0};
+
+        // Pitch-class set of a 128-bit note set; octaves start at notes 0, 12, ..., 120 and the one
+        // at 60 straddles the two words
+        static uint16_t fold_pitch_classes(uint64_t low, uint64_t high) {
+            uint64_t mask = low | (low >> 12) | (low >> 24) | (low >> 36) | (low >> 48);
+            mask |= (low >> 60) | (high << 4);
+            mask |= (high >> 8) | (high >> 20) | (high >> 32) | (high >> 44) | (high >> 56);
+            return static_cast<uint16_t>(mask & 0xFFF);
+        }
+
+        void allocate(size_t channel_count) {
+            held_.assign(channel_count * 2, 0);
+            bass_.assign(channel_count, NO_NOTE);
+            masks_.assign(channel_count, 0);
+            current_.assign(channel_count, EMPTY);
+            dirty_.assign((channel_count + 63) / 64, 0);
+            changed_.reserve(channel_count);
+            group_offsets_.assign(1, 0);
+        }
+
+        void mark_dirty(uint32_t channel) {
+            uint64_t& word = dirty_[channel >> 6];
+            uint64_t bit = uint64_t(1) << (channel & 63);
+            dirty_count_ += !(word & bit);
+            word |= bit;
+        }
+
+        PackedChordResult lookup(uint16_t pc_mask, int bass_pc) const {
+            return table_ ? lookup_chord(*table_, pc_mask, bass_pc, use_slash_) : dictionary_->lookup(pc_mask, bass_pc, use_slash_);
+        }
+
+        // Re-derive one channel from its note set; the chord is only looked up if the pitch-class set
+        // or the bass pitch class moved (an added octave doubling, for instance, changes neither)
+        bool refresh(uint32_t channel) {
+            uint64_t low = held_[channel * 2], high = held_[channel * 2 + 1];
+            uint16_t mask = fold_pitch_classes(low, high);
+            uint8_t bass = low ? static_cast<uint8_t>(lowest_bit(low))
+                         : high ? static_cast<uint8_t>(64 + lowest_bit(high)) : NO_NOTE;
+            bass_[channel] = bass;
+
+            uint8_t bass_pc = bass == NO_NOTE ? NO_PITCH_CLASS : MIDI_PITCH_CLASS[bass];
+            if (mask == masks_[channel] && bass_pc == current_[channel].bass_pc) {
+                CHORD_DETECTOR_COUNT(TrackerHits, 1);
+                return false;
+            }
+            CHORD_DETECTOR_COUNT(TrackerMisses, 1);
+
+            masks_[channel] = mask;
+            PackedChordResult next = lookup(mask, bass == NO_NOTE ? -1 : bass_pc);
+            bool changed = !same_chord(next, current_[channel]);
+            current_[channel] = next;
+            return changed;
+        }
+
+        // Union of the members: pitch-class sets OR together and the lowest bass note wins
+        bool refresh_group(size_t group) {
+            uint16_t mask = 0;
+            uint8_t bass = NO_NOTE;
+            for (size_t i = group_offsets_[group]; i < group_offsets_[group + 1]; ++i) {
+                uint32_t channel = group_members_[i];
+                mask |= masks_[channel];
+                if (bass_[channel] < bass) bass = bass_[channel];
+            }
+
+            uint8_t bass_pc = bass == NO_NOTE ? NO_PITCH_CLASS : MIDI_PITCH_CLASS[bass];
+            PackedChordResult& current = group_current_[group];
+            if (mask == group_masks_[group] && bass_pc == current.bass_pc) return false;
+
+            group_masks_[group] = mask;
+            PackedChordResult next = lookup(mask, bass == NO_NOTE ? -1 : bass_pc);
+            bool changed = !same_chord(next, current);
+            current = next;
+            return changed;
+        }
+
+        const LookupTable* table_;
+        const ChordDictionary* dictionary_ = nullptr;   // Untabulated vocabulary, used when table_ is null
+        bool use_slash_;
+
+        // Per channel
+        std::vector<uint64_t> held_;                // 128-bit note set, two words per channel
+        std::vector<uint8_t> bass_;                 // Lowest held note at the last flush, NO_NOTE if none
+        std::vector<uint16_t> masks_;               // Pitch-class set of current_
+        std::vector<PackedChordResult> current_;
+        std::vector<uint64_t> dirty_;               // Channels touched since the last flush, one bit each
+        size_t dirty_count_ = 0;
+        std::vector<uint32_t> changed_;
+
+        // Per merge group; members of group g are group_members_[group_offsets_[g] .. group_offsets_[g + 1])
+        std::vector<uint32_t> group_members_;
+        std::vector<size_t> group_offsets_;
+        std::vector<PackedChordResult> group_current_;
+        std::vector<uint16_t> group_masks_;
+        std::vector<uint8_t> group_changed_;
+        std::vector<uint32_t> changed_groups_;
+    };
+}
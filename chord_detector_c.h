@@ -0,0 +1,87 @@
+#ifndef CHORD_DETECTOR_C_H
+#define CHORD_DETECTOR_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Stable C ABI of the compiled chord detector library (chord_detector_static / chord_detector_shared)
+ * Plain structs and functions only, so it can be called from C and through FFIs.
+ * Bump CD_ABI_VERSION on any incompatible change.
+ *
+ * Usage:
+ *   int notes[] = {71, 74, 77, 79};
+ *   cd_result chord = cd_analyze(notes, 4, 1);   // G7/B: root_pc 7, bass_pc 11
+ *
+ *   // Batch over caller-owned arrays (e.g. NumPy / Arrow buffers), names resolved only when needed
+ *   cd_analyze_batch(masks, bass, n, out, 1);
+ *   char name[CD_NAME_CAPACITY];
+ *   cd_format(&out[0], 0, name, sizeof(name));
+ */
+
+#define CD_ABI_VERSION 1
+
+#ifndef CHORD_DETECTOR_API
+#if defined(_WIN32) && defined(CHORD_DETECTOR_SHARED)
+#ifdef CHORD_DETECTOR_BUILDING
+#define CHORD_DETECTOR_API __declspec(dllexport)
+#else
+#define CHORD_DETECTOR_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+#define CHORD_DETECTOR_API __attribute__((visibility("default")))
+#else
+#define CHORD_DETECTOR_API
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Same layout as the C++ PackedChordResult */
+typedef struct cd_result {
+    uint8_t root_pc;        /* Root note (0-11), CD_NO_PITCH_CLASS if nothing matched */
+    uint8_t bass_pc;        /* Bass note (0-11), CD_NO_PITCH_CLASS if no valid notes */
+    uint16_t pattern_id;    /* Pattern index, CD_PATTERN_NONE if nothing matched */
+    uint16_t flags;         /* CD_FLAG_* bits */
+} cd_result;
+
+#define CD_PATTERN_NONE 0xFFFF
+#define CD_NO_PITCH_CLASS 0xFF
+#define CD_FLAG_MATCHED 0x1
+#define CD_FLAG_SLASH 0x2
+#define CD_NAME_CAPACITY 32    /* Fits every built-in chord name */
+
+/* CD_ABI_VERSION the library was built with */
+CHORD_DETECTOR_API uint32_t cd_abi_version(void);
+
+/* Analyze MIDI notes (0-127; others are ignored) */
+CHORD_DETECTOR_API cd_result cd_analyze(const int* notes, size_t count, int use_slash);
+
+/* Look up a 12-bit pitch-class mask with its bass pitch class (0-11) */
+CHORD_DETECTOR_API cd_result cd_lookup(uint16_t pc_mask, uint8_t bass_pc, int use_slash);
+
+/* Look up n masks with their bass pitch classes into out; bass values outside 0-11 give unmatched results */
+CHORD_DETECTOR_API void cd_analyze_batch(const uint16_t* pc_masks, const uint8_t* bass_pcs, size_t n,
+                                         cd_result* out, int use_slash);
+
+/* Analyze chord_count chords from a flat note buffer; chord i is notes[offsets[i]] .. notes[offsets[i + 1] - 1] */
+CHORD_DETECTOR_API void cd_analyze_notes_batch(const int* notes, const size_t* offsets, size_t chord_count,
+                                               cd_result* out, int use_slash);
+
+/* Write the chord name ("G7/B", "" if unmatched or out of range) NUL-terminated into buf, truncating to cap - 1 characters.
+   Returns the length written. */
+CHORD_DETECTOR_API size_t cd_format(const cd_result* chord, int use_flats, char* buf, size_t cap);
+
+/* Interned name tables: static strings that stay valid for the life of the process */
+CHORD_DETECTOR_API size_t cd_pattern_count(void);
+CHORD_DETECTOR_API const char* const* cd_pattern_suffixes(void);       /* Indexed by pattern_id */
+CHORD_DETECTOR_API const char* cd_pattern_suffix(uint16_t pattern_id); /* "" if out of range */
+CHORD_DETECTOR_API const char* cd_note_name(uint8_t pitch_class, int use_flats);  /* "" if out of range */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
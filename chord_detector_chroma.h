@@ -0,0 +1,197 @@
+#pragma once
+
+#include "chord_detector.h"
+
+#include <cmath>
+#include <vector>
+
+/**
+ * Chroma (pitch-class profile) front end for audio input
+ * Scores every (root, pattern) template of a pattern set against a 12-bin chroma
+ * frame by cosine similarity and returns the same PackedChordResult as the MIDI
+ * path. Templates are stored bin-major so the score loop is a run of contiguous
+ * multiply-adds the compiler vectorizes; no per-frame allocation.
+ *
+ * Usage:
+ *   ChordDetector::ChromaChordDetector detector;
+ *   PackedChordResult chord = detector.analyze(chroma, bass_chroma);   // float[12] each, bass optional
+ *   detector.analyze_block(frames, bass_frames, frame_count, 12, out); // strided frames, one call
+ */
+
+namespace ChordDetector {
+    struct ChromaOptions {
+        float min_energy = 1e-6f;       // Frames whose chroma sums below this are silent (no chord)
+        float min_score = 0.5f;         // Best cosine similarity below this gives no chord
+        float priority_weight = 1e-4f;  // Score per pattern priority point; breaks ties toward common readings
+        float root_bonus = 0.05f;       // Added when the root is the bass (bass chroma given)
+        bool use_slash = false;         // Write bass != root as a slash chord (bass chroma given)
+    };
+
+    class ChromaChordDetector {
+    public:
+        // The dictionary (if any) must outlive the detector
+        explicit ChromaChordDetector(const ChromaOptions& options = ChromaOptions(),
+                                     const ChordDictionary* dictionary = nullptr)
+            : options_(options) {
+            const PatternSet& set = dictionary ? dictionary->pattern_set() : BUILTIN_PATTERNS;
+
+            // Same scan order as the MIDI path: root 0-11, then table order
+            for (int root = 0; root < 12; ++root) {
+                for (uint16_t p = 0; p < set.count; ++p) {
+                    if (is_sentinel_pattern(set, p) || count_pitch_classes(set.patterns[p].mask) < 2) continue;
+                    pattern_ids_.push_back(p);
+                    roots_.push_back(static_cast<uint8_t>(root));
+                }
+            }
+
+            // Padded to whole blocks; padding templates are scored but never visited
+            template_count_ = pattern_ids_.size();
+            size_t padded = (template_count_ + BLOCK - 1) / BLOCK * BLOCK;
+            weights_.assign(12 * padded, 0.0f);
+            bias_.assign(padded, 0.0f);
+
+            for (size_t t = 0; t < template_count_; ++t) {
+                const ChordPattern& pattern = set.patterns[pattern_ids_[t]];
+                float weight = 1.0f / std::sqrt(static_cast<float>(count_pitch_classes(pattern.mask)));
+                for (int interval = 0; interval < 12; ++interval) {
+                    if (pattern.mask & (1 << interval)) weights_[((roots_[t] + interval) % 12) * padded + t] = weight;
+                }
+                bias_[t] = options_.priority_weight * static_cast<float>(pattern.priority);
+            }
+            stride_ = padded;
+        }
+
+        const ChromaOptions& options() const { return options_; }
+        size_t template_count() const { return template_count_; }
+
+        // chroma: 12 non-negative bins starting at C; bass_chroma: optional 12 bins of the low register.
+        // score (if given) receives the winning cosine similarity.
+        PackedChordResult analyze(const float* chroma, const float* bass_chroma = nullptr, float* score = nullptr) const {
+            PackedChordResult none = {NO_PITCH_CLASS, NO_PITCH_CLASS, PATTERN_NONE, 0};
+            if (score) *score = 0.0f;
+
+            // First maximum in template order wins ties
+            float best = -1e30f, best_similarity = 0.0f;
+            size_t best_index = 0;
+            int bass_pc = -1;
+            bool voiced = score_frame(chroma, bass_chroma, bass_pc, [&](size_t t, float total, float similarity) {
+                if (total > best) {
+                    best = total;
+                    best_similarity = similarity;
+                    best_index = t;
+                }
+            });
+
+            if (!voiced || best_similarity < options_.min_score) return none;
+            if (score) *score = best_similarity;
+            return make_result(best_index, bass_pc);
+        }
+
+        // Up to capacity best readings, highest score (similarity plus priors) first, for sequence decoding.
+        // Readings below min_score are left out; returns the number written.
+        size_t analyze_candidates(const float* chroma, const float* bass_chroma, ScoredChord* out, size_t capacity) const {
+            size_t count = 0;
+            size_t indices[MAX_CANDIDATES];
+            float totals[MAX_CANDIDATES];
+            if (capacity > MAX_CANDIDATES) capacity = MAX_CANDIDATES;
+            if (capacity == 0) return 0;
+
+            int bass_pc = -1;
+            score_frame(chroma, bass_chroma, bass_pc, [&](size_t t, float total, float similarity) {
+                if (similarity < options_.min_score) return;
+                if (count == capacity && total <= totals[count - 1]) return;
+
+                size_t pos = count < capacity ? count++ : capacity - 1;
+                while (pos > 0 && totals[pos - 1] < total) {
+                    totals[pos] = totals[pos - 1];
+                    indices[pos] = indices[pos - 1];
+                    --pos;
+                }
+                totals[pos] = total;
+                indices[pos] = t;
+            });
+
+            for (size_t i = 0; i < count; ++i) out[i] = {make_result(indices[i], bass_pc), totals[i]};
+            return count;
+        }
+
+        // frame_count frames, frame i at chroma[i * stride] (stride >= 12, e.g. an interleaved feature matrix);
+        // bass_chroma may be null, otherwise it uses the same stride. A convenience loop over analyze(): the
+        // built-in weights (768 templates x 12 bins, ~36 KB) stay in L1 between frames, and scoring a tile of
+        // frames per weight row measured slower than this loop, so no work is shared across frames.
+        void analyze_block(const float* chroma, const float* bass_chroma, size_t frame_count, size_t stride,
+                           PackedChordResult* out) const {
+            for (size_t i = 0; i < frame_count; ++i) {
+                out[i] = analyze(chroma + i * stride, bass_chroma ? bass_chroma + i * stride : nullptr);
+            }
+        }
+
+        // Largest capacity analyze_candidates() fills
+        static constexpr size_t MAX_CANDIDATES = 32;
+
+    private:
+        static constexpr size_t BLOCK = 64;     // Templates scored per pass; fits in registers/L1
+
+        // Score every template of a frame: visit(template, similarity + priors, similarity) in template order.
+        // False for silent frames (nothing is visited).
+        template<typename Visit>
+        bool score_frame(const float* chroma, const float* bass_chroma, int& bass_pc, Visit&& visit) const {
+            float energy = 0.0f, norm = 0.0f;
+            for (int bin = 0; bin < 12; ++bin) {
+                energy += chroma[bin];
+                norm += chroma[bin] * chroma[bin];
+            }
+            if (energy < options_.min_energy || norm <= 0.0f || template_count_ == 0) return false;
+
+            bass_pc = bass_chroma ? strongest_bin(bass_chroma) : -1;
+            float scale = 1.0f / std::sqrt(norm);
+            float frame[12];
+            for (int bin = 0; bin < 12; ++bin) frame[bin] = chroma[bin] * scale;
+
+            float scores[BLOCK];
+            for (size_t begin = 0; begin < stride_; begin += BLOCK) {
+                for (size_t j = 0; j < BLOCK; ++j) scores[j] = 0.0f;
+                for (int bin = 0; bin < 12; ++bin) {
+                    const float* row = weights_.data() + bin * stride_ + begin;
+                    float value = frame[bin];
+                    for (size_t j = 0; j < BLOCK; ++j) scores[j] += row[j] * value;
+                }
+                size_t end = template_count_ - begin < BLOCK ? template_count_ - begin : BLOCK;
+                for (size_t j = 0; j < end; ++j) {
+                    size_t t = begin + j;
+                    float total = scores[j] + bias_[t];
+                    if (roots_[t] == bass_pc) total += options_.root_bonus;
+                    visit(t, total, scores[j]);
+                }
+            }
+            return true;
+        }
+
+        PackedChordResult make_result(size_t t, int bass_pc) const {
+            uint8_t root = roots_[t];
+            bool slash = options_.use_slash && bass_pc >= 0 && bass_pc != root;
+            return {root, static_cast<uint8_t>(bass_pc >= 0 ? bass_pc : root), pattern_ids_[t],
+                    static_cast<uint16_t>(CHORD_FLAG_MATCHED | (slash ? CHORD_FLAG_SLASH : 0))};
+        }
+
+        static int strongest_bin(const float* bins) {
+            int best = -1;
+            float best_value = 0.0f;
+            for (int bin = 0; bin < 12; ++bin) {
+                if (bins[bin] > best_value) {
+                    best_value = bins[bin];
+                    best = bin;
+                }
+            }
+            return best;
+        }
+
+        ChromaOptions options_;
+        size_t template_count_ = 0;
+        size_t stride_ = 0;                     // Padded template count; weights_ row length
+        std::vector<float> weights_;            // [bin][template], 1/sqrt(pattern size) where the template has the bin
+        std::vector<float> bias_;               // Priority prior per template
+        std::vector<uint16_t> pattern_ids_;
+        std::vector<uint8_t> roots_;
+    };
+}
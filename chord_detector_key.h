@@ -0,0 +1,235 @@
+#pragma once
+
+#include "chord_detector.h"
+#include "chord_detector_progression.h"
+
+#include <cmath>
+
+/**
+ * Sliding-window key estimation from the pitch classes held in a ChordTracker
+ * Held notes are credited by duration into a ring of time buckets (integer note-ticks per pitch
+ * class, so sliding never drifts); each update is O(1). The key is the best Pearson correlation of
+ * the window histogram with the 24 rotated Krumhansl-Kessler profiles, computed when asked.
+ * The detected key picks the spelling (use_flats) instead of a per-call boolean.
+ *
+ * Usage:
+ *   ChordDetector::ChordKeyTracker tracker;          // ChordTracker + KeyEstimator over one state
+ *   for each NoteEvent event:
+ *       if (tracker.apply(event)) print(tracker.chord_name(buf, sizeof(buf)));   // "Bb/D" in F major
+ *   ChordDetector::Key key = tracker.key();
+ */
+
+namespace ChordDetector {
+    // Krumhansl-Kessler probe-tone profiles, tonic first
+    inline constexpr double KEY_PROFILE_MAJOR[12] = {6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88};
+    inline constexpr double KEY_PROFILE_MINOR[12] = {6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17};
+
+    // Conventional spelling of a key signature: flats for F, Bb, Eb, Ab, Db, Gb major and their relative minors
+    constexpr bool key_uses_flats(const Key& key) {
+        int major_tonic = key.mode == KeyMode::Minor ? (key.tonic_pc + 3) % 12 : key.tonic_pc;
+        return major_tonic == 5 || major_tonic == 10 || major_tonic == 3 || major_tonic == 8 ||
+               major_tonic == 1 || major_tonic == 6;
+    }
+
+    struct KeyOptions {
+        uint32_t window_ticks = 7680;   // Window length in event ticks (4 bars of 4/4 at 480 PPQ)
+        uint32_t buckets = 16;          // Ring resolution, at most KeyEstimator::MAX_BUCKETS
+    };
+
+    class KeyEstimator {
+    public:
+        static constexpr size_t MAX_BUCKETS = 64;
+
+        explicit KeyEstimator(const KeyOptions& options = KeyOptions()) : options_(options) {
+            if (options_.buckets == 0) options_.buckets = 1;
+            if (options_.buckets > MAX_BUCKETS) options_.buckets = MAX_BUCKETS;
+            bucket_ticks_ = options_.window_ticks / options_.buckets;
+            if (bucket_ticks_ == 0) bucket_ticks_ = 1;
+            reset();
+        }
+
+        const KeyOptions& options() const { return options_; }
+
+        // Empty window; the next advance() starts the clock
+        void reset() {
+            std::memset(buckets_, 0, sizeof(buckets_));
+            std::memset(totals_, 0, sizeof(totals_));
+            started_ = false;
+            now_ = 0;
+            dirty_ = false;
+            key_ = {0, KeyMode::Major};
+            correlation_ = 0.0;
+        }
+
+        // Credit the held notes (12 counts per pitch class) for the time since the last call, up to tick.
+        // Call before applying each event so every note is weighted by how long it sounded.
+        // Ticks must not decrease; earlier ticks only restart the clock.
+        void advance(uint32_t tick, const uint16_t* pc_counts) {
+            if (!started_ || tick < now_) {
+                started_ = true;
+                now_ = tick;
+                return;
+            }
+
+            uint64_t window = uint64_t(bucket_ticks_) * options_.buckets;
+            if (tick - now_ > window) {
+                // Everything before the last full window has slid out
+                std::memset(buckets_, 0, sizeof(buckets_));
+                std::memset(totals_, 0, sizeof(totals_));
+                now_ = tick - window;
+            }
+
+            while (now_ < tick) {
+                uint64_t bucket = now_ / bucket_ticks_;
+                uint64_t bucket_end = (bucket + 1) * bucket_ticks_;
+                uint64_t end = tick < bucket_end ? tick : bucket_end;
+                uint64_t* weights = buckets_[bucket % options_.buckets];
+                for (int pc = 0; pc < 12; ++pc) {
+                    uint64_t weight = pc_counts[pc] * (end - now_);
+                    weights[pc] += weight;
+                    totals_[pc] += weight;
+                }
+                now_ = end;
+
+                if (now_ == bucket_end) {
+                    // The next bucket's slot holds the oldest data in the window
+                    uint64_t* oldest = buckets_[(bucket + 1) % options_.buckets];
+                    for (int pc = 0; pc < 12; ++pc) {
+                        totals_[pc] -= oldest[pc];
+                        oldest[pc] = 0;
+                    }
+                }
+            }
+            dirty_ = true;
+        }
+
+        void advance(uint32_t tick, const ChordTracker& tracker) {
+            advance(tick, tracker.pitch_class_counts());
+        }
+
+        // Best-correlated key of the window; the last estimate is kept while the window is silent
+        const Key& key() const {
+            update();
+            return key_;
+        }
+
+        // Pearson correlation of the window with key()'s profile (-1..1), 0 before any estimate
+        double correlation() const {
+            update();
+            return correlation_;
+        }
+
+        bool use_flats() const { return key_uses_flats(key()); }
+
+        // Duration-weighted pitch-class histogram of the window (note-ticks)
+        const uint64_t* histogram() const { return totals_; }
+
+    private:
+        void update() const {
+            if (!dirty_) return;
+            dirty_ = false;
+
+            double mean = 0.0;
+            for (int pc = 0; pc < 12; ++pc) mean += static_cast<double>(totals_[pc]);
+            if (mean == 0.0) return;
+            mean /= 12.0;
+
+            double centered[12], norm = 0.0;
+            for (int pc = 0; pc < 12; ++pc) {
+                centered[pc] = static_cast<double>(totals_[pc]) - mean;
+                norm += centered[pc] * centered[pc];
+            }
+            if (norm == 0.0) return;    // Flat histogram (e.g. a chromatic cluster): no preference
+
+            // Keys in order C..B major, then C..B minor, so ties keep the simplest reading
+            const Profiles& profiles = key_profiles();
+            double best = -2.0;
+            size_t best_key = 0;
+            for (size_t k = 0; k < 24; ++k) {
+                double dot = 0.0;
+                for (int pc = 0; pc < 12; ++pc) dot += centered[pc] * profiles.rotated[k][pc];
+                if (dot > best) {
+                    best = dot;
+                    best_key = k;
+                }
+            }
+            key_ = {static_cast<uint8_t>(best_key % 12), best_key < 12 ? KeyMode::Major : KeyMode::Minor};
+            correlation_ = best / std::sqrt(norm);
+        }
+
+        // Mean-centered profiles of the 24 keys scaled to unit norm, indexed by pitch class
+        struct Profiles {
+            double rotated[24][12];
+        };
+
+        static const Profiles& key_profiles() {
+            static const Profiles profiles = [] {
+                Profiles p = {};
+                const double* source[2] = {KEY_PROFILE_MAJOR, KEY_PROFILE_MINOR};
+                for (int mode = 0; mode < 2; ++mode) {
+                    double mean = 0.0, norm = 0.0;
+                    for (int pc = 0; pc < 12; ++pc) mean += source[mode][pc] / 12.0;
+                    for (int pc = 0; pc < 12; ++pc) norm += (source[mode][pc] - mean) * (source[mode][pc] - mean);
+                    double scale = 1.0 / std::sqrt(norm);
+                    for (int tonic = 0; tonic < 12; ++tonic) {
+                        for (int pc = 0; pc < 12; ++pc) {
+                            p.rotated[mode * 12 + tonic][pc] = (source[mode][(pc - tonic + 12) % 12] - mean) * scale;
+                        }
+                    }
+                }
+                return p;
+            }();
+            return profiles;
+        }
+
+        KeyOptions options_;
+        uint32_t bucket_ticks_;
+        uint64_t buckets_[MAX_BUCKETS][12];     // Note-ticks per pitch class, one ring slot per bucket
+        uint64_t totals_[12];                   // Sum of the buckets: the window histogram
+        bool started_;
+        uint64_t now_;                          // Ticks credited so far
+        mutable bool dirty_;
+        mutable Key key_;
+        mutable double correlation_;
+    };
+
+    // ChordTracker and KeyEstimator over one note state: chords are spelled in the detected key
+    class ChordKeyTracker {
+    public:
+        explicit ChordKeyTracker(bool use_slash = false, const KeyOptions& options = KeyOptions())
+            : chords_(use_slash), keys_(options) {}
+
+        // The dictionary must outlive the tracker
+        ChordKeyTracker(const ChordDictionary& dictionary, bool use_slash = false, const KeyOptions& options = KeyOptions())
+            : chords_(dictionary, use_slash), keys_(options), dictionary_(&dictionary) {}
+
+        // Returns true if the current chord changed
+        bool apply(const NoteEvent& event) {
+            keys_.advance(event.tick, chords_);
+            return chords_.apply(event);
+        }
+
+        void reset() {
+            chords_.reset();
+            keys_.reset();
+        }
+
+        const PackedChordResult& current() const { return chords_.current(); }
+        const Key& key() const { return keys_.key(); }
+        bool use_flats() const { return keys_.use_flats(); }
+
+        // Current chord name spelled for the detected key
+        std::string_view chord_name(char* buf, size_t cap) const {
+            if (dictionary_) return format_chord(chords_.current(), *dictionary_, buf, cap, use_flats());
+            return format_chord(chords_.current(), buf, cap, use_flats());
+        }
+
+        const ChordTracker& chords() const { return chords_; }
+        const KeyEstimator& keys() const { return keys_; }
+
+    private:
+        ChordTracker chords_;
+        KeyEstimator keys_;
+        const ChordDictionary* dictionary_ = nullptr;
+    };
+}
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "chord_detector.h"
+
+#include <climits>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Streaming Standard MIDI File reader that segments notes into chord frames
+ * Walks all tracks in tick order without materializing the file: memory is
+ * O(tracks + active notes), whether the input is a caller-owned buffer
+ * (e.g. an mmap'ed file) or a path read in small chunks.
+ *
+ * Usage:
+ *   ChordDetector::MidiChordReader reader("song.mid", true);   // use_slash
+ *   ChordDetector::ChordChange change;
+ *   while (reader.next(change)) { ... change.tick, change.chord ... }
+ *   if (!reader.ok()) std::puts(reader.error());
+ */
+
+namespace ChordDetector {
+    // Chord in effect from tick onwards
+    struct ChordChange {
+        uint64_t tick;
+        PackedChordResult chord;
+    };
+
+    // Channel 10 (index 9) is General MIDI percussion and is skipped by default
+    constexpr uint16_t MIDI_PITCHED_CHANNELS = 0xFFFF & ~(1 << 9);
+
+    class MidiChordReader {
+    public:
+        // Bytes per track cursor when reading from a file
+        static constexpr size_t CHUNK_SIZE = 512;
+
+        // Read from a caller-owned buffer that outlives the reader
+        MidiChordReader(const uint8_t* data, size_t size, bool use_slash = false,
+                        uint16_t channel_mask = MIDI_PITCHED_CHANNELS)
+            : data_(data), size_(size), tracker_(use_slash), channel_mask_(channel_mask) {
+            open();
+        }
+
+        // Read from a file in CHUNK_SIZE pieces per track
+        explicit MidiChordReader(const char* path, bool use_slash = false,
+                                 uint16_t channel_mask = MIDI_PITCHED_CHANNELS)
+            : tracker_(use_slash), channel_mask_(channel_mask) {
+            file_ = std::fopen(path, "rb");
+            if (!file_) {
+                fail("cannot open file");
+                return;
+            }
+            if (std::fseek(file_, 0, SEEK_END) == 0) {
+                long end = std::ftell(file_);
+                size_ = end > 0 ? static_cast<size_t>(end) : 0;
+            }
+            open();
+        }
+
+        ~MidiChordReader() {
+            if (file_) std::fclose(file_);
+        }
+
+        MidiChordReader(const MidiChordReader&) = delete;
+        MidiChordReader& operator=(const MidiChordReader&) = delete;
+
+        bool ok() const { return error_ == nullptr; }
+        const char* error() const { return error_ ? error_ : ""; }
+
+        uint16_t format() const { return format_; }
+        uint16_t track_count() const { return static_cast<uint16_t>(tracks_.size()); }
+        uint16_t division() const { return division_; }     // Ticks per quarter note (or SMPTE code)
+        uint32_t tempo() const { return tempo_; }           // Microseconds per quarter of the last Set Tempo read
+
+        // Next chord change, emitted once all events sharing a tick are applied.
+        // Returns false at the end of the file or on error.
+        bool next(ChordChange& change) {
+            uint64_t tick;
+            while (step(tick)) {
+                const PackedChordResult& chord = tracker_.current();
+                if (!emitted_any_ || !same_chord(chord, last_chord_)) {
+                    emitted_any_ = true;
+                    last_chord_ = chord;
+                    change = {tick, chord};
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Pitch-class frames at each tick where the held set or bass changed, ready for analyze_chords_batch.
+        // Returns the number of frames written; 0 at the end of the file or on error.
+        // Use either next() or read_frames() on one reader, not both.
+        size_t read_frames(uint64_t* ticks, uint16_t* pc_masks, uint8_t* bass_pcs, size_t capacity) {
+            size_t count = 0;
+            uint64_t tick;
+            while (count < capacity && step(tick)) {
+                uint16_t mask = tracker_.pitch_class_mask();
+                int bass = tracker_.bass_note();
+                uint8_t bass_pc = bass < 0 ? NO_PITCH_CLASS : static_cast<uint8_t>(bass % 12);
+                if (emitted_any_ && mask == last_mask_ && bass_pc == last_bass_) continue;
+
+                emitted_any_ = true;
+                last_mask_ = mask;
+                last_bass_ = bass_pc;
+                ticks[count] = tick;
+                pc_masks[count] = mask;
+                bass_pcs[count] = bass_pc;
+                ++count;
+            }
+            return count;
+        }
+
+        // Next raw note event in tick order (ties in track order), without chord tracking.
+        // Ticks are truncated to 32 bits. Use either next_event() or next()/read_frames() on one reader.
+        bool next_event(NoteEvent& event) {
+            TrackCursor* earliest = nullptr;
+            for (TrackCursor& track : tracks_) {
+                if (!track.done && (!earliest || track.tick < earliest->tick)) earliest = &track;
+            }
+            if (!earliest) return false;
+
+            event = {static_cast<uint32_t>(earliest->tick), earliest->note, earliest->channel, earliest->on};
+            advance(*earliest);
+            return true;
+        }
+
+    private:
+        struct TrackCursor {
+            size_t pos;                 // Next byte to read (absolute file offset)
+            size_t end;                 // End of the track chunk
+            uint64_t tick;              // Absolute tick of the pending event
+            uint8_t running_status;
+            uint8_t note;               // Pending note event
+            uint8_t channel;
+            uint8_t on;
+            bool done;
+            size_t buffer_pos;          // File mode: absolute offset of buffer[0]
+            size_t buffer_len;
+            uint8_t buffer[CHUNK_SIZE];
+        };
+
+        void fail(const char* message) {
+            if (!error_) error_ = message;
+            for (TrackCursor& track : tracks_) track.done = true;
+        }
+
+        // Read bytes at an absolute offset outside of any track (chunk headers)
+        bool read_at(size_t pos, uint8_t* out, size_t count) {
+            if (pos + count > size_) return false;
+            if (data_) {
+                std::memcpy(out, data_ + pos, count);
+                return true;
+            }
+            return pos <= static_cast<size_t>(LONG_MAX) && std::fseek(file_, static_cast<long>(pos), SEEK_SET) == 0 &&
+                   std::fread(out, 1, count, file_) == count;
+        }
+
+        static uint32_t read_be(const uint8_t* bytes, int count) {
+            uint32_t value = 0;
+            for (int i = 0; i < count; ++i) value = (value << 8) | bytes[i];
+            return value;
+        }
+
+        void open() {
+            uint8_t header[14];
+            if (!read_at(0, header, sizeof(header)) || std::memcmp(header, "MThd", 4) != 0 || read_be(header + 4, 4) < 6) {
+                fail("not a Standard MIDI File");
+                return;
+            }
+            format_ = static_cast<uint16_t>(read_be(header + 8, 2));
+            uint16_t declared_tracks = static_cast<uint16_t>(read_be(header + 10, 2));
+            division_ = static_cast<uint16_t>(read_be(header + 12, 2));
+
+            // Locate track chunks by walking chunk headers only
+            size_t pos = 8 + read_be(header + 4, 4);
+            // Every track chunk takes at least 8 header bytes, so a bogus count cannot reserve past the file
+            tracks_.reserve(declared_tracks < size_ / 8 ? declared_tracks : size_ / 8);
+            while (tracks_.size() < declared_tracks) {
+                uint8_t chunk[8];
+                if (!read_at(pos, chunk, sizeof(chunk))) break;
+                size_t length = read_be(chunk + 4, 4);
+                size_t body = pos + 8;
+                if (std::memcmp(chunk, "MTrk", 4) == 0) {
+                    tracks_.emplace_back();
+                    TrackCursor& track = tracks_.back();
+                    track.pos = body;
+                    track.end = body + length < size_ ? body + length : size_;
+                    track.tick = 0;
+                    track.running_status = 0;
+                    track.done = false;
+                    track.buffer_pos = track.buffer_len = 0;
+                }
+                pos = body + length;
+            }
+            if (tracks_.size() < declared_tracks) {
+                fail("truncated file");
+                return;
+            }
+
+            for (TrackCursor& track : tracks_) advance(track);
+        }
+
+        bool read_byte(TrackCursor& track, uint8_t& value) {
+            if (track.pos >= track.end) return false;
+            if (data_) {
+                value = data_[track.pos++];
+                return true;
+            }
+            if (track.pos < track.buffer_pos || track.pos >= track.buffer_pos + track.buffer_len) {
+                size_t length = track.end - track.pos < CHUNK_SIZE ? track.end - track.pos : CHUNK_SIZE;
+                if (track.pos > static_cast<size_t>(LONG_MAX)) {
+                    fail("file offset out of range");
+                    return false;
+                }
+                if (std::fseek(file_, static_cast<long>(track.pos), SEEK_SET) != 0 ||
+                    std::fread(track.buffer, 1, length, file_) != length) {
+                    fail("read error");
+                    return false;
+                }
+                track.buffer_pos = track.pos;
+                track.buffer_len = length;
+            }
+            value = track.buffer[track.pos++ - track.buffer_pos];
+            return true;
+        }
+
+        bool read_varlen(TrackCursor& track, uint32_t& value) {
+            value = 0;
+            for (int i = 0; i < 4; ++i) {
+                uint8_t byte;
+                if (!read_byte(track, byte)) return false;
+                value = (value << 7) | (byte & 0x7F);
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+
+        bool skip(TrackCursor& track, uint32_t count) {
+            if (count > track.end - track.pos) return false;
+            track.pos += count;
+            return true;
+        }
+
+        // Move the cursor to its next note event on an included channel
+        void advance(TrackCursor& track) {
+            for (;;) {
+                uint32_t delta;
+                uint8_t status;
+                if (track.done || !read_varlen(track, delta) || !read_byte(track, status)) {
+                    track.done = true;
+                    return;
+                }
+                track.tick += delta;
+
+                if (status == 0xFF) {
+                    // Meta event: type, length, data; like sysex, it cancels running status
+                    track.running_status = 0;
+                    uint8_t type;
+                    uint32_t length;
+                    if (!read_byte(track, type) || !read_varlen(track, length) || type == 0x2F) {
+                        track.done = true;
+                        return;
+                    }
+                    uint8_t tempo[3];
+                    if (type == 0x51 && length == 3) {
+                        if (!read_byte(track, tempo[0]) || !read_byte(track, tempo[1]) || !read_byte(track, tempo[2])) {
+                            track.done = true;
+                            return;
+                        }
+                        tempo_ = read_be(tempo, 3);
+                    } else if (!skip(track, length)) {
+                        track.done = true;
+                        return;
+                    }
+                    continue;
+                }
+                if (status == 0xF0 || status == 0xF7) {
+                    track.running_status = 0;
+                    uint32_t length;
+                    if (!read_varlen(track, length) || !skip(track, length)) {
+                        track.done = true;
+                        return;
+                    }
+                    continue;
+                }
+
+                uint8_t data1;
+                if (status & 0x80) {
+                    track.running_status = status;
+                    if (!read_byte(track, data1)) {
+                        track.done = true;
+                        return;
+                    }
+                } else if (track.running_status) {
+                    data1 = status;
+                    status = track.running_status;
+                } else {
+                    fail("data byte without running status");
+                    return;
+                }
+
+                uint8_t kind = status & 0xF0;
+                uint8_t data2 = 0;
+                if (kind != 0xC0 && kind != 0xD0 && !read_byte(track, data2)) {
+                    track.done = true;
+                    return;
+                }
+                if ((kind != 0x80 && kind != 0x90) || !(channel_mask_ & (1 << (status & 0x0F)))) continue;
+
+                track.note = data1 & 0x7F;
+                track.channel = status & 0x0F;
+                track.on = kind == 0x90 && data2 > 0;  // Note-on with velocity 0 is a note-off
+                return;
+            }
+        }
+
+        // Apply every note event of the earliest pending tick; false when all tracks are exhausted
+        bool step(uint64_t& tick) {
+            TrackCursor* earliest = nullptr;
+            for (TrackCursor& track : tracks_) {
+                if (!track.done && (!earliest || track.tick < earliest->tick)) earliest = &track;
+            }
+            if (!earliest) return false;
+
+            tick = earliest->tick;
+            for (TrackCursor& track : tracks_) {
+                while (!track.done && track.tick == tick) {
+                    if (track.on) {
+                        tracker_.note_on(track.note);
+                    } else {
+                        tracker_.note_off(track.note);
+                    }
+                    advance(track);
+                }
+            }
+            return true;
+        }
+
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        std::FILE* file_ = nullptr;
+        const char* error_ = nullptr;
+
+        uint16_t format_ = 0;
+        uint16_t division_ = 0;
+        uint32_t tempo_ = 500000;       // 120 BPM until a Set Tempo meta event is read
+        std::vector<TrackCursor> tracks_;
+
+        ChordTracker tracker_;
+        uint16_t channel_mask_;
+        bool emitted_any_ = false;
+        PackedChordResult last_chord_ = {NO_PITCH_CLASS, NO_PITCH_CLASS, PATTERN_NONE, 0};
+        uint16_t last_mask_ = 0;
+        uint8_t last_bass_ = NO_PITCH_CLASS;
+    };
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "chord_detector.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Multithreaded corpus analysis on top of chord_detector.h (optional component)
+ * Shards note-event streams or pre-segmented chord frames across a persistent
+ * work-stealing pool and writes results into caller-preallocated arrays.
+ * Detection tables are built once before the workers start and shared read-only.
+ *
+ * Usage:
+ *   ChordDetector::ParallelAnalyzer analyzer(8);
+ *   analyzer.analyze(streams.data(), streams.size(), true);   // use_slash
+ *   ChordDetector::ParallelStats stats = analyzer.stats();
+ */
+
+namespace ChordDetector {
+    // Already-segmented chord frames (structure-of-arrays); out must hold count results
+    struct FrameStream {
+        const uint16_t* pc_masks;
+        const uint8_t* bass_pcs;
+        size_t count;
+        PackedChordResult* out;
+    };
+
+    // Note events of one stream (e.g. one MIDI file); out[i] is the chord after events[i] is applied
+    struct NoteEventStream {
+        const NoteEvent* events;
+        size_t count;
+        PackedChordResult* out;
+    };
+
+    // Throughput counters, accumulated over all analyze() calls since construction or reset_stats()
+    struct ParallelStats {
+        uint64_t tasks;         // Work items executed
+        uint64_t frames;        // Chord frames analyzed
+        uint64_t events;        // Note events applied
+        uint64_t steals;        // Work items taken from another worker's queue
+        double seconds;         // Wall time spent inside analyze()
+
+        double items_per_second() const {
+            return seconds > 0.0 ? static_cast<double>(frames + events) / seconds : 0.0;
+        }
+    };
+
+    class ParallelAnalyzer {
+    public:
+        // Frame streams are split into chunks of this many frames; note-event streams stay whole
+        static constexpr size_t FRAME_CHUNK = 4096;
+
+        // threads = 0 uses std::thread::hardware_concurrency(); the dictionary must outlive the analyzer
+        explicit ParallelAnalyzer(unsigned threads = 0, const ChordDictionary* dictionary = nullptr)
+            : table_(!dictionary ? &lookup_table() : dictionary->tabulated() ? &dictionary->table() : nullptr),
+              dictionary_(dictionary) {
+            if (threads == 0) threads = std::thread::hardware_concurrency();
+            if (threads == 0) threads = 1;
+
+            queues_ = std::vector<WorkerQueue>(threads);
+            workers_.reserve(threads);
+            for (unsigned w = 0; w < threads; ++w) {
+                workers_.emplace_back([this, w] { worker_loop(w); });
+            }
+        }
+
+        ~ParallelAnalyzer() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            start_.notify_all();
+            for (std::thread& worker : workers_) worker.join();
+        }
+
+        ParallelAnalyzer(const ParallelAnalyzer&) = delete;
+        ParallelAnalyzer& operator=(const ParallelAnalyzer&) = delete;
+
+        unsigned thread_count() const { return static_cast<unsigned>(workers_.size()); }
+
+        // Blocks until every stream's out array is filled
+        void analyze(const FrameStream* streams, size_t count, bool use_slash = false) {
+            tasks_.clear();
+            for (size_t s = 0; s < count; ++s) {
+                for (size_t begin = 0; begin < streams[s].count; begin += FRAME_CHUNK) {
+                    size_t end = streams[s].count - begin < FRAME_CHUNK ? streams[s].count : begin + FRAME_CHUNK;
+                    tasks_.push_back({s, begin, end});
+                }
+            }
+            frame_streams_ = streams;
+            event_streams_ = nullptr;
+            run(use_slash);
+        }
+
+        // Blocks until every stream's out array is filled
+        void analyze(const NoteEventStream* streams, size_t count, bool use_slash = false) {
+            tasks_.clear();
+            for (size_t s = 0; s < count; ++s) tasks_.push_back({s, 0, streams[s].count});
+            frame_streams_ = nullptr;
+            event_streams_ = streams;
+            run(use_slash);
+        }
+
+        ParallelStats stats() const {
+            ParallelStats total = {0, 0, 0, 0, seconds_};
+            for (const WorkerQueue& queue : queues_) {
+                total.tasks += queue.tasks;
+                total.frames += queue.frames;
+                total.events += queue.events;
+                total.steals += queue.steals;
+            }
+            return total;
+        }
+
+        void reset_stats() {
+            for (WorkerQueue& queue : queues_) queue.tasks = queue.frames = queue.events = queue.steals = 0;
+            seconds_ = 0.0;
+        }
+
+    private:
+        struct Task {
+            size_t stream;
+            size_t begin;
+            size_t end;
+        };
+
+        // One cache line per worker so claiming tasks and counting never share lines
+        struct alignas(64) WorkerQueue {
+            std::atomic<size_t> next{0};    // Next unclaimed task index; owner and thieves both claim here
+            size_t end = 0;                 // One past the worker's last task
+            uint64_t tasks = 0;             // Counters below are written by the owning worker only
+            uint64_t frames = 0;
+            uint64_t events = 0;
+            uint64_t steals = 0;
+        };
+
+        void run(bool use_slash) {
+            auto start_time = std::chrono::steady_clock::now();
+
+            // Contiguous share per worker; stealing evens out uneven stream sizes
+            size_t workers = queues_.size();
+            size_t per_worker = tasks_.size() / workers;
+            size_t remainder = tasks_.size() % workers;
+            size_t begin = 0;
+            for (size_t w = 0; w < workers; ++w) {
+                size_t share = per_worker + (w < remainder ? 1 : 0);
+                queues_[w].next.store(begin, std::memory_order_relaxed);
+                queues_[w].end = begin + share;
+                begin += share;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                use_slash_ = use_slash;
+                active_ = workers;
+                ++generation_;
+                start_.notify_all();
+                done_.wait(lock, [this] { return active_ == 0; });
+            }
+
+            seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        }
+
+        void worker_loop(unsigned w) {
+            uint64_t seen = 0;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                    if (stop_) return;
+                    seen = generation_;
+                }
+
+                drain(w);
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--active_ == 0) done_.notify_one();
+            }
+        }
+
+        // Own queue first, then steal from the others in ring order
+        void drain(unsigned w) {
+            WorkerQueue& own = queues_[w];
+            size_t workers = queues_.size();
+            for (size_t offset = 0; offset < workers; ++offset) {
+                WorkerQueue& victim = queues_[(w + offset) % workers];
+                for (;;) {
+                    size_t index = victim.next.fetch_add(1, std::memory_order_relaxed);
+                    if (index >= victim.end) break;
+                    if (offset != 0) ++own.steals;
+                    execute(own, tasks_[index]);
+                }
+            }
+        }
+
+        void execute(WorkerQueue& own, const Task& task) {
+            ++own.tasks;
+            if (frame_streams_) {
+                const FrameStream& stream = frame_streams_[task.stream];
+                if (table_) {
+                    lookup_chords(*table_, stream.pc_masks + task.begin, stream.bass_pcs + task.begin,
+                                  task.end - task.begin, stream.out + task.begin, use_slash_);
+                } else {
+                    analyze_chords_batch(*dictionary_, stream.pc_masks + task.begin, stream.bass_pcs + task.begin,
+                                         task.end - task.begin, stream.out + task.begin, use_slash_);
+                }
+                own.frames += task.end - task.begin;
+            } else {
+                const NoteEventStream& stream = event_streams_[task.stream];
+                ChordTracker tracker = table_ ? ChordTracker(*table_, use_slash_) : ChordTracker(*dictionary_, use_slash_);
+                for (size_t i = 0; i < stream.count; ++i) {
+                    tracker.apply(stream.events[i]);
+                    stream.out[i] = tracker.current();
+                }
+                own.events += stream.count;
+            }
+        }
+
+        const LookupTable* table_;                  // Null for an untabulated dictionary
+        const ChordDictionary* dictionary_;
+        std::vector<WorkerQueue> queues_;
+        std::vector<std::thread> workers_;
+        std::vector<Task> tasks_;
+        const FrameStream* frame_streams_ = nullptr;
+        const NoteEventStream* event_streams_ = nullptr;
+        bool use_slash_ = false;
+        double seconds_ = 0.0;
+
+        std::mutex mutex_;
+        std::condition_variable start_;
+        std::condition_variable done_;
+        uint64_t generation_ = 0;
+        size_t active_ = 0;
+        bool stop_ = false;
+    };
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "chord_detector.h"
+
+/**
+ * Progression analysis over a stream of chord results and the voicings they came from
+ * Per step: intervals from the root, inversion, roman numeral in a key, root motion and the
+ * minimum voice-leading movement from the previous voicing. Steps are computed one at a time
+ * into caller-owned ProgressionStep structs; only the previous voicing is kept, so a piece of
+ * any length is analyzed in linear time and constant memory.
+ *
+ * Usage:
+ *   ChordDetector::ProgressionAnalyzer progression({7, ChordDetector::KeyMode::Major});   // G major
+ *   ChordDetector::ProgressionStep step;
+ *   for each chord:
+ *       progression.push(analyze_chord_fast(notes, count, true), notes, count, step);
+ *       // step.roman ("V7", "ii6", "bVII"), step.root_motion, step.voice_leading, ...
+ */
+
+namespace ChordDetector {
+    enum class KeyMode : uint8_t {
+        Major,
+        Minor                   // Natural minor degrees; raised 6th/7th are written #VI / #VII
+    };
+
+    struct Key {
+        uint8_t tonic_pc;       // 0-11
+        KeyMode mode;
+    };
+
+    // Fits every numeral produced, e.g. "#viiø65"
+    constexpr size_t ROMAN_CAPACITY = 12;
+
+    // Notes of a voicing kept for voice leading; higher notes beyond this are ignored
+    constexpr size_t MAX_VOICES = 16;
+
+    struct ProgressionStep {
+        PackedChordResult chord;
+        Inversion inversion;            // From the actual bass, also for chords not written as slash
+        uint8_t interval_count;         // Pitch classes of the voicing if a chord matched, otherwise 0
+        uint8_t intervals_from_root[12];    // Ascending from the root
+        uint16_t interval_mask;         // Same intervals as a bitmask (bit N = N semitones above the root)
+        int8_t root_motion;             // Ascending semitones (0-11) from the previous root, -1 if either is unmatched
+        int32_t voice_leading;          // Minimum total semitones moved from the previous voicing, -1 on the first
+                                        // step or when either voicing is empty
+        char roman[ROMAN_CAPACITY];     // NUL-terminated numeral in the key, "" if unmatched
+    };
+
+    // Pitch-class degrees in the key's mode, written relative to the tonic
+    inline constexpr const char* ROMAN_MAJOR[12] = {"I", "bII", "II", "bIII", "III", "IV", "#IV", "V", "bVI", "VI", "bVII", "VII"};
+    inline constexpr const char* ROMAN_MINOR[12] = {"I", "bII", "II", "III", "#III", "IV", "#IV", "V", "VI", "#VI", "VII", "#VII"};
+
+    // Roman numeral of a chord in a key from the pattern's intervals: lowercase for minor thirds, o / ø / +
+    // for diminished / half-diminished / augmented, M for a major seventh over a major third, and figured-bass
+    // inversion figures (6, 64; 7, 65, 43, 42). Writes "" if unmatched; returns the length written.
+    inline size_t roman_numeral(const PatternSet& set, const PackedChordResult& chord, const Key& key,
+                                char* buf, size_t cap) {
+        if (cap == 0) return 0;
+        buf[0] = '\0';
+        if (!(chord.flags & CHORD_FLAG_MATCHED) || chord.pattern_id >= set.count) return 0;
+
+        uint16_t mask = set.patterns[chord.pattern_id].mask;
+        bool minor_third = (mask & (1 << 3)) && !(mask & (1 << 4));
+        bool major_third = (mask & (1 << 4)) != 0;
+        bool fifth = (mask & (1 << 7)) != 0;
+        bool diminished = minor_third && (mask & (1 << 6)) && !fifth;
+        bool augmented = major_third && (mask & (1 << 8)) && !fifth;
+        bool seventh = (mask & ((1 << 10) | (1 << 11))) || (diminished && (mask & (1 << 9)));
+
+        char text[ROMAN_CAPACITY + 8];
+        size_t length = 0;
+        const char* numeral = (key.mode == KeyMode::Minor ? ROMAN_MINOR : ROMAN_MAJOR)[(chord.root_pc - key.tonic_pc + 12) % 12];
+        for (; *numeral; ++numeral) {
+            char c = *numeral;
+            text[length++] = minor_third && c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        const char* quality = "";
+        if (diminished) quality = (mask & (1 << 10)) ? "\xC3\xB8" : "o";     // ø (UTF-8) for m7b5
+        else if (augmented) quality = "+";
+        else if (major_third && (mask & (1 << 11))) quality = "M";
+        for (; *quality; ++quality) text[length++] = *quality;
+
+        static constexpr const char* TRIAD_FIGURES[] = {"", "6", "64", "", ""};
+        static constexpr const char* SEVENTH_FIGURES[] = {"7", "65", "43", "42", "7"};
+        Inversion inversion = inversion_from_interval(chord.bass_pc - chord.root_pc);
+        const char* figure = (seventh ? SEVENTH_FIGURES : TRIAD_FIGURES)[static_cast<size_t>(inversion)];
+        for (; *figure; ++figure) text[length++] = *figure;
+
+        if (length > cap - 1) length = cap - 1;
+        std::memcpy(buf, text, length);
+        buf[length] = '\0';
+        return length;
+    }
+
+    inline size_t roman_numeral(const PackedChordResult& chord, const Key& key, char* buf, size_t cap) {
+        return roman_numeral(BUILTIN_PATTERNS, chord, key, buf, cap);
+    }
+
+    // Minimum total movement between two ascending voicings without crossing voices; a voice may split
+    // into or merge from several (every note of each voicing is connected). O(a_count * b_count).
+    inline int32_t voice_leading_distance(const uint8_t* a, size_t a_count, const uint8_t* b, size_t b_count) {
+        if (a_count == 0 || b_count == 0) return -1;
+
+        // cost[j]: best alignment of a[0..i] with b[0..j], one row at a time
+        int32_t cost[MAX_VOICES];
+        auto distance = [](int x, int y) { return x > y ? x - y : y - x; };
+        for (size_t j = 0; j < b_count; ++j) cost[j] = distance(a[0], b[j]) + (j > 0 ? cost[j - 1] : 0);
+        for (size_t i = 1; i < a_count; ++i) {
+            int32_t diagonal = cost[0];
+            cost[0] += distance(a[i], b[0]);
+            for (size_t j = 1; j < b_count; ++j) {
+                int32_t best = diagonal < cost[j] ? diagonal : cost[j];
+                if (cost[j - 1] < best) best = cost[j - 1];
+                diagonal = cost[j];
+                cost[j] = best + distance(a[i], b[j]);
+            }
+        }
+        return cost[b_count - 1];
+    }
+
+    class ProgressionAnalyzer {
+    public:
+        // The dictionary (if any) must outlive the analyzer; its pattern ids are used for qualities
+        explicit ProgressionAnalyzer(const Key& key = {0, KeyMode::Major}, const ChordDictionary* dictionary = nullptr)
+            : set_(dictionary ? dictionary->pattern_set() : BUILTIN_PATTERNS), key_(key) {
+            reset();
+        }
+
+        const Key& key() const { return key_; }
+
+        // Takes effect from the next step (e.g. when a key estimator detects a modulation)
+        void set_key(const Key& key) { key_ = key; }
+
+        // Forget the previous chord and voicing; the key is kept
+        void reset() {
+            previous_count_ = 0;
+            previous_root_ = NO_PITCH_CLASS;
+        }
+
+        // One step: a chord (e.g. from analyze_chord_fast) and the MIDI notes it was detected from
+        void push(const PackedChordResult& chord, const int* midi_notes, int note_count, ProgressionStep& out) {
+            uint8_t voicing[MAX_VOICES];
+            size_t voice_count = sorted_voicing(midi_notes, note_count, voicing);
+            bool matched = (chord.flags & CHORD_FLAG_MATCHED) != 0;
+
+            out.chord = chord;
+            out.inversion = matched ? inversion_from_interval(chord.bass_pc - chord.root_pc) : Inversion::Root;
+            out.interval_mask = 0;
+            out.interval_count = 0;
+            if (matched) {
+                int bass_pitch_class;
+                out.interval_mask = rotate_mask(pitch_class_mask(midi_notes, note_count, bass_pitch_class), chord.root_pc);
+                for (int interval = 0; interval < 12; ++interval) {
+                    if (out.interval_mask & (1 << interval)) out.intervals_from_root[out.interval_count++] = static_cast<uint8_t>(interval);
+                }
+            }
+            out.root_motion = matched && previous_root_ != NO_PITCH_CLASS
+                ? static_cast<int8_t>((chord.root_pc - previous_root_ + 12) % 12) : -1;
+            out.voice_leading = voice_leading_distance(previous_, previous_count_, voicing, voice_count);
+            roman_numeral(set_, chord, key_, out.roman, sizeof(out.roman));
+
+            previous_root_ = matched ? chord.root_pc : NO_PITCH_CLASS;
+            previous_count_ = voice_count;
+            std::memcpy(previous_, voicing, voice_count);
+        }
+
+        void push(const PackedChordResult& chord, std::initializer_list<int> midi_notes, ProgressionStep& out) {
+            push(chord, midi_notes.begin(), static_cast<int>(midi_notes.size()), out);
+        }
+
+        // chord_count steps from a flat note buffer (the analyze_chords_batch layout: chord i is
+        // notes[offsets[i]] .. notes[offsets[i + 1] - 1]), continuing from the previous push
+        void push(const PackedChordResult* chords, const int* notes, const size_t* offsets, size_t chord_count,
+                  ProgressionStep* out) {
+            for (size_t i = 0; i < chord_count; ++i) {
+                push(chords[i], notes + offsets[i], static_cast<int>(offsets[i + 1] - offsets[i]), out[i]);
+            }
+        }
+
+    private:
+        // Distinct valid notes, ascending, at most MAX_VOICES
+        static size_t sorted_voicing(const int* midi_notes, int note_count, uint8_t* out) {
+            uint64_t held[2] = {0, 0};
+            for (int i = 0; i < note_count; ++i) {
+                int midi = midi_notes[i];
+                if (midi >= 0 && midi <= 127) held[midi >> 6] |= uint64_t(1) << (midi & 63);
+            }
+            size_t count = 0;
+            for (int word = 0; word < 2; ++word) {
+                for (uint64_t bits = held[word]; bits && count < MAX_VOICES; bits &= bits - 1) {
+                    out[count++] = static_cast<uint8_t>(word * 64 + lowest_bit(bits));
+                }
+            }
+            return count;
+        }
+
+        PatternSet set_;
+        Key key_;
+        uint8_t previous_[MAX_VOICES];
+        size_t previous_count_;
+        uint8_t previous_root_;
+    };
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "chord_detector.h"
+
+/**
+ * Online chord sequence decoder (fixed-lag Viterbi) over per-frame candidate scores
+ * Smooths frame-by-frame readings (C <-> C/E <-> Cadd9 while a voicing passes through)
+ * into stable chord segments. Each frame's candidates come from the top-K API
+ * (analyze_chord_candidates) or the chroma front end (analyze_candidates); a frame is
+ * committed once `lag` later frames have been seen.
+ *
+ * Memory is fixed (MAX_STATES tracked chords x MAX_LAG frames of back-pointers) and a
+ * frame costs O(states + lag): with one penalty for every chord change the best
+ * predecessor of each state is either itself or the previous frame's overall best.
+ *
+ * Usage:
+ *   ChordDetector::ChordSequenceDecoder decoder;
+ *   ChordDetector::ChordSegment segment;
+ *   for each frame:
+ *       if (decoder.push(scored, count, segment)) { ... segment.start_frame, segment.chord ... }
+ *   while (decoder.flush(segment)) { ... }
+ */
+
+namespace ChordDetector {
+    struct SequenceOptions {
+        size_t lag = 8;                 // Frames of look-ahead before a frame is committed (at most MAX_LAG)
+        float change_penalty = 0.5f;    // Score cost of a chord change between consecutive frames
+        float absent_score = 0.0f;      // Score of a tracked chord in a frame that does not list it
+        float no_chord_score = 0.5f;    // Score of "no chord" in a frame without candidates
+    };
+
+    // Chord in effect from start_frame until the next segment
+    struct ChordSegment {
+        uint64_t start_frame;
+        PackedChordResult chord;
+    };
+
+    // Candidates of the top-K API as decoder input: priority * scale, slash readings kept only with use_slash.
+    // Returns the number written (at most candidates.size()); equal readings keep their best score.
+    template<size_t K>
+    size_t scored_candidates(const CandidateBuffer<K>& candidates, ScoredChord* out, bool use_slash = false,
+                             float scale = 0.01f) {
+        size_t count = 0;
+        for (const ChordCandidate& candidate : candidates) {
+            bool slash = use_slash && (candidate.flags & CHORD_FLAG_SLASH);
+            PackedChordResult chord = {candidate.root_pc, candidate.bass_pc, candidate.pattern_id,
+                                       static_cast<uint16_t>(CHORD_FLAG_MATCHED | (slash ? CHORD_FLAG_SLASH : 0))};
+            bool seen = false;
+            for (size_t i = 0; i < count && !seen; ++i) seen = same_chord(out[i].chord, chord);
+            if (!seen) out[count++] = {chord, candidate.priority * scale};  // Ranked, so the first is the best
+        }
+        return count;
+    }
+
+    class ChordSequenceDecoder {
+    public:
+        static constexpr size_t MAX_STATES = 16;   // Chords tracked at once; the weakest is replaced when full
+        static constexpr size_t MAX_LAG = 64;
+
+        explicit ChordSequenceDecoder(const SequenceOptions& options = SequenceOptions()) : options_(options) {
+            if (options_.lag > MAX_LAG) options_.lag = MAX_LAG;
+            reset();
+        }
+
+        const SequenceOptions& options() const { return options_; }
+
+        void reset() {
+            state_count_ = 0;
+            frames_ = committed_ = 0;
+            has_last_ = false;
+            last_ = NO_CHORD;
+            flushing_ = false;
+            final_best_ = 0;
+        }
+
+        // Add one frame's scored candidates (empty = no chord). Returns true and fills segment when the
+        // frame committed by this call starts a new segment.
+        bool push(const ScoredChord* candidates, size_t count, ChordSegment& segment) {
+            ScoredChord no_chord = {NO_CHORD, options_.no_chord_score};
+            if (count == 0) {
+                candidates = &no_chord;
+                count = 1;
+            }
+
+            // Best previous state; entering any other state costs change_penalty. Taken before candidates
+            // claim states, since a state replaced below loses its previous-frame score
+            size_t previous_best = 0;
+            for (size_t s = 1; s < state_count_; ++s) {
+                if (scores_[s] > scores_[previous_best]) previous_best = s;
+            }
+            float switch_score = frames_ > 0 ? scores_[previous_best] - options_.change_penalty : 0.0f;
+
+            // Emission score per tracked state; candidates claim (or create) states
+            float emission[MAX_STATES];
+            bool listed[MAX_STATES] = {};
+            for (size_t s = 0; s < MAX_STATES; ++s) emission[s] = options_.absent_score;
+            for (size_t i = 0; i < count; ++i) {
+                size_t s = find_or_add(candidates[i].chord, listed);
+                if (s == MAX_STATES) continue;      // Every state is listed by this frame already
+                emission[s] = listed[s] && emission[s] > candidates[i].score ? emission[s] : candidates[i].score;
+                listed[s] = true;
+            }
+
+            Frame& frame = history_[frames_ % RING];
+            float best = NEW_STATE;
+            for (size_t s = 0; s < state_count_; ++s) {
+                bool stay = frames_ == 0 || scores_[s] >= switch_score;
+                frame.labels[s] = labels_[s];
+                frame.back[s] = static_cast<uint8_t>(stay ? s : previous_best);
+                scores_[s] = (stay ? (frames_ == 0 ? 0.0f : scores_[s]) : switch_score) + emission[s];
+                if (scores_[s] > best) best = scores_[s];
+            }
+            // Keep scores near zero so long streams don't lose precision
+            for (size_t s = 0; s < state_count_; ++s) scores_[s] -= best;
+            ++frames_;
+
+            if (frames_ <= options_.lag) return false;
+            return commit(decode(committed_), segment);
+        }
+
+        bool push(const ScoredChord* candidates, size_t count) {
+            ChordSegment ignored;
+            return push(candidates, count, ignored);
+        }
+
+        template<size_t K>
+        bool push(const CandidateBuffer<K>& candidates, bool use_slash, ChordSegment& segment) {
+            ScoredChord scored[K > 0 ? K : 1];
+            return push(scored, scored_candidates(candidates, scored, use_slash), segment);
+        }
+
+        // End of stream: commits the frames still inside the lag window along the best final path,
+        // one segment per call; false when nothing is left. reset() before decoding another stream.
+        bool flush(ChordSegment& segment) {
+            if (!flushing_) {
+                flushing_ = true;
+                final_best_ = best_state();
+            }
+            while (committed_ < frames_) {
+                if (commit(trace(final_best_, committed_), segment)) return true;
+            }
+            return false;
+        }
+
+        uint64_t frames() const { return frames_; }
+        uint64_t committed_frames() const { return committed_; }
+
+    private:
+        static constexpr size_t RING = MAX_LAG + 1;
+        static constexpr float NEW_STATE = -1e30f;      // Score of a state with no path yet
+        static constexpr PackedChordResult NO_CHORD = {NO_PITCH_CLASS, NO_PITCH_CLASS, PATTERN_NONE, 0};
+
+        // Per-frame labels and back-pointers (slot at the previous frame) of every state
+        struct Frame {
+            PackedChordResult labels[MAX_STATES];
+            uint8_t back[MAX_STATES];
+        };
+
+        size_t find_or_add(const PackedChordResult& chord, const bool* listed) {
+            for (size_t s = 0; s < state_count_; ++s) {
+                if (same_chord(labels_[s], chord)) return s;
+            }
+
+            size_t slot = state_count_;
+            if (slot == MAX_STATES) {
+                // Replace the weakest state this frame does not list; its history stays in the ring
+                slot = MAX_STATES;
+                for (size_t s = 0; s < state_count_; ++s) {
+                    if (!listed[s] && (slot == MAX_STATES || scores_[s] < scores_[slot])) slot = s;
+                }
+                if (slot == MAX_STATES) return MAX_STATES;
+            } else {
+                ++state_count_;
+            }
+            labels_[slot] = chord;
+            scores_[slot] = NEW_STATE;
+            return slot;
+        }
+
+        size_t best_state() const {
+            size_t best = 0;
+            for (size_t s = 1; s < state_count_; ++s) {
+                if (scores_[s] > scores_[best]) best = s;
+            }
+            return best;
+        }
+
+        // Label at frame target on the path that ends in state at the newest frame
+        PackedChordResult trace(size_t state, uint64_t target) const {
+            for (uint64_t f = frames_ - 1; f > target; --f) state = history_[f % RING].back[state];
+            return history_[target % RING].labels[state];
+        }
+
+        PackedChordResult decode(uint64_t target) const {
+            return trace(best_state(), target);
+        }
+
+        bool commit(const PackedChordResult& chord, ChordSegment& segment) {
+            uint64_t frame = committed_++;
+            if (has_last_ && same_chord(chord, last_)) return false;
+            has_last_ = true;
+            last_ = chord;
+            segment = {frame, chord};
+            return true;
+        }
+
+        SequenceOptions options_;
+        Frame history_[RING];
+        PackedChordResult labels_[MAX_STATES];
+        float scores_[MAX_STATES];
+        size_t state_count_;
+        uint64_t frames_;       // Frames pushed
+        uint64_t committed_;    // Frames decided
+        bool has_last_;
+        PackedChordResult last_;
+        bool flushing_;
+        size_t final_best_;
+    };
+}
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "chord_detector.h"
+
+/**
+ * Exhaustive equivalence check of every detection engine against analyze_chord_reference
+ * Enumerates all 4096 pitch-class masks x 12 bass pitch classes x use_flats x use_slash,
+ * in two voicings each, across all cores, and reports every differing result.
+ *
+ * Usage:
+ *   chord_detector_equivalence [--threads=<n>] [--max-reports=<n>]
+ */
+
+// One chord input: mask plus bass, voiced as MIDI notes
+struct Frame {
+    int notes[16];
+    int count;
+    uint16_t pc_mask;       // Pitch classes of notes (bass included)
+    uint8_t bass_pc;
+};
+
+// Runs n frames through one engine with the given options
+struct Engine {
+    const char* name;
+    void (*run)(const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out);
+};
+
+static const ChordDictionary& builtin_dictionary() {
+    static const ChordDictionary dictionary;
+    return dictionary;
+}
+
+static const ChordDictionary& cached_dictionary() {
+    static const ChordDictionary dictionary(nullptr, 0, true, ChordDictionary::Mode::Cached);
+    return dictionary;
+}
+
+static const Engine ENGINES[] = {
+    {"analyze_chord", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        for (size_t i = 0; i < n; ++i) out[i] = analyze_chord(frames[i].notes, frames[i].count, use_flats, use_slash);
+    }},
+    {"get_chord_name", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        // Only the name is produced; the other fields are taken from the reference
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = ChordDetector::analyze_chord_reference(frames[i].notes, frames[i].count, use_flats, use_slash);
+            out[i].full_name = get_chord_name(frames[i].notes, frames[i].count, use_flats, use_slash);
+        }
+    }},
+    {"get_chord_name_view", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = ChordDetector::analyze_chord_reference(frames[i].notes, frames[i].count, use_flats, use_slash);
+            out[i].full_name = std::string(get_chord_name_view(frames[i].notes, frames[i].count, use_flats, use_slash));
+        }
+    }},
+    {"analyze_chord_fast", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = to_chord_result(analyze_chord_fast(frames[i].notes, frames[i].count, use_slash), use_flats);
+        }
+    }},
+    {"analyze_chord_realtime", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = to_chord_result(analyze_chord_realtime(frames[i].notes, frames[i].count, use_slash), use_flats);
+        }
+    }},
+    {"format_chord", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        char buf[ChordDetector::CHORD_NAME_CAPACITY];
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = ChordDetector::analyze_chord_reference(frames[i].notes, frames[i].count, use_flats, use_slash);
+            PackedChordResult chord = analyze_chord_fast(frames[i].notes, frames[i].count, use_slash);
+            out[i].full_name = std::string(format_chord(chord, buf, sizeof(buf), use_flats));
+        }
+    }},
+    {"analyze_chord_constexpr", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = to_chord_result(analyze_chord_constexpr(frames[i].notes, frames[i].count, use_slash), use_flats);
+        }
+    }},
+    {"analyze_chords_batch/masks", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        std::vector<uint16_t> masks(n);
+        std::vector<uint8_t> bass(n);
+        std::vector<PackedChordResult> packed(n);
+        for (size_t i = 0; i < n; ++i) {
+            masks[i] = frames[i].pc_mask;
+            bass[i] = frames[i].bass_pc;
+        }
+        analyze_chords_batch(masks.data(), bass.data(), n, packed.data(), use_slash);
+        for (size_t i = 0; i < n; ++i) out[i] = to_chord_result(packed[i], use_flats);
+    }},
+    {"analyze_chords_batch/notes", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        std::vector<int> notes;
+        std::vector<size_t> offsets(1, 0);
+        std::vector<PackedChordResult> packed(n);
+        for (size_t i = 0; i < n; ++i) {
+            notes.insert(notes.end(), frames[i].notes, frames[i].notes + frames[i].count);
+            offsets.push_back(notes.size());
+        }
+        analyze_chords_batch(notes.data(), offsets.data(), n, packed.data(), use_slash);
+        for (size_t i = 0; i < n; ++i) out[i] = to_chord_result(packed[i], use_flats);
+    }},
+    {"ChordTracker", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        ChordTracker tracker(use_slash);
+        for (size_t i = 0; i < n; ++i) {
+            tracker.reset();
+            for (int k = 0; k < frames[i].count; ++k) tracker.note_on(frames[i].notes[k]);
+            out[i] = to_chord_result(tracker.current(), use_flats);
+        }
+    }},
+    {"select_chord", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        CandidateBuffer<32> candidates;
+        for (size_t i = 0; i < n; ++i) {
+            analyze_chord_candidates(frames[i].notes, frames[i].count, candidates);
+            PackedChordResult chord = select_chord(candidates, use_slash);
+            // An empty buffer carries no bass; the unmatched result is the same either way
+            out[i] = to_chord_result(chord, use_flats);
+        }
+    }},
+    {"ChordDictionary", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = analyze_chord(builtin_dictionary(), frames[i].notes, frames[i].count, use_flats, use_slash);
+        }
+    }},
+    {"ChordDictionary (cached)", [](const Frame* frames, size_t n, bool use_flats, bool use_slash, ChordResult* out) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = analyze_chord(cached_dictionary(), frames[i].notes, frames[i].count, use_flats, use_slash);
+        }
+    }},
+};
+
+constexpr size_t ENGINE_COUNT = sizeof(ENGINES) / sizeof(ENGINES[0]);
+
+// Close voicing: bass in octave 3, the other pitch classes once in octave 4
+static Frame close_voicing(uint16_t mask, int bass) {
+    Frame frame = {};
+    frame.notes[frame.count++] = 48 + bass;
+    for (int pc = 0; pc < 12; ++pc) {
+        if (pc != bass && (mask & (1 << pc))) frame.notes[frame.count++] = 60 + pc;
+    }
+    frame.pc_mask = static_cast<uint16_t>(mask | (1 << bass));
+    frame.bass_pc = static_cast<uint8_t>(bass);
+    return frame;
+}
+
+// Spread voicing: doubled bass, upper notes out of order across two octaves
+static Frame spread_voicing(uint16_t mask, int bass) {
+    Frame frame = {};
+    for (int pc = 11; pc >= 0; --pc) {
+        if (pc != bass && (mask & (1 << pc))) frame.notes[frame.count++] = (pc % 2 ? 72 : 60) + pc;
+    }
+    frame.notes[frame.count++] = 48 + bass;
+    frame.notes[frame.count++] = 36 + bass;
+    frame.pc_mask = static_cast<uint16_t>(mask | (1 << bass));
+    frame.bass_pc = static_cast<uint8_t>(bass);
+    return frame;
+}
+
+static bool same_result(const ChordResult& a, const ChordResult& b) {
+    return a.full_name == b.full_name && a.chord_name == b.chord_name && a.bass_note == b.bass_note &&
+           a.is_slash_chord == b.is_slash_chord && a.root_pitch_class == b.root_pitch_class &&
+           a.bass_pitch_class == b.bass_pitch_class;
+}
+
+static std::string describe(const ChordResult& r) {
+    return "'" + r.full_name + "' (chord '" + r.chord_name + "', bass '" + r.bass_note + "', slash " +
+           (r.is_slash_chord ? "1" : "0") + ", root " + std::to_string(r.root_pitch_class) + ", bass pc " +
+           std::to_string(r.bass_pitch_class) + ")";
+}
+
+struct Report {
+    std::mutex mutex;
+    std::atomic<uint64_t> mismatches[ENGINE_COUNT];
+    std::atomic<uint64_t> cases{0};
+    std::atomic<size_t> printed{0};
+    size_t max_reports;
+
+    void mismatch(size_t engine, const Frame& frame, bool use_flats, bool use_slash,
+                  const ChordResult& expected, const ChordResult& actual) {
+        mismatches[engine].fetch_add(1, std::memory_order_relaxed);
+        if (printed.fetch_add(1, std::memory_order_relaxed) >= max_reports) return;
+
+        std::string notes;
+        for (int k = 0; k < frame.count; ++k) notes += (k ? "," : "") + std::to_string(frame.notes[k]);
+        std::lock_guard<std::mutex> lock(mutex);
+        std::printf("✗ %s mask 0x%03x bass %d flats %d slash %d notes {%s}\n    expected %s\n    got      %s\n",
+                    ENGINES[engine].name, frame.pc_mask, frame.bass_pc, use_flats, use_slash, notes.c_str(),
+                    describe(expected).c_str(), describe(actual).c_str());
+    }
+};
+
+// All bass pitch classes and voicings of one mask, in one batch per engine and option set
+static void check_mask(uint16_t mask, Report& report) {
+    Frame frames[24];
+    size_t n = 0;
+    for (int bass = 0; bass < 12; ++bass) {
+        frames[n++] = close_voicing(mask, bass);
+        frames[n++] = spread_voicing(mask, bass);
+    }
+
+    ChordResult expected[24];
+    ChordResult actual[24];
+    for (int options = 0; options < 4; ++options) {
+        bool use_flats = options & 1, use_slash = options & 2;
+        for (size_t i = 0; i < n; ++i) {
+            expected[i] = ChordDetector::analyze_chord_reference(frames[i].notes, frames[i].count, use_flats, use_slash);
+        }
+        for (size_t e = 0; e < ENGINE_COUNT; ++e) {
+            ENGINES[e].run(frames, n, use_flats, use_slash, actual);
+            for (size_t i = 0; i < n; ++i) {
+                if (!same_result(expected[i], actual[i])) {
+                    report.mismatch(e, frames[i], use_flats, use_slash, expected[i], actual[i]);
+                }
+            }
+        }
+        report.cases.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    size_t max_reports = 50;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = static_cast<unsigned>(std::atoi(argv[i] + 10));
+        } else if (std::strncmp(argv[i], "--max-reports=", 14) == 0) {
+            max_reports = static_cast<size_t>(std::atol(argv[i] + 14));
+        } else {
+            std::fprintf(stderr, "usage: %s [--threads=<n>] [--max-reports=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (threads == 0) threads = 1;
+
+    std::printf("Exhaustive equivalence: %zu engines vs analyze_chord_reference, %u threads\n", ENGINE_COUNT, threads);
+    auto start = std::chrono::steady_clock::now();
+
+    // Shared tables are built before the workers start
+    ChordDetector::lookup_table();
+    builtin_dictionary();
+    cached_dictionary();
+
+    Report report;
+    report.max_reports = max_reports;
+    for (std::atomic<uint64_t>& count : report.mismatches) count.store(0);
+
+    // Masks are claimed in small chunks so threads finish together
+    std::atomic<uint32_t> next_mask{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (;;) {
+                uint32_t begin = next_mask.fetch_add(64, std::memory_order_relaxed);
+                if (begin >= 4096) return;
+                for (uint32_t mask = begin; mask < begin + 64 && mask < 4096; ++mask) {
+                    check_mask(static_cast<uint16_t>(mask), report);
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (size_t e = 0; e < ENGINE_COUNT; ++e) {
+        uint64_t count = report.mismatches[e].load();
+        total += count;
+        std::printf("%s %-28s %llu mismatches\n", count ? "✗" : "✓", ENGINES[e].name,
+                    static_cast<unsigned long long>(count));
+    }
+    std::printf("%llu cases per engine in %.2fs: %s\n", static_cast<unsigned long long>(report.cases.load()), seconds,
+                total ? "FAILED" : "all engines match the reference");
+    return total ? 1 : 0;
+}
@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "chord_detector.h"
+#include "chord_detector_midi.h"
+#include "chord_detector_parallel.h"
+#include "bench_support.h"
+
+/**
+ * Chord detector replay tool
+ * Replays a recorded note-event log or a Standard MIDI File through one engine, as fast as possible
+ * or paced at the recording's own timing, and reports events/sec, a per-event latency histogram,
+ * heap allocations and the ChordDetector::stats() counters (hit rates need CHORD_DETECTOR_STATS=ON).
+ * An event's latency runs from the moment it is handed to the engine (its scheduled time with
+ * --realtime) until its chord is available, so batch and parallel engines include the wait for the
+ * rest of their call.
+ *
+ * Note-event logs are text, one event per line: <tick> <note> <channel> <on>; '#' starts a comment.
+ * Log ticks are microseconds unless --tick_us says otherwise; SMF timing follows division and tempo.
+ *
+ * Usage:
+ *   chord_detector_replay <file> [--engine=reference|table|batch|tracker|parallel] [--realtime]
+ *                         [--repeat=<passes>] [--slash] [--cached] [--block=<events>] [--threads=<n>]
+ *                         [--tick_us=<microseconds>] [--all_channels] [--no_warmup] [--dump_log=<file>]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+enum class Engine { Reference, Table, Batch, Tracker, Parallel };
+
+struct Options {
+    const char* path = nullptr;
+    Engine engine = Engine::Tracker;
+    bool realtime = false;
+    int repeat = 1;
+    bool use_slash = false;
+    bool cached = false;            // Mode::Cached dictionary: lookups go through the memo cache
+    size_t block = 64;              // Events per analyze_chords_batch call
+    unsigned threads = 0;
+    double tick_us = 0.0;           // 0 = from the file (SMF) or 1 (log)
+    bool all_channels = false;
+    bool warmup = true;             // Unreported first pass, so tables and caches start warm
+    const char* dump_path = nullptr;
+};
+
+struct Recording {
+    std::vector<NoteEvent> events;
+    std::vector<double> times_us;   // Offset of each event from the start of the recording
+};
+
+static const char* engine_name(Engine engine) {
+    switch (engine) {
+        case Engine::Reference: return "reference";
+        case Engine::Table: return "table";
+        case Engine::Batch: return "batch";
+        case Engine::Tracker: return "tracker";
+        case Engine::Parallel: return "parallel";
+    }
+    return "";
+}
+
+static bool parse_engine(const char* name, Engine& engine) {
+    for (Engine candidate : {Engine::Reference, Engine::Table, Engine::Batch, Engine::Tracker, Engine::Parallel}) {
+        if (std::strcmp(name, engine_name(candidate)) == 0) {
+            engine = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Microseconds per tick; SMPTE divisions have the negative frame rate in the high byte
+static double smf_tick_us(uint16_t division, uint32_t tempo) {
+    if (division & 0x8000) {
+        int fps = -static_cast<int8_t>(division >> 8);
+        int ticks_per_frame = division & 0xFF;
+        return fps > 0 && ticks_per_frame > 0 ? 1e6 / (fps * ticks_per_frame) : 1.0;
+    }
+    return division ? static_cast<double>(tempo) / division : 1.0;
+}
+
+// Tempo changes are picked up as the reader passes them, so they can take effect a few events early
+static const char* load_smf(const Options& options, Recording& recording) {
+    ChordDetector::MidiChordReader reader(options.path, false,
+                                          options.all_channels ? 0xFFFF : ChordDetector::MIDI_PITCHED_CHANNELS);
+    NoteEvent event;
+    uint32_t last_tick = 0;
+    double now_us = 0.0;
+    while (reader.next_event(event)) {
+        double tick_us = options.tick_us > 0.0 ? options.tick_us : smf_tick_us(reader.division(), reader.tempo());
+        now_us += (event.tick - last_tick) * tick_us;
+        last_tick = event.tick;
+        recording.events.push_back(event);
+        recording.times_us.push_back(now_us);
+    }
+    return reader.ok() ? nullptr : reader.error();
+}
+
+static const char* load_log(const Options& options, Recording& recording) {
+    std::FILE* file = std::fopen(options.path, "r");
+    if (!file) return "cannot open file";
+
+    double tick_us = options.tick_us > 0.0 ? options.tick_us : 1.0;
+    const char* error = nullptr;
+    char line[256];
+    unsigned long first_tick = 0, last_tick = 0;
+    while (!error && std::fgets(line, sizeof(line), file)) {
+        if (char* comment = std::strchr(line, '#')) *comment = '\0';
+        unsigned long tick;
+        unsigned note, channel, on;
+        char extra;
+        int fields = std::sscanf(line, "%lu %u %u %u %c", &tick, &note, &channel, &on, &extra);
+        if (fields <= 0) continue;      // Blank or comment-only line
+        if (fields != 4 || note > 127 || channel > 15 || on > 1) {
+            error = "malformed event line (expected: <tick> <note> <channel> <on>)";
+        } else if (!recording.events.empty() && tick < last_tick) {
+            error = "ticks must not decrease";
+        } else {
+            if (recording.events.empty()) first_tick = tick;
+            last_tick = tick;
+            recording.events.push_back({static_cast<uint32_t>(tick), static_cast<uint8_t>(note),
+                                        static_cast<uint8_t>(channel), static_cast<uint8_t>(on)});
+            recording.times_us.push_back((tick - first_tick) * tick_us);
+        }
+    }
+    std::fclose(file);
+    return error;
+}
+
+static bool is_smf(const char* path) {
+    char magic[4] = {};
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+    bool smf = std::fread(magic, 1, 4, file) == 4 && std::memcmp(magic, "MThd", 4) == 0;
+    std::fclose(file);
+    return smf;
+}
+
+// Ticks are written as microseconds, so a converted SMF replays with its original timing
+static bool dump_log(const char* path, const Recording& recording) {
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    std::fprintf(file, "# <tick> <note> <channel> <on>, ticks in microseconds\n");
+    for (size_t i = 0; i < recording.events.size(); ++i) {
+        const NoteEvent& event = recording.events[i];
+        std::fprintf(file, "%llu %u %u %u\n", static_cast<unsigned long long>(recording.times_us[i] + 0.5),
+                     event.note, event.channel, event.on);
+    }
+    return std::fclose(file) == 0;
+}
+
+// Held notes as an application without ChordTracker keeps them: a note list for analyze_chord and
+// analyze_chord_fast, and a (pitch-class set, bass) frame for analyze_chords_batch
+struct HeldNotes {
+    uint16_t counts[128] = {};
+    int notes[128];
+    int count = 0;
+
+    void apply(const NoteEvent& event) {
+        if (event.on) {
+            if (counts[event.note]++ == 0) notes[count++] = event.note;
+        } else if (counts[event.note] && --counts[event.note] == 0) {
+            int* end = notes + count;
+            *std::find(notes, end, static_cast<int>(event.note)) = notes[--count];
+        }
+    }
+
+    void reset() {
+        std::memset(counts, 0, sizeof(counts));
+        count = 0;
+    }
+
+    uint16_t pitch_class_mask() const {
+        uint16_t mask = 0;
+        for (int i = 0; i < count; ++i) mask |= static_cast<uint16_t>(1 << (notes[i] % 12));
+        return mask;
+    }
+
+    uint8_t bass_pc() const {
+        if (count == 0) return ChordDetector::NO_PITCH_CLASS;
+        return static_cast<uint8_t>(*std::min_element(notes, notes + count) % 12);
+    }
+};
+
+// Results of one replay, collected without allocating while the engine runs
+struct ReplayResult {
+    std::vector<uint64_t> latencies_ns;     // Per event, over all passes
+    size_t recorded = 0;
+    double busy_seconds = 0.0;              // From handing each event over until the engine was free again
+    double wall_seconds = 0.0;
+    double max_lateness_us = 0.0;           // --realtime: worst delay past an event's scheduled time
+    uint64_t allocations = 0;
+};
+
+static uint64_t elapsed_ns(Clock::time_point begin, Clock::time_point end) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+}
+
+// Sleep most of the way, then spin, so events are handed over within a microsecond or so of schedule
+static void wait_until(Clock::time_point target) {
+    std::this_thread::sleep_until(target - std::chrono::microseconds(200));
+    while (Clock::now() < target) {
+    }
+}
+
+class Replayer {
+public:
+    Replayer(const Options& options, const Recording& recording)
+        : options_(options), recording_(recording),
+          dictionary_(nullptr, 0, true, options.cached ? ChordDictionary::Mode::Cached : ChordDictionary::Mode::Table),
+          tracker_(options.cached ? ChordTracker(dictionary_, options.use_slash) : ChordTracker(options.use_slash)) {
+        size_t block = std::max<size_t>(options.block, 1);
+        block_masks_.resize(block);
+        block_bass_.resize(block);
+        block_ready_.resize(block);
+        block_out_.resize(block);
+
+        if (options.engine == Engine::Parallel) {
+            // One stream per channel: channels are the independent unit the analyzer can spread over threads
+            for (const NoteEvent& event : recording.events) channel_events_[event.channel].push_back(event);
+            for (int channel = 0; channel < 16; ++channel) {
+                if (channel_events_[channel].empty()) continue;
+                channel_out_[channel].resize(channel_events_[channel].size());
+                streams_.push_back({channel_events_[channel].data(), channel_events_[channel].size(),
+                                    channel_out_[channel].data()});
+            }
+            analyzer_.reset(new ChordDetector::ParallelAnalyzer(options.threads, options.cached ? &dictionary_ : nullptr));
+        }
+    }
+
+    ReplayResult run() {
+        ReplayResult result;
+        result.latencies_ns.resize(recording_.events.size() * static_cast<size_t>(options_.repeat));
+
+        // Tables and caches are built by one unpaced warm-up pass that is not reported
+        if (options_.warmup) {
+            replay_pass(result, false);
+            result.recorded = 0;
+            result.busy_seconds = 0.0;
+        }
+
+        ChordDetector::reset_stats();
+        uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+        Clock::time_point begin = Clock::now();
+        for (int pass = 0; pass < options_.repeat; ++pass) replay_pass(result, options_.realtime);
+        result.wall_seconds = elapsed_ns(begin, Clock::now()) * 1e-9;
+        result.allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+        return result;
+    }
+
+private:
+    void replay_pass(ReplayResult& result, bool paced) {
+        held_.reset();
+        tracker_.reset();
+        block_count_ = 0;
+        if (options_.engine == Engine::Parallel) {
+            Clock::time_point ready = Clock::now();
+            analyzer_->analyze(streams_.data(), streams_.size(), options_.use_slash);
+            Clock::time_point done = Clock::now();
+            charge(result, ready, done, recording_.events.size());
+            result.busy_seconds += elapsed_ns(ready, done) * 1e-9;
+            return;
+        }
+
+        size_t count = recording_.events.size();
+        Clock::time_point start = Clock::now();
+        Clock::time_point ready = start;
+        Clock::time_point handed = start;
+        for (size_t i = 0; i < count; ++i) {
+            if (paced) {
+                ready = start + std::chrono::nanoseconds(static_cast<int64_t>(recording_.times_us[i] * 1e3));
+                wait_until(ready);
+                handed = Clock::now();
+                result.max_lateness_us = std::max(result.max_lateness_us, elapsed_ns(ready, handed) * 1e-3);
+            }
+            Clock::time_point done = process(result, recording_.events[i], ready, i + 1 == count);
+            result.busy_seconds += elapsed_ns(handed, done) * 1e-9;
+            // At full speed the next event is handed over as soon as this one is done
+            if (!paced) ready = handed = done;
+        }
+    }
+
+    // Apply one event; returns when the engine is free for the next one
+    Clock::time_point process(ReplayResult& result, const NoteEvent& event, Clock::time_point ready, bool last) {
+        switch (options_.engine) {
+            case Engine::Reference: {
+                held_.apply(event);
+                ChordResult chord = options_.cached
+                    ? analyze_chord(dictionary_, held_.notes, held_.count, false, options_.use_slash)
+                    : analyze_chord(held_.notes, held_.count, false, options_.use_slash);
+                do_not_optimize(chord);
+                break;
+            }
+            case Engine::Table: {
+                held_.apply(event);
+                PackedChordResult chord = options_.cached
+                    ? analyze_chord_fast(dictionary_, held_.notes, held_.count, options_.use_slash)
+                    : analyze_chord_fast(held_.notes, held_.count, options_.use_slash);
+                do_not_optimize(chord);
+                break;
+            }
+            case Engine::Tracker: {
+                tracker_.apply(event);
+                do_not_optimize(tracker_.current());
+                break;
+            }
+            case Engine::Batch: {
+                held_.apply(event);
+                block_masks_[block_count_] = held_.pitch_class_mask();
+                block_bass_[block_count_] = held_.bass_pc();
+                block_ready_[block_count_] = ready;
+                if (++block_count_ < block_masks_.size() && !last) return Clock::now();
+
+                if (options_.cached) {
+                    analyze_chords_batch(dictionary_, block_masks_.data(), block_bass_.data(), block_count_,
+                                         block_out_.data(), options_.use_slash);
+                } else {
+                    analyze_chords_batch(block_masks_.data(), block_bass_.data(), block_count_, block_out_.data(),
+                                         options_.use_slash);
+                }
+                do_not_optimize(block_out_[0]);
+                Clock::time_point done = Clock::now();
+                for (size_t j = 0; j < block_count_; ++j) charge(result, block_ready_[j], done, 1);
+                block_count_ = 0;
+                return done;
+            }
+            case Engine::Parallel:
+                break;
+        }
+        Clock::time_point done = Clock::now();
+        charge(result, ready, done, 1);
+        return done;
+    }
+
+    // Record the latency of events whose chords became available at done
+    static void charge(ReplayResult& result, Clock::time_point ready, Clock::time_point done, size_t events) {
+        uint64_t ns = elapsed_ns(ready, done);
+        for (size_t i = 0; i < events && result.recorded < result.latencies_ns.size(); ++i) {
+            result.latencies_ns[result.recorded++] = ns;
+        }
+    }
+
+    const Options& options_;
+    const Recording& recording_;
+    ChordDictionary dictionary_;
+    ChordTracker tracker_;
+    HeldNotes held_;
+
+    std::vector<uint16_t> block_masks_;
+    std::vector<uint8_t> block_bass_;
+    std::vector<Clock::time_point> block_ready_;
+    std::vector<PackedChordResult> block_out_;
+    size_t block_count_ = 0;
+
+    std::vector<NoteEvent> channel_events_[16];
+    std::vector<PackedChordResult> channel_out_[16];
+    std::vector<ChordDetector::NoteEventStream> streams_;
+    std::unique_ptr<ChordDetector::ParallelAnalyzer> analyzer_;
+};
+
+static void print_latencies(const std::vector<uint64_t>& latencies) {
+    if (latencies.empty()) return;
+    std::vector<uint64_t> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+    };
+    std::printf("latency per event (ns): p50 %llu  p99 %llu  p999 %llu  max %llu\n",
+                static_cast<unsigned long long>(percentile(0.50)), static_cast<unsigned long long>(percentile(0.99)),
+                static_cast<unsigned long long>(percentile(0.999)), static_cast<unsigned long long>(sorted.back()));
+
+    // Power-of-two buckets: bucket b holds latencies in (2^(b-1), 2^b] ns
+    constexpr int BUCKETS = 40;
+    uint64_t counts[BUCKETS] = {};
+    for (uint64_t ns : latencies) {
+        int bucket = 0;
+        while (bucket + 1 < BUCKETS && (uint64_t(1) << bucket) < ns) ++bucket;
+        ++counts[bucket];
+    }
+    int first = 0, last = BUCKETS - 1;
+    while (counts[first] == 0) ++first;
+    while (counts[last] == 0) --last;
+    uint64_t peak = *std::max_element(counts, counts + BUCKETS);
+    for (int bucket = first; bucket <= last; ++bucket) {
+        double share = 100.0 * counts[bucket] / latencies.size();
+        int bar = static_cast<int>(40.0 * counts[bucket] / peak + 0.5);
+        std::printf("  <= %12llu ns %10llu %6.2f%% %s\n", static_cast<unsigned long long>(uint64_t(1) << bucket),
+                    static_cast<unsigned long long>(counts[bucket]), share, std::string(bar, '#').c_str());
+    }
+}
+
+static void print_hit_rate(const char* name, uint64_t hits, uint64_t misses) {
+    if (hits + misses == 0) return;
+    std::printf("  %-22s %6.2f%% (%llu hits, %llu misses)\n", name, 100.0 * hits / (hits + misses),
+                static_cast<unsigned long long>(hits), static_cast<unsigned long long>(misses));
+}
+
+static void print_stats(const ChordDetector::Stats& stats) {
+    using ChordDetector::Counter;
+    if (!ChordDetector::STATS_ENABLED) {
+        std::printf("counters: not compiled in (configure with -DCHORD_DETECTOR_STATS=ON)\n");
+        return;
+    }
+    std::printf("counters:\n");
+    print_hit_rate("tracker hit rate", stats[Counter::TrackerHits], stats[Counter::TrackerMisses]);
+    print_hit_rate("memo cache hit rate", stats[Counter::MemoHits], stats[Counter::MemoMisses]);
+    for (size_t i = 0; i < ChordDetector::NUM_COUNTERS; ++i) {
+        if (stats.counts[i] == 0) continue;
+        std::printf("  %-22s %llu\n", ChordDetector::counter_name(static_cast<Counter>(i)),
+                    static_cast<unsigned long long>(stats.counts[i]));
+    }
+}
+
+static int usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s <file> [--engine=reference|table|batch|tracker|parallel] [--realtime] "
+                 "[--repeat=<passes>] [--slash] [--cached] [--block=<events>] [--threads=<n>] "
+                 "[--tick_us=<microseconds>] [--all_channels] [--no_warmup] [--dump_log=<file>]\n", program);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--engine=", 9) == 0) {
+            if (!parse_engine(arg + 9, options.engine)) return usage(argv[0]);
+        } else if (std::strcmp(arg, "--realtime") == 0) {
+            options.realtime = true;
+        } else if (std::strncmp(arg, "--repeat=", 9) == 0) {
+            options.repeat = std::max(1, std::atoi(arg + 9));
+        } else if (std::strcmp(arg, "--slash") == 0) {
+            options.use_slash = true;
+        } else if (std::strcmp(arg, "--cached") == 0) {
+            options.cached = true;
+        } else if (std::strncmp(arg, "--block=", 8) == 0) {
+            options.block = static_cast<size_t>(std::max(1, std::atoi(arg + 8)));
+        } else if (std::strncmp(arg, "--threads=", 10) == 0) {
+            options.threads = static_cast<unsigned>(std::max(0, std::atoi(arg + 10)));
+        } else if (std::strncmp(arg, "--tick_us=", 10) == 0) {
+            options.tick_us = std::atof(arg + 10);
+        } else if (std::strcmp(arg, "--all_channels") == 0) {
+            options.all_channels = true;
+        } else if (std::strcmp(arg, "--no_warmup") == 0) {
+            options.warmup = false;
+        } else if (std::strncmp(arg, "--dump_log=", 11) == 0) {
+            options.dump_path = arg + 11;
+        } else if (arg[0] != '-' && !options.path) {
+            options.path = arg;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (!options.path) return usage(argv[0]);
+    if (options.realtime && options.engine == Engine::Parallel) {
+        std::fprintf(stderr, "%s: the parallel engine replays at maximum speed only\n", argv[0]);
+        return 2;
+    }
+
+    Recording recording;
+    bool smf = is_smf(options.path);
+    if (const char* error = smf ? load_smf(options, recording) : load_log(options, recording)) {
+        std::fprintf(stderr, "%s: %s: %s\n", argv[0], options.path, error);
+        return 1;
+    }
+    if (options.dump_path && !dump_log(options.dump_path, recording)) {
+        std::fprintf(stderr, "%s: cannot write %s\n", argv[0], options.dump_path);
+        return 1;
+    }
+    if (recording.events.empty()) {
+        std::fprintf(stderr, "%s: %s: no note events\n", argv[0], options.path);
+        return 1;
+    }
+
+    Replayer replayer(options, recording);
+    ReplayResult result = replayer.run();
+    ChordDetector::Stats stats = ChordDetector::stats();
+
+    uint64_t events = static_cast<uint64_t>(result.latencies_ns.size());
+    std::printf("replay: %s (%s, %zu events, %.3f s recorded), engine %s%s, %d pass%s, %s\n", options.path,
+                smf ? "SMF" : "log", recording.events.size(), recording.times_us.back() * 1e-6,
+                engine_name(options.engine), options.cached ? " (cached dictionary)" : "", options.repeat,
+                options.repeat == 1 ? "" : "es", options.realtime ? "real time" : "maximum speed");
+    std::printf("events/sec: %.0f (%.3f s busy, %.3f s wall)\n",
+                result.busy_seconds > 0.0 ? events / result.busy_seconds : 0.0, result.busy_seconds,
+                result.wall_seconds);
+    if (options.realtime) std::printf("max lateness: %.1f us\n", result.max_lateness_us);
+    std::printf("allocations: %llu (%.3f per event)\n", static_cast<unsigned long long>(result.allocations),
+                static_cast<double>(result.allocations) / events);
+    print_latencies(result.latencies_ns);
+    print_stats(stats);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include "chord_detector.h"
+
+/**
+ * Build-time generator for the compiled library's lookup tables
+ * Runs the header-only table construction once and writes it out as constant
+ * arrays, so chord_detector_static / chord_detector_shared carry the tables in
+ * .rodata instead of building them at startup.
+ *
+ * Usage:
+ *   chord_detector_tablegen <output.cpp>
+ */
+
+static bool write_table(std::FILE* file, const char* name, const ChordDetector::LookupEntry* entries) {
+    std::fprintf(file, "    const LookupEntry %s[LookupTable::NUM_ENTRIES] = {\n", name);
+    for (size_t i = 0; i < ChordDetector::LookupTable::NUM_ENTRIES; ++i) {
+        const ChordDetector::LookupEntry& e = entries[i];
+        std::fprintf(file, "%s{%u,%u,%u,%d},%s", i % 8 == 0 ? "        " : "", e.pattern_id, e.root_pc, e.flags,
+                     e.priority, i % 8 == 7 ? "\n" : "");
+    }
+    return std::fprintf(file, "    };\n\n") > 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <output.cpp>\n", argv[0]);
+        return 2;
+    }
+
+    std::FILE* file = std::fopen(argv[1], "w");
+    if (!file) {
+        std::fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    const ChordDetector::LookupTable& table = ChordDetector::lookup_table();
+    std::fprintf(file, "// Generated by chord_detector_tablegen from chord_detector.h - do not edit\n");
+    std::fprintf(file, "#include \"chord_detector.h\"\n\n");
+    std::fprintf(file, "namespace ChordDetector {\n");
+    // Fails to compile if the header's patterns changed without regenerating
+    std::fprintf(file, "    static_assert(NUM_PATTERNS == %zu, \"Stale precomputed tables\");\n\n", ChordDetector::NUM_PATTERNS);
+    bool ok = write_table(file, "PRECOMPUTED_PLAIN_TABLE", table.data(false)) &&
+              write_table(file, "PRECOMPUTED_SLASH_TABLE", table.data(true));
+    std::fprintf(file, "}\n");
+
+    if (std::fclose(file) != 0 || !ok) {
+        std::fprintf(stderr, "error writing %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -3,8 +3,23 @@
 #include <array>
 #include <string>
 #include <cassert>
-#include <chrono>
+#include <cstring>
+#include <thread>
+#include <type_traits>
 #include "chord_detector.h"
+#include "chord_detector_parallel.h"
+#include "chord_detector_midi.h"
+#include "chord_detector_chroma.h"
+#include "chord_detector_sequence.h"
+#include "chord_detector_progression.h"
+#include "chord_detector_key.h"
+#include "chord_detector_bank.h"
+#include "chord_detector_annotation.h"
+#include "chord_detector_arena.h"
+
+// Defined in test_second_tu.cpp
+std::string chord_name_from_second_tu(std::initializer_list<int> midi_notes);
+const ChordDetector::LookupTable* lookup_table_from_second_tu();
 
 // Test result tracking
 struct TestResult {
@@ -178,6 +193,54 @@ void test_detailed_analysis() {
     result.assert_bool(true, has_intervals, "Detailed analysis has intervals");
 }
 
+void test_compact_detailed_analysis() {
+    std::cout << "\n--- Compact Detailed Analysis ---" << std::endl;
+
+    static_assert(std::is_trivially_copyable<DetailedAnalysisCompact>::value, "DetailedAnalysisCompact must be POD");
+
+    DetailedAnalysisCompact compact;
+    get_detailed_analysis({71, 74, 77, 79}, compact); // G7/B
+    result.assert_equal("G7/B", compact.full_name, "Compact analysis chord name");
+    result.assert_equal("1st", inversion_name(compact.inversion), "Compact analysis inversion");
+    result.assert_equal("4", std::to_string(compact.note_count), "Compact analysis note count");
+    result.assert_equal("D", compact.note_names[0], "Compact analysis lowest pitch class");
+
+    get_detailed_analysis({60}, compact);
+    result.assert_equal("0", std::to_string(compact.interval_count), "No intervals for a single note");
+
+    // Field-by-field agreement with get_detailed_analysis for every pitch-class set and bass
+    int mismatches = 0;
+    for (int mask = 1; mask < 4096; ++mask) {
+        for (int bass = 0; bass < 12; ++bass) {
+            if (!(mask & (1 << bass))) continue;
+            int notes[12];
+            int count = 0;
+            notes[count++] = 48 + bass;
+            for (int pc = 0; pc < 12; ++pc) {
+                if (pc != bass && (mask & (1 << pc))) notes[count++] = 60 + pc;
+            }
+
+            for (bool use_flats : {false, true}) {
+                DetailedAnalysis legacy = get_detailed_analysis(notes, count, use_flats);
+                get_detailed_analysis(notes, count, compact, use_flats);
+
+                bool same = legacy.chord.full_name == compact.full_name &&
+                            legacy.inversion_type == inversion_name(compact.inversion) &&
+                            legacy.note_names.size() == compact.note_count &&
+                            legacy.intervals_from_root.size() == compact.interval_count;
+                for (size_t i = 0; same && i < legacy.note_names.size(); ++i) {
+                    same = legacy.note_names[i] == compact.note_names[i];
+                }
+                for (size_t i = 0; same && i < legacy.intervals_from_root.size(); ++i) {
+                    same = legacy.intervals_from_root[i] == compact.intervals_from_root[i];
+                }
+                if (!same) ++mismatches;
+            }
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Compact analysis matches get_detailed_analysis");
+}
+
 void test_sharp_flat_notation() {
     std::cout << "\n--- Sharp/Flat Notation ---" << std::endl;
 
@@ -270,54 +333,627 @@ void test_musical_equivalents() {
     result.assert_equal("Am7", get_chord_name({69, 72, 76, 79}, false, true), "Am7 (C6/A equivalent)");
 }
 
-void test_performance() {
-    std::cout << "\n--- Performance Test ---" << std::endl;
+void test_lookup_table() {
+    std::cout << "\n--- Lookup Table vs Reference Scan ---" << std::endl;
+
+    // Every pitch-class set with every member as the bass note
+    int mismatches = 0;
+    for (int mask = 1; mask < 4096; ++mask) {
+        for (int bass = 0; bass < 12; ++bass) {
+            if (!(mask & (1 << bass))) continue;
+
+            int notes[12];
+            int count = 0;
+            notes[count++] = 48 + bass;
+            for (int pc = 0; pc < 12; ++pc) {
+                if (pc != bass && (mask & (1 << pc))) notes[count++] = 60 + pc;
+            }
+
+            for (int flags = 0; flags < 4; ++flags) {
+                bool use_flats = flags & 1, use_slash = flags & 2;
+                ChordResult fast = analyze_chord(notes, count, use_flats, use_slash);
+                ChordResult ref = ChordDetector::analyze_chord_reference(notes, count, use_flats, use_slash);
+                if (fast.full_name != ref.full_name || fast.chord_name != ref.chord_name ||
+                    fast.bass_note != ref.bass_note || fast.is_slash_chord != ref.is_slash_chord ||
+                    fast.root_pitch_class != ref.root_pitch_class || fast.bass_pitch_class != ref.bass_pitch_class) {
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Table matches reference for all pitch-class sets");
+
+    // One candidate pass yields both readings
+    int pair_mismatches = 0;
+    for (int mask = 1; mask < 4096; ++mask) {
+        for (int bass = 0; bass < 12; ++bass) {
+            if (!(mask & (1 << bass))) continue;
+            ChordDetector::LookupEntryPair pair = ChordDetector::search_pitch_class_set_pair(static_cast<uint16_t>(mask), bass);
+            ChordDetector::LookupEntry plain = ChordDetector::search_pitch_class_set(static_cast<uint16_t>(mask), bass, false);
+            ChordDetector::LookupEntry slash = ChordDetector::search_pitch_class_set(static_cast<uint16_t>(mask), bass, true);
+            if (std::memcmp(&pair.plain, &plain, sizeof(plain)) != 0 || std::memcmp(&pair.slash, &slash, sizeof(slash)) != 0) {
+                ++pair_mismatches;
+            }
+        }
+    }
+    result.assert_equal("0", std::to_string(pair_mismatches), "Paired search matches plain and slash searches");
+    static_assert(ChordDetector::search_pitch_class_set_pair(0x091, 4).slash.flags & ChordDetector::CHORD_FLAG_SLASH,
+                  "C/E from the paired search");
+
+    // Out-of-range notes no longer take part in bass selection
+    ChordResult invalid_bass = analyze_chord({-1, 64, 67, 72, 128}, false, true);
+    result.assert_equal("C/E", invalid_bass.full_name, "Invalid MIDI ignored for bass");
+
+    // Bass values past 11 would alias the next mask's entries
+    PackedChordResult alias = ChordDetector::lookup_chord(0x90, 12, false);
+    PackedChordResult last = ChordDetector::lookup_chord(0xFFF, 12, true);
+    result.assert_bool(false, ((alias.flags | last.flags) & ChordDetector::CHORD_FLAG_MATCHED) != 0, "Out-of-range bass is unmatched");
+}
+
+void test_packed_results() {
+    std::cout << "\n--- Packed Results and Formatting ---" << std::endl;
+
+    static_assert(sizeof(PackedChordResult) == 6, "PackedChordResult should stay compact");
+    static_assert(std::is_trivially_copyable<PackedChordResult>::value, "PackedChordResult must be POD");
+
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+
+    PackedChordResult g7_b = analyze_chord_fast({71, 74, 77, 79}, true);
+    result.assert_equal("7", std::to_string(g7_b.root_pc), "G7/B packed root");
+    result.assert_equal("11", std::to_string(g7_b.bass_pc), "G7/B packed bass");
+    result.assert_equal("7", ChordDetector::CHORD_PATTERNS[g7_b.pattern_id].name, "G7/B packed pattern");
+    result.assert_bool(true, (g7_b.flags & ChordDetector::CHORD_FLAG_SLASH) != 0, "G7/B packed slash flag");
+    result.assert_equal("G7/B", std::string(format_chord(g7_b, buf, sizeof(buf))), "G7/B formatted");
+
+    PackedChordResult gb7 = analyze_chord_fast({70, 73, 76, 78}, true);
+    result.assert_equal("Gb7/Bb", std::string(format_chord(gb7, buf, sizeof(buf), true)), "Gb7/Bb formatted (flat)");
 
-    const int iterations = 100000;
-    std::vector<int> test_chord = {71, 74, 77, 79}; // G7/B
+    PackedChordResult c_e = analyze_chord_fast({64, 67, 72});
+    result.assert_equal("C", std::string(format_chord(c_e, buf, sizeof(buf))), "C/E formatted without slash");
+
+    // Truncation keeps the buffer NUL-terminated
+    char small[3];
+    std::string_view truncated = format_chord(gb7, small, sizeof(small), true);
+    result.assert_equal("Gb", std::string(truncated), "Truncated format");
+    result.assert_bool(true, small[2] == '\0', "Truncated format NUL-terminated");
+
+    // No match
+    PackedChordResult single = analyze_chord_fast({60});
+    result.assert_bool(false, (single.flags & ChordDetector::CHORD_FLAG_MATCHED) != 0, "Single note not matched");
+    result.assert_equal("", std::string(format_chord(single, buf, sizeof(buf))), "Single note formatted");
+    result.assert_equal("0", std::to_string(single.bass_pc), "Single note packed bass");
+
+    // Expansion to ChordResult
+    ChordResult expanded = to_chord_result(analyze_chord_fast({60, 62, 65}, true));
+    result.assert_equal("Dm7(omit5)/C", expanded.full_name, "Expanded packed result");
+    result.assert_equal("Dm7(omit5)", expanded.chord_name, "Expanded packed chord_name");
+}
 
-    // Test basic chord detection performance
-    auto start1 = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
-        volatile std::string result_basic = get_chord_name(test_chord);
-        (void)result_basic;
+void test_result_fields() {
+    std::cout << "\n--- Opt-in Result Fields ---" << std::endl;
+
+    // Pitch classes and the slash flag are always filled; strings only on request
+    ChordResult bare = analyze_chord({64, 67, 72}, false, true, ChordDetector::FIELDS_NONE);
+    result.assert_bool(true, bare.full_name.empty() && bare.chord_name.empty() && bare.bass_note.empty(), "No strings without fields");
+    result.assert_bool(true, bare.is_slash_chord && bare.root_pitch_class == 0 && bare.bass_pitch_class == 4, "Pitch classes without fields");
+    ChordResult name_only = analyze_chord({64, 67, 72}, false, true, ChordDetector::FIELD_CHORD_NAME);
+    result.assert_bool(true, name_only.chord_name == "C" && name_only.full_name.empty(), "Only the chord name");
+    ChordDictionary jazz = {{(1<<0)|(1<<3)|(1<<4)|(1<<7)|(1<<10), "7#9", 82}};
+    ChordResult full_only = analyze_chord(jazz, {68, 71, 74, 79, 64}, true, true, ChordDetector::FIELD_FULL_NAME);
+    result.assert_bool(true, full_only.full_name == "E7#9" && full_only.chord_name.empty() && full_only.bass_note.empty(),
+                       "Dictionary full name only");
+
+    // Lazy view: same values as ChordResult, names on demand
+    ChordView view = analyze_chord_view({64, 67, 72}, false, true);
+    result.assert_equal("C/E", std::string(view.full_name()), "View full name");
+    result.assert_equal("C", std::string(view.chord_name()), "View chord name");
+    result.assert_equal("E", std::string(view.bass_note()), "View bass note");
+    result.assert_bool(true, view.is_slash_chord() && view.root_pitch_class() == 0 && view.inversion() == Inversion::First,
+                       "View pitch classes and inversion");
+    ChordView flats = analyze_chord_view(jazz, {66, 70, 73, 76, 81, 61}, true, true);
+    result.assert_equal("Gb7#9/Db", std::string(flats.full_name()), "Dictionary view full name");
+    result.assert_equal("Gb7#9", std::string(flats.chord_name()), "Dictionary view chord name");
+    ChordDictionary verbose = {{(1<<0)|(1<<3)|(1<<4)|(1<<7)|(1<<10), "-dominant-seventh-with-sharp-ninth-voicing", 82}};
+    int long_view_mismatches = 0;
+    for (int use_slash = 0; use_slash < 2; ++use_slash) {
+        ChordView long_view = analyze_chord_view(verbose, {66, 70, 73, 76, 81, 61}, true, use_slash != 0);
+        ChordView copied = long_view;
+        ChordResult expected = long_view.to_result();
+        long_view_mismatches += expected.full_name != long_view.full_name() || expected.chord_name != long_view.chord_name() ||
+                                expected.full_name != copied.full_name() || expected.full_name.size() < 40;
     }
-    auto end1 = std::chrono::high_resolution_clock::now();
-    auto duration1 = std::chrono::duration_cast<std::chrono::microseconds>(end1 - start1);
+    result.assert_equal("0", std::to_string(long_view_mismatches), "Long dictionary names in a view");
+    ChordView none = analyze_chord_view({60, 61});
+    result.assert_bool(true, !none.matched() && none.full_name().empty() && none.root_pitch_class() == -1, "Unmatched view");
+
+    int mismatches = 0;
+    for (int mask = 1; mask < 4096; mask += 7) {
+        std::vector<int> notes;
+        for (int pc = 0; pc < 12; ++pc) {
+            if (mask & (1 << pc)) notes.push_back(60 + pc);
+        }
+        ChordResult a = analyze_chord(notes, true, true);
+        ChordView v = analyze_chord_view(notes, true, true);
+        ChordResult b = v.to_result();
+        if (a.full_name != v.full_name() || a.chord_name != v.chord_name() || a.bass_note != v.bass_note() ||
+            a.root_pitch_class != v.root_pitch_class() || a.bass_pitch_class != v.bass_pitch_class() ||
+            a.full_name != b.full_name || a.is_slash_chord != v.is_slash_chord()) ++mismatches;
+    }
+    result.assert_equal("0", std::to_string(mismatches), "View matches ChordResult");
+
+    // Detailed analysis skips the arrays it is not asked for
+    DetailedAnalysis intervals = get_detailed_analysis({67, 71, 74, 77}, false, ChordDetector::FIELD_INTERVALS);
+    result.assert_bool(true, intervals.note_names.empty() && intervals.intervals_from_root.size() == 4 &&
+                       intervals.inversion_type.empty() && intervals.chord.full_name.empty(), "Detailed intervals only");
+    DetailedAnalysisCompact compact;
+    get_detailed_analysis({71, 74, 77, 79}, compact, false, ChordDetector::FIELD_NOTE_NAMES);
+    result.assert_bool(true, compact.note_count == 4 && compact.interval_count == 0 && compact.full_name[0] == '\0' &&
+                       compact.inversion == Inversion::First, "Compact note names only");
+}
 
-    // Test slash chord detection performance
-    auto start2 = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
-        volatile std::string result_slash = get_chord_name(test_chord, false, true);
-        (void)result_slash;
+void test_batch_analysis() {
+    std::cout << "\n--- Batch Analysis ---" << std::endl;
+
+    // Pseudo-random chords of 0-7 notes, including out-of-range values
+    std::vector<int> notes;
+    std::vector<size_t> offsets = {0};
+    unsigned seed = 12345;
+    for (int chord = 0; chord < 2000; ++chord) {
+        seed = seed * 1103515245u + 12345u;
+        int count = static_cast<int>((seed >> 16) % 8);
+        for (int i = 0; i < count; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            notes.push_back(static_cast<int>((seed >> 16) % 140) - 6);
+        }
+        offsets.push_back(notes.size());
     }
-    auto end2 = std::chrono::high_resolution_clock::now();
-    auto duration2 = std::chrono::duration_cast<std::chrono::microseconds>(end2 - start2);
+    size_t chord_count = offsets.size() - 1;
+
+    for (int use_slash = 0; use_slash < 2; ++use_slash) {
+        std::vector<PackedChordResult> batch(chord_count);
+        analyze_chords_batch(notes.data(), offsets.data(), chord_count, batch.data(), use_slash != 0);
 
-    // Test full analysis performance
-    auto start3 = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
-        volatile ChordResult result_analysis = analyze_chord(test_chord, false, true);
-        (void)result_analysis;
+        int mismatches = 0;
+        for (size_t i = 0; i < chord_count; ++i) {
+            PackedChordResult single = analyze_chord_fast(notes.data() + offsets[i],
+                                                          static_cast<int>(offsets[i + 1] - offsets[i]), use_slash != 0);
+            if (std::memcmp(&single, &batch[i], sizeof(PackedChordResult)) != 0) ++mismatches;
+        }
+        result.assert_equal("0", std::to_string(mismatches),
+                            use_slash ? "Batch matches single-chord (slash)" : "Batch matches single-chord");
     }
-    auto end3 = std::chrono::high_resolution_clock::now();
-    auto duration3 = std::chrono::duration_cast<std::chrono::microseconds>(end3 - start3);
 
-    double avg_basic = static_cast<double>(duration1.count()) / iterations;
-    double avg_slash = static_cast<double>(duration2.count()) / iterations;
-    double avg_analysis = static_cast<double>(duration3.count()) / iterations;
+    // Structure-of-arrays input
+    uint16_t masks[] = {(1 << 0) | (1 << 4) | (1 << 7), (1 << 0) | (1 << 4) | (1 << 7), 0};
+    uint8_t bass[] = {4, 4, ChordDetector::NO_PITCH_CLASS};
+    PackedChordResult out[3];
+    analyze_chords_batch(masks, bass, 2, out, true);
+    analyze_chords_batch(masks + 2, bass + 2, 1, out + 2);
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    result.assert_equal("C/E", std::string(format_chord(out[0], buf, sizeof(buf))), "SoA batch C/E");
+    result.assert_equal("", std::string(format_chord(out[2], buf, sizeof(buf))), "SoA batch empty chord");
+}
 
-    std::cout << "Basic chord detection: " << avg_basic << " μs/call" << std::endl;
-    std::cout << "Slash chord detection: " << avg_slash << " μs/call" << std::endl;
-    std::cout << "Full chord analysis: " << avg_analysis << " μs/call" << std::endl;
+void test_chord_tracker() {
+    std::cout << "\n--- Incremental Chord Tracker ---" << std::endl;
+
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    ChordTracker tracker(true);
+
+    result.assert_bool(false, tracker.note_on(64), "E alone is not a chord");
+    result.assert_bool(true, tracker.note_on(67), "E-G changes chord");
+    result.assert_bool(true, tracker.note_on(72), "Adding C changes chord");
+    result.assert_equal("C/E", std::string(format_chord(tracker.current(), buf, sizeof(buf))), "Tracker C/E");
+
+    // Octave doubling keeps the pitch-class set and bass
+    result.assert_bool(false, tracker.note_on(76), "Octave doubling no change");
+    result.assert_bool(false, tracker.note_off(76), "Releasing doubling no change");
+
+    // Lower bass note changes the slash reading
+    result.assert_bool(true, tracker.note_on(48), "C bass changes chord");
+    result.assert_equal("C", std::string(format_chord(tracker.current(), buf, sizeof(buf))), "Tracker C root position");
+    result.assert_bool(true, tracker.note_off(48), "Releasing C bass changes chord");
+    result.assert_equal("C/E", std::string(format_chord(tracker.current(), buf, sizeof(buf))), "Tracker back to C/E");
+
+    // Repeated note-on of the same key needs the same number of note-offs
+    tracker.note_on(72);
+    result.assert_bool(false, tracker.note_off(72), "First release of doubled key keeps chord");
+    result.assert_bool(true, tracker.note_off(72), "Second release changes chord");
+    result.assert_equal("64", std::to_string(tracker.bass_note()), "Tracker bass note");
+
+    // Ignored events
+    result.assert_bool(false, tracker.note_off(50), "Releasing unheld note ignored");
+    result.assert_bool(false, tracker.note_on(128), "Out-of-range note ignored");
+
+    // Non-slash tracker ignores bass-only changes
+    ChordTracker plain;
+    plain.note_on(64);
+    plain.note_on(67);
+    plain.note_on(72);
+    result.assert_bool(false, plain.note_on(48), "Bass-only change hidden without slash");
+    result.assert_equal("C", std::string(format_chord(plain.current(), buf, sizeof(buf))), "Plain tracker C");
+
+    // Tracker agrees with one-shot analysis
+    PackedChordResult direct = analyze_chord_fast({48, 64, 67, 72});
+    result.assert_bool(true, std::memcmp(&direct, &plain.current(), sizeof(direct)) == 0, "Tracker matches analyze_chord_fast");
+
+    plain.reset();
+    result.assert_equal("-1", std::to_string(plain.bass_note()), "Tracker reset");
+}
 
-    // All should be under 2 μs for real-time usage
-    if (avg_basic < 2.0 && avg_slash < 2.0 && avg_analysis < 2.0) {
-        std::cout << "✓ Performance: All functions suitable for real-time usage" << std::endl;
-        result.passed++;
-    } else {
-        std::cout << "✗ Performance: Some functions too slow for real-time usage" << std::endl;
-        result.failed++;
+// Detection behavior locked in at compile time
+constexpr size_t find_pattern(const char* name) {
+    for (size_t p = 0; p < ChordDetector::NUM_PATTERNS; ++p) {
+        if (ChordDetector::names_equal(ChordDetector::CHORD_PATTERNS[p].name, name)) return p;
+    }
+    return ChordDetector::NUM_PATTERNS;
+}
+
+constexpr PackedChordResult CEF = analyze_chord_constexpr({60, 64, 65});
+static_assert(CEF.root_pc == 0 && CEF.pattern_id == find_pattern("add11(omit5)"), "C-E-F is Cadd11(omit5)");
+
+constexpr PackedChordResult CDF_SLASH = analyze_chord_constexpr({60, 62, 65}, true);
+static_assert(CDF_SLASH.root_pc == 2 && CDF_SLASH.bass_pc == 0 &&
+              CDF_SLASH.pattern_id == find_pattern("m7(omit5)") &&
+              (CDF_SLASH.flags & ChordDetector::CHORD_FLAG_SLASH), "C-D-F is Dm7(omit5)/C");
+
+constexpr int G7_B[] = {71, 74, 77, 79};
+static_assert(analyze_chord_constexpr(G7_B, true).root_pc == 7, "B-D-F-G is G7/B");
+static_assert(!(analyze_chord_constexpr(G7_B).flags & ChordDetector::CHORD_FLAG_SLASH), "G7 without slash");
+static_assert(!(analyze_chord_constexpr({60}).flags & ChordDetector::CHORD_FLAG_MATCHED), "Single note is no chord");
+
+void test_constexpr_analysis() {
+    std::cout << "\n--- Compile-time Analysis ---" << std::endl;
+
+    // The constexpr search agrees with the lookup table at runtime too
+    int mismatches = 0;
+    for (int mask = 1; mask < 4096; ++mask) {
+        for (int bass = 0; bass < 12; ++bass) {
+            if (!(mask & (1 << bass))) continue;
+            for (int use_slash = 0; use_slash < 2; ++use_slash) {
+                int notes[12];
+                int count = 0;
+                notes[count++] = 36 + bass;
+                for (int pc = 0; pc < 12; ++pc) {
+                    if (pc != bass && (mask & (1 << pc))) notes[count++] = 60 + pc;
+                }
+                PackedChordResult a = analyze_chord_constexpr(notes, count, use_slash != 0);
+                PackedChordResult b = analyze_chord_fast(notes, count, use_slash != 0);
+                if (std::memcmp(&a, &b, sizeof(a)) != 0) ++mismatches;
+            }
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Constexpr search matches lookup table");
+
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    result.assert_equal("Cadd11(omit5)", std::string(format_chord(CEF, buf, sizeof(buf))), "Constexpr C-E-F formatted");
+    result.assert_equal("Dm7(omit5)/C", std::string(format_chord(CDF_SLASH, buf, sizeof(buf))), "Constexpr C-D-F formatted");
+}
+
+void test_pattern_index() {
+    std::cout << "\n--- Pattern Index ---" << std::endl;
+
+    using ChordDetector::PATTERN_INDEX;
+    constexpr uint16_t ambiguous = (1 << 0) | (1 << 2) | (1 << 5);
+    static_assert(PATTERN_INDEX.first[ambiguous + 1] - PATTERN_INDEX.first[ambiguous] == 2,
+                  "sus2sus4 and the ? sentinel share a mask");
+
+    // best[] agrees with a linear scan (highest priority, earliest entry on ties)
+    int mismatches = 0;
+    for (int mask = 0; mask < 4096; ++mask) {
+        uint16_t expected = ChordDetector::PATTERN_NONE;
+        for (size_t p = 0; p < ChordDetector::NUM_PATTERNS; ++p) {
+            if (ChordDetector::CHORD_PATTERNS[p].mask != mask) continue;
+            if (expected == ChordDetector::PATTERN_NONE ||
+                ChordDetector::CHORD_PATTERNS[p].priority > ChordDetector::CHORD_PATTERNS[expected].priority) {
+                expected = static_cast<uint16_t>(p);
+            }
+        }
+        if (PATTERN_INDEX.best[mask] != expected) ++mismatches;
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Pattern index matches linear scan");
+    result.assert_equal("?", ChordDetector::CHORD_PATTERNS[PATTERN_INDEX.best[ambiguous]].name, "Ambiguous mask best pattern");
+}
+
+void test_chord_dictionary() {
+    std::cout << "\n--- Custom Chord Dictionary ---" << std::endl;
+
+    ChordDictionary jazz = {
+        {(1<<0)|(1<<3)|(1<<4)|(1<<7)|(1<<10), "7#9", 82},   // R,#9,M3,P5,m7
+        {(1<<0)|(1<<1)|(1<<4)|(1<<7)|(1<<10), "7b9", 82},   // R,b9,M3,P5,m7
+        {(1<<0)|(1<<5)|(1<<10), "quartal", 50},             // R,P4,m7 (stacked fourths)
+        {(1<<0)|(1<<4)|(1<<7)|(1<<11), "maj7", 81},         // Overrides built-in M7 (80)
+    };
+
+    result.assert_equal("E7#9", analyze_chord(jazz, {64, 68, 71, 74, 79}).full_name, "Dictionary 7#9");
+    result.assert_equal("G7b9", analyze_chord(jazz, {67, 71, 74, 77, 68}).full_name, "Dictionary 7b9");
+    result.assert_equal("Dquartal", analyze_chord(jazz, {62, 67, 72}).full_name, "Dictionary quartal voicing");
+    result.assert_equal("Cmaj7/E", analyze_chord(jazz, {64, 67, 71, 72}, false, true).full_name, "Dictionary override with slash");
+    result.assert_equal("Gb7#9", analyze_chord(jazz, {66, 70, 73, 76, 81}, true).full_name, "Dictionary 7#9 flats");
+
+    // Built-in chords are unaffected, and the built-in default dictionary matches the global table
+    result.assert_equal("Am7", analyze_chord(jazz, {69, 72, 76, 79}).full_name, "Dictionary keeps built-in patterns");
+    result.assert_equal("" , analyze_chord({64, 68, 71, 74, 79}).full_name, "Global table lacks 7#9");
+
+    ChordDictionary builtin;
+    int mismatches = 0;
+    for (int mask = 1; mask < 4096; ++mask) {
+        for (int bass = 0; bass < 12; ++bass) {
+            if (!(mask & (1 << bass))) continue;
+            for (int use_slash = 0; use_slash < 2; ++use_slash) {
+                PackedChordResult a = builtin.lookup(static_cast<uint16_t>(mask), bass, use_slash != 0);
+                PackedChordResult b = ChordDetector::lookup_chord(static_cast<uint16_t>(mask), bass, use_slash != 0);
+                if (std::memcmp(&a, &b, sizeof(a)) != 0) ++mismatches;
+            }
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Default dictionary matches built-in table");
+
+    // Dictionary-only vocabulary
+    ChordDictionary minimal({{(1<<0)|(1<<4)|(1<<7), "maj", 10}}, false);
+    result.assert_equal("1", std::to_string(minimal.size()), "Minimal dictionary size");
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    PackedChordResult packed = analyze_chord_fast(minimal, {64, 67, 72}, true);
+    result.assert_equal("Cmaj/E", std::string(format_chord(packed, minimal, buf, sizeof(buf))), "Minimal dictionary format");
+    result.assert_equal("", analyze_chord(minimal, {60, 63, 67}).full_name, "Minimal dictionary has no minor");
+    result.assert_bool(true, minimal.ok() && minimal.dropped() == 0, "Small dictionary reports no overflow");
+
+    // Vocabularies past the 16-bit id space keep their first patterns and report the rest
+    size_t room = ChordDictionary::MAX_PATTERNS - ChordDetector::NUM_PATTERNS;
+    std::vector<ChordDetector::ChordPattern> many(room + 3, {(1<<0)|(1<<2)|(1<<7), "x", 1});
+    ChordDictionary overflow(many, true, ChordDictionary::Mode::Cached);
+    result.assert_bool(false, overflow.ok(), "Oversized dictionary reports overflow");
+    result.assert_equal("3", std::to_string(overflow.dropped()), "Oversized dictionary counts dropped patterns");
+    result.assert_bool(true, overflow.size() == ChordDictionary::MAX_PATTERNS, "Oversized dictionary filled to capacity");
+    many.resize(room);
+    ChordDictionary full(many, true, ChordDictionary::Mode::Cached);
+    result.assert_bool(true, full.ok() && full.size() == ChordDictionary::MAX_PATTERNS, "Dictionary at capacity is ok");
+
+    // Priorities past the int16_t candidate range are clamped, so both modes still rank them first
+    ChordDetector::ChordPattern loud[] = {{(1<<0)|(1<<4)|(1<<7), "loud", 40000}};
+    ChordDictionary loud_table(loud, 1, true, ChordDictionary::Mode::Table);
+    ChordDictionary loud_cached(loud, 1, true, ChordDictionary::Mode::Cached);
+    result.assert_bool(false, loud_table.ok(), "Out-of-range priority reports an error");
+    result.assert_equal("1", std::to_string(loud_table.clamped()), "Out-of-range priority is counted");
+    result.assert_equal("Cloud", analyze_chord(loud_table, {60, 64, 67}).full_name, "Clamped priority wins in Table mode");
+    result.assert_equal("Cloud", analyze_chord(loud_cached, {60, 64, 67}).full_name, "Clamped priority wins in Cached mode");
+
+    // Out-of-range bass values are unmatched in both modes
+    PackedChordResult table_bass = loud_table.lookup(0x91, 12);
+    PackedChordResult cached_bass = loud_cached.lookup(0x91, 12);
+    result.assert_bool(true, std::memcmp(&table_bass, &cached_bass, sizeof(table_bass)) == 0 &&
+                       !(table_bass.flags & ChordDetector::CHORD_FLAG_MATCHED), "Out-of-range bass agrees across modes");
+}
+
+void test_parallel_analysis() {
+    std::cout << "\n--- Parallel Corpus Analysis ---" << std::endl;
+
+    // Uneven frame streams, some larger than FRAME_CHUNK
+    const size_t sizes[] = {10000, 3, 0, 5000, 1, 9000, 777};
+    std::vector<std::vector<uint16_t>> masks;
+    std::vector<std::vector<uint8_t>> basses;
+    std::vector<std::vector<PackedChordResult>> outputs;
+    unsigned seed = 99;
+    for (size_t size : sizes) {
+        std::vector<uint16_t> m(size);
+        std::vector<uint8_t> b(size);
+        for (size_t i = 0; i < size; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            m[i] = static_cast<uint16_t>((seed >> 8) & 0xFFF);
+            b[i] = static_cast<uint8_t>((seed >> 24) % 12);
+            m[i] |= static_cast<uint16_t>(1 << b[i]);
+        }
+        masks.push_back(std::move(m));
+        basses.push_back(std::move(b));
+        outputs.emplace_back(size);
+    }
+
+    std::vector<ChordDetector::FrameStream> frame_streams;
+    size_t total_frames = 0;
+    for (size_t s = 0; s < masks.size(); ++s) {
+        frame_streams.push_back({masks[s].data(), basses[s].data(), masks[s].size(), outputs[s].data()});
+        total_frames += masks[s].size();
+    }
+
+    ChordDetector::ParallelAnalyzer analyzer(4);
+    analyzer.analyze(frame_streams.data(), frame_streams.size(), true);
+
+    int mismatches = 0;
+    for (size_t s = 0; s < masks.size(); ++s) {
+        for (size_t i = 0; i < masks[s].size(); ++i) {
+            PackedChordResult expected = ChordDetector::lookup_chord(masks[s][i], basses[s][i], true);
+            if (std::memcmp(&expected, &outputs[s][i], sizeof(expected)) != 0) ++mismatches;
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Parallel frames match sequential lookup");
+    result.assert_equal(std::to_string(total_frames), std::to_string(analyzer.stats().frames), "Parallel frame counter");
+
+    // Note-event streams are tracked in order within each stream
+    std::vector<ChordDetector::NoteEventStream> event_streams;
+    std::vector<std::vector<NoteEvent>> events(6);
+    std::vector<std::vector<PackedChordResult>> event_outputs(6);
+    for (size_t s = 0; s < events.size(); ++s) {
+        for (int i = 0; i < 200 * static_cast<int>(s + 1); ++i) {
+            seed = seed * 1103515245u + 12345u;
+            events[s].push_back({static_cast<uint32_t>(i), static_cast<uint8_t>(48 + (seed >> 16) % 36), 0,
+                                 static_cast<uint8_t>((seed >> 8) & 1)});
+        }
+        event_outputs[s].resize(events[s].size());
+        event_streams.push_back({events[s].data(), events[s].size(), event_outputs[s].data()});
+    }
+    analyzer.analyze(event_streams.data(), event_streams.size());
+
+    mismatches = 0;
+    for (size_t s = 0; s < events.size(); ++s) {
+        ChordTracker tracker;
+        for (size_t i = 0; i < events[s].size(); ++i) {
+            tracker.apply(events[s][i]);
+            if (std::memcmp(&tracker.current(), &event_outputs[s][i], sizeof(PackedChordResult)) != 0) ++mismatches;
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Parallel note streams match sequential tracker");
+    result.assert_bool(true, analyzer.stats().items_per_second() > 0.0, "Parallel throughput reported");
+}
+
+// Minimal Standard MIDI File writer for reader tests
+struct SmfTrack {
+    std::vector<uint8_t> bytes;
+    uint8_t last_status = 0;
+
+    void delta(uint32_t ticks) {
+        uint8_t buf[4];
+        int n = 0;
+        buf[n++] = ticks & 0x7F;
+        while (ticks >>= 7) buf[n++] = static_cast<uint8_t>(0x80 | (ticks & 0x7F));
+        while (n) bytes.push_back(buf[--n]);
+    }
+
+    // Uses running status when the status byte repeats
+    void note(uint32_t ticks, int channel, int note, bool on) {
+        delta(ticks);
+        uint8_t status = static_cast<uint8_t>((on ? 0x90 : 0x80) | channel);
+        if (status != last_status) bytes.push_back(status);
+        last_status = status;
+        bytes.push_back(static_cast<uint8_t>(note));
+        bytes.push_back(on ? 100 : 0);
+    }
+
+    void meta_end(uint32_t ticks) {
+        delta(ticks);
+        bytes.insert(bytes.end(), {0xFF, 0x2F, 0x00});
+    }
+};
+
+std::vector<uint8_t> build_smf(const std::vector<SmfTrack>& tracks) {
+    std::vector<uint8_t> file = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, static_cast<uint8_t>(tracks.size()), 0x01, 0xE0};
+    for (const SmfTrack& track : tracks) {
+        size_t length = track.bytes.size();
+        file.insert(file.end(), {'M', 'T', 'r', 'k', static_cast<uint8_t>(length >> 24), static_cast<uint8_t>(length >> 16),
+                                 static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)});
+        file.insert(file.end(), track.bytes.begin(), track.bytes.end());
+    }
+    return file;
+}
+
+void test_midi_reader() {
+    std::cout << "\n--- Streaming MIDI Reader ---" << std::endl;
+
+    // Right hand C-E-G then B-D-F with the G held; left hand E, then G, then released
+    SmfTrack right, left, drums;
+    right.bytes.insert(right.bytes.end(), {0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20});  // Tempo meta event
+    right.note(0, 0, 72, true);
+    right.note(0, 0, 76, true);
+    right.note(0, 0, 79, true);
+    right.note(480, 0, 72, false);
+    right.note(0, 0, 76, false);
+    right.note(0, 0, 71, true);
+    right.note(0, 0, 74, true);
+    right.note(0, 0, 77, true);
+    right.meta_end(480);
+    left.note(0, 1, 52, true);
+    left.note(480, 1, 52, false);
+    left.note(0, 1, 55, true);
+    left.note(480, 1, 55, false);
+    left.meta_end(0);
+    drums.note(0, 9, 36, true);     // Kick on the percussion channel is ignored
+    drums.note(240, 9, 36, false);
+    drums.meta_end(0);
+    std::vector<uint8_t> smf = build_smf({right, left, drums});
+
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    ChordDetector::MidiChordReader reader(smf.data(), smf.size(), true);
+    result.assert_bool(true, reader.ok(), "MIDI reader opens buffer");
+    result.assert_equal("3", std::to_string(reader.track_count()), "MIDI track count");
+
+    std::string changes;
+    ChordDetector::ChordChange change;
+    while (reader.next(change)) {
+        changes += std::to_string(change.tick) + ":" + std::string(format_chord(change.chord, buf, sizeof(buf))) + " ";
+    }
+    result.assert_equal("0:C/E 480:G7 960:G7/B ", changes, "MIDI chord changes");
+
+    // Frames feed the batch API directly
+    ChordDetector::MidiChordReader frames_reader(smf.data(), smf.size(), true);
+    uint64_t ticks[8];
+    uint16_t masks[8];
+    uint8_t bass[8];
+    size_t frame_count = frames_reader.read_frames(ticks, masks, bass, 8);
+    PackedChordResult chords[8];
+    analyze_chords_batch(masks, bass, frame_count, chords, true);
+    result.assert_equal("3", std::to_string(frame_count), "MIDI frame count");
+    result.assert_equal("G7", std::string(format_chord(chords[1], buf, sizeof(buf))), "MIDI frame through batch");
+
+    // Raw note events in tick order, channel preserved, percussion still filtered
+    ChordDetector::MidiChordReader events_reader(smf.data(), smf.size(), true);
+    std::string events;
+    NoteEvent event;
+    int event_count = 0;
+    while (events_reader.next_event(event)) {
+        if (event_count++ < 5) {
+            events += std::to_string(event.tick) + ":" + std::to_string(event.note) + "/" +
+                      std::to_string(event.channel) + (event.on ? "+ " : "- ");
+        }
+    }
+    result.assert_equal("0:72/0+ 0:76/0+ 0:79/0+ 0:52/1+ 480:72/0- ", events, "MIDI raw note events");
+    result.assert_equal("12", std::to_string(event_count), "MIDI raw note event count");
+
+    SmfTrack slow;
+    slow.bytes.insert(slow.bytes.end(), {0x00, 0xFF, 0x51, 0x03, 0x09, 0x27, 0xC0});   // 600000 us per quarter
+    slow.note(0, 0, 60, true);
+    slow.note(480, 0, 60, false);
+    slow.meta_end(0);
+    std::vector<uint8_t> slow_smf = build_smf({slow});
+    ChordDetector::MidiChordReader tempo_reader(slow_smf.data(), slow_smf.size());
+    result.assert_equal("600000", std::to_string(tempo_reader.tempo()), "MIDI Set Tempo meta event");
+
+    // Chunked file reading across buffer boundaries
+    SmfTrack longer;
+    for (int bar = 0; bar < 300; ++bar) {
+        const int chord[] = {60, 64, 67};
+        for (int note : chord) longer.note(0, 0, note + (bar % 2) * 2, true);
+        for (int note : chord) longer.note(note == 60 ? 480 : 0, 0, note + (bar % 2) * 2, false);
+    }
+    longer.meta_end(0);
+    std::vector<uint8_t> long_smf = build_smf({longer});
+    const char* path = "chord_detector_test.mid";
+    std::FILE* file = std::fopen(path, "wb");
+    std::fwrite(long_smf.data(), 1, long_smf.size(), file);
+    std::fclose(file);
+
+    ChordDetector::MidiChordReader file_reader(path, false);
+    int change_count = 0, d_count = 0;
+    while (file_reader.next(change)) {
+        ++change_count;
+        if (std::string(format_chord(change.chord, buf, sizeof(buf))) == "D") ++d_count;
+    }
+    std::remove(path);
+    result.assert_bool(true, file_reader.ok(), "MIDI file reader ok");
+    result.assert_equal("301", std::to_string(change_count), "MIDI file chord changes");
+    result.assert_equal("150", std::to_string(d_count), "MIDI file D chords");
+
+    // Malformed input
+    const uint8_t garbage[] = {'R', 'I', 'F', 'F', 0, 0, 0, 0};
+    ChordDetector::MidiChordReader bad(garbage, sizeof(garbage));
+    result.assert_bool(false, bad.ok(), "MIDI reader rejects non-SMF");
+    result.assert_bool(false, bad.next(change), "MIDI reader yields nothing on error");
+    const uint8_t header_only[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0xFF, 0xFF, 0x01, 0xE0};
+    ChordDetector::MidiChordReader truncated(header_only, sizeof(header_only));
+    result.assert_equal("truncated file", std::string(truncated.error()), "MIDI reader rejects missing tracks");
+    result.assert_equal("0", std::to_string(truncated.track_count()), "MIDI reader keeps no phantom tracks");
+
+    // Meta and sysex events cancel running status, so a bare data byte after one is an error
+    for (uint8_t interrupt : {0xFF, 0xF0}) {
+        SmfTrack stale;
+        stale.note(0, 0, 60, true);
+        if (interrupt == 0xFF) stale.bytes.insert(stale.bytes.end(), {0x00, 0xFF, 0x01, 0x00});   // Empty text event
+        else stale.bytes.insert(stale.bytes.end(), {0x00, 0xF0, 0x01, 0xF7});                     // Empty sysex
+        stale.bytes.insert(stale.bytes.end(), {0x00, 64, 100});
+        stale.meta_end(0);
+        std::vector<uint8_t> stale_smf = build_smf({stale});
+        ChordDetector::MidiChordReader stale_reader(stale_smf.data(), stale_smf.size());
+        while (stale_reader.next(change)) {}
+        result.assert_equal("data byte without running status", std::string(stale_reader.error()),
+                            interrupt == 0xFF ? "MIDI meta event cancels running status" : "MIDI sysex cancels running status");
     }
 }
 
@@ -442,6 +1078,1001 @@ void test_new_chord_patterns() {
     result.assert_equal("Cm(add#11)", get_chord_name({60, 63, 66, 67}, false, true), "C-D#-F#-G with slash enabled");
 }
 
+void test_candidates() {
+    std::cout << "\n--- Candidate Ranking Tests ---" << std::endl;
+
+    // C-E-G-A: C6 in root position ranks first, Am7 over the C bass is an alternative reading
+    CandidateBuffer<8> candidates;
+    analyze_chord_candidates({60, 64, 67, 69}, candidates);
+    result.assert_bool(true, candidates.size() >= 2, "C6 has alternative readings");
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    result.assert_equal("C6", std::string(format_chord(to_packed_result(candidates[0]), buf, sizeof(buf))), "Top candidate is C6");
+    result.assert_bool(true, candidates[0].flags == ChordDetector::CHORD_FLAG_MATCHED, "Root-position candidate is not a slash reading");
+
+    bool found_am7 = false;
+    for (const ChordCandidate& candidate : candidates) {
+        if (std::string(format_chord(to_packed_result(candidate), buf, sizeof(buf))) == "Am7/C") {
+            found_am7 = (candidate.flags & ChordDetector::CHORD_FLAG_SLASH) != 0;
+        }
+    }
+    result.assert_bool(true, found_am7, "Am7/C is among the candidates");
+
+    bool ranked = true;
+    for (size_t i = 1; i < candidates.size(); ++i) ranked = ranked && candidates[i - 1].priority >= candidates[i].priority;
+    result.assert_bool(true, ranked, "Candidates are ranked by priority");
+
+    // Capacity 1 keeps only the best reading
+    CandidateBuffer<1> top;
+    analyze_chord_candidates({60, 64, 67, 69}, top);
+    result.assert_bool(true, top.size() == 1 && top[0].pattern_id == candidates[0].pattern_id, "Top-1 buffer keeps the best reading");
+
+    CandidateBuffer<8> none;
+    analyze_chord_candidates({60}, none);
+    result.assert_bool(true, none.empty(), "Single note has no candidates");
+    result.assert_bool(true, select_chord(none).pattern_id == ChordDetector::PATTERN_NONE, "Selecting from no candidates gives no chord");
+
+    // Selection over untruncated candidates matches analyze_chord_fast for every pitch-class set and bass
+    bool all_equal = true;
+    CandidateBuffer<64> all;
+    for (int mask = 1; mask < 4096 && all_equal; ++mask) {
+        for (int bass = 0; bass < 12; ++bass) {
+            if (!(mask & (1 << bass))) continue;
+            int notes[13];
+            int count = 0;
+            notes[count++] = 48 + bass;
+            for (int pc = 0; pc < 12; ++pc) {
+                if ((mask & (1 << pc)) && pc != bass) notes[count++] = 60 + pc;
+            }
+            analyze_chord_candidates(notes, count, all);
+            if (all.size() == all.CAPACITY) continue;
+            for (bool use_slash : {false, true}) {
+                PackedChordResult fast = analyze_chord_fast(notes, count, use_slash);
+                PackedChordResult selected = select_chord(all, use_slash);
+                // An empty buffer carries no bass, so only the match itself is compared there
+                all_equal = all_equal && (all.empty() ? selected.pattern_id == fast.pattern_id
+                                                      : std::memcmp(&fast, &selected, sizeof(fast)) == 0);
+            }
+        }
+    }
+    result.assert_bool(true, all_equal, "select_chord matches analyze_chord_fast exhaustively");
+}
+
+void test_multiple_translation_units() {
+    std::cout << "\n--- Multiple Translation Units ---" << std::endl;
+
+    result.assert_equal("G7/B G7 G7", chord_name_from_second_tu({71, 74, 77, 79}), "Header functions shared across TUs");
+    result.assert_bool(true, &ChordDetector::lookup_table() == lookup_table_from_second_tu(), "One lookup table per process");
+}
+
+void test_name_pool() {
+    std::cout << "\n--- Interned Name Pool ---" << std::endl;
+
+    result.assert_equal("G7/B", std::string(get_chord_name_view({71, 74, 77, 79}, false, true)), "G7/B from the pool");
+    result.assert_equal("Gb7/Bb", std::string(get_chord_name_view({70, 73, 76, 78}, true, true)), "Gb7/Bb from the pool (flat)");
+    result.assert_equal("", std::string(get_chord_name_view({60})), "Single note has no pooled name");
+
+    // Views point into one pool that never moves
+    std::string_view first = get_chord_name_view({60, 64, 67});
+    std::string_view second = get_chord_name_view({48, 52, 55});
+    result.assert_bool(true, first.data() == second.data(), "Same chord gives the same pooled string");
+    result.assert_bool(true, first.data()[first.size()] == '\0', "Pooled names are NUL-terminated");
+
+    const ChordDetector::NamePool& pool = ChordDetector::name_pool();
+    PackedChordResult g7_b = analyze_chord_fast({71, 74, 77, 79}, true);
+    result.assert_equal("G7", std::string(pool.chord_name(g7_b)), "Pooled chord part");
+    result.assert_equal("G7/B", pool.c_str(g7_b), "Pooled C string");
+
+    // A pool over a custom vocabulary
+    ChordDictionary quartal = {{(1 << 0) | (1 << 5) | (1 << 10), "quartal", 50}};
+    ChordDetector::NamePool custom(quartal.pattern_set());
+    result.assert_equal("Dquartal", std::string(custom.full_name(analyze_chord_fast(quartal, {62, 67, 72}))),
+                        "Dictionary name pool");
+
+    // Names longer than CHORD_NAME_CAPACITY are pooled in full, with and without a slash bass
+    ChordDictionary verbose = {{(1 << 0) | (1 << 1) | (1 << 2), "cluster-stack-with-a-very-long-name", 50}};
+    ChordDetector::NamePool verbose_pool(verbose.pattern_set());
+    PackedChordResult verbose_slash = analyze_chord_fast(verbose, {51, 62, 64}, true);     // D cluster over Eb
+    result.assert_equal(analyze_chord(verbose, {62, 63, 64}).full_name,
+                        std::string(verbose_pool.full_name(analyze_chord_fast(verbose, {62, 63, 64}))), "Long dictionary name pooled");
+    result.assert_equal(analyze_chord(verbose, {51, 62, 64}, false, true).full_name, verbose_pool.c_str(verbose_slash),
+                        "Long slash name pooled");
+    result.assert_equal("Dcluster-stack-with-a-very-long-name", std::string(verbose_pool.chord_name(verbose_slash)),
+                        "Long chord part pooled");
+}
+
+void test_chroma_input() {
+    std::cout << "\n--- Chroma Input ---" << std::endl;
+
+    ChordDetector::ChromaOptions options;
+    options.use_slash = true;
+    ChordDetector::ChromaChordDetector detector(options);
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+
+    auto profile = [](std::initializer_list<int> pitch_classes, float noise) {
+        std::array<float, 12> chroma;
+        chroma.fill(noise);
+        for (int pc : pitch_classes) chroma[pc] = 1.0f;
+        return chroma;
+    };
+    auto name_of = [&](const PackedChordResult& chord) { return std::string(format_chord(chord, buf, sizeof(buf))); };
+    auto bass = [](int pc) {
+        std::array<float, 12> chroma{};
+        chroma[pc] = 1.0f;
+        return chroma;
+    };
+
+    std::array<float, 12> c_major = profile({0, 4, 7}, 0.0f);
+    result.assert_equal("C", std::string(format_chord(detector.analyze(c_major.data()), buf, sizeof(buf))), "C major chroma");
+
+    std::array<float, 12> noisy = profile({7, 11, 2, 5}, 0.1f);
+    result.assert_equal("G7", std::string(format_chord(detector.analyze(noisy.data()), buf, sizeof(buf))), "G7 chroma with noise");
+
+    std::array<float, 12> e_bass = bass(4);
+    result.assert_equal("C/E", std::string(format_chord(detector.analyze(c_major.data(), e_bass.data()), buf, sizeof(buf))),
+                        "C/E from bass chroma");
+
+    // Same pitch classes, the bass decides like the MIDI path does
+    std::array<float, 12> c6 = profile({0, 4, 7, 9}, 0.0f);
+    std::array<float, 12> c_bass = bass(0), a_bass = bass(9);
+    result.assert_equal("C6", std::string(format_chord(detector.analyze(c6.data(), c_bass.data()), buf, sizeof(buf))),
+                        "C6 with C bass");
+    result.assert_equal("Am7", std::string(format_chord(detector.analyze(c6.data(), a_bass.data()), buf, sizeof(buf))),
+                        "Am7 with A bass");
+
+    float similarity = 0.0f;
+    detector.analyze(c_major.data(), nullptr, &similarity);
+    result.assert_bool(true, similarity > 0.99f, "Exact template scores ~1");
+
+    ScoredChord ranked[4];
+    size_t ranked_count = detector.analyze_candidates(c6.data(), c_bass.data(), ranked, 4);
+    result.assert_bool(true, ranked_count >= 2 && name_of(ranked[0].chord) == "C6" && ranked[0].score >= ranked[1].score,
+                       "Chroma candidates ranked, best first");
+
+    std::array<float, 12> silence{};
+    result.assert_bool(true, detector.analyze(silence.data()).pattern_id == ChordDetector::PATTERN_NONE, "Silence has no chord");
+
+    // Block API over an interleaved feature matrix (stride 16) agrees with single frames
+    const std::array<float, 12>* frames[] = {&c_major, &noisy, &c6, &silence};
+    std::vector<float> matrix(4 * 16, 0.0f), bass_matrix(4 * 16, 0.0f);
+    for (int f = 0; f < 4; ++f) {
+        std::copy(frames[f]->begin(), frames[f]->end(), matrix.begin() + f * 16);
+        bass_matrix[f * 16 + 9] = 1.0f;
+    }
+    PackedChordResult out[4];
+    detector.analyze_block(matrix.data(), bass_matrix.data(), 4, 16, out);
+    bool block_matches = true;
+    for (int f = 0; f < 4; ++f) {
+        PackedChordResult single = detector.analyze(matrix.data() + f * 16, bass_matrix.data() + f * 16);
+        block_matches = block_matches && std::memcmp(&single, &out[f], sizeof(single)) == 0;
+    }
+    result.assert_bool(true, block_matches, "Block API matches frame-by-frame analysis");
+
+    // Random frames, some silent
+    unsigned seed = 17;
+    auto level = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<float>((seed >> 16) & 0x7FFF) / 32767.0f;
+    };
+    const size_t random_count = 37;
+    std::vector<float> random_frames(random_count * 12), random_bass(random_count * 12);
+    for (float& bin : random_frames) bin = level() < 0.6f ? 0.0f : level();
+    for (float& bin : random_bass) bin = level();
+    std::fill(random_frames.begin() + 5 * 12, random_frames.begin() + 6 * 12, 0.0f);
+    std::vector<PackedChordResult> random_out(random_count);
+    detector.analyze_block(random_frames.data(), random_bass.data(), random_count, 12, random_out.data());
+    int random_mismatches = 0;
+    for (size_t f = 0; f < random_count; ++f) {
+        PackedChordResult single = detector.analyze(random_frames.data() + f * 12, random_bass.data() + f * 12);
+        random_mismatches += std::memcmp(&single, &random_out[f], sizeof(single)) != 0;
+    }
+    result.assert_equal("0", std::to_string(random_mismatches), "Block API matches random frames");
+}
+
+void test_sequence_decoder() {
+    std::cout << "\n--- Sequence Decoder ---" << std::endl;
+
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    auto name = [&](const PackedChordResult& chord) { return std::string(format_chord(chord, buf, sizeof(buf))); };
+    auto segments_of = [&](const std::vector<std::vector<int>>& frames, bool use_slash, ChordDetector::ChordSequenceDecoder& decoder) {
+        std::string log;
+        ChordDetector::ChordSegment segment;
+        CandidateBuffer<8> candidates;
+        for (const std::vector<int>& notes : frames) {
+            analyze_chord_candidates(notes, candidates);
+            if (decoder.push(candidates, use_slash, segment)) log += std::to_string(segment.start_frame) + ":" + name(segment.chord) + " ";
+        }
+        while (decoder.flush(segment)) log += std::to_string(segment.start_frame) + ":" + name(segment.chord) + " ";
+        return log;
+    };
+
+    // A passing E in the bass and a passing D would flicker frame by frame: C, C/E, Cadd9, C, G
+    std::vector<std::vector<int>> frames;
+    for (int i = 0; i < 10; ++i) {
+        if (i == 4) frames.push_back({52, 60, 67});             // C/E
+        else if (i == 6) frames.push_back({48, 62, 64, 67});    // Cadd9
+        else frames.push_back({48, 64, 67});
+    }
+    for (int i = 0; i < 10; ++i) frames.push_back({43, 59, 62});
+
+    std::string raw;
+    for (const std::vector<int>& notes : frames) raw += name(analyze_chord_fast(notes, true)) + " ";
+    result.assert_bool(true, raw.find("C/E") != std::string::npos && raw.find("Cadd9") != std::string::npos,
+                       "Frame-by-frame readings flicker");
+
+    ChordDetector::ChordSequenceDecoder decoder;
+    result.assert_equal("0:C 10:G ", segments_of(frames, true, decoder), "Decoder emits stable segments");
+    result.assert_equal("20", std::to_string(decoder.committed_frames()), "Every frame committed after flush");
+
+    // Without a change penalty the decoder follows the frame-wise best reading
+    ChordDetector::SequenceOptions eager;
+    eager.change_penalty = 0.0f;
+    eager.lag = 0;
+    ChordDetector::ChordSequenceDecoder follower(eager);
+    result.assert_equal("0:C 4:C/E 5:C 6:Cadd9 7:C 10:G ", segments_of(frames, true, follower), "Zero penalty follows the frames");
+
+    // Commits wait for the lag window
+    ChordDetector::SequenceOptions lagged;
+    lagged.lag = 3;
+    ChordDetector::ChordSequenceDecoder delayed(lagged);
+    ScoredChord c_major = {analyze_chord_fast({48, 64, 67}), 1.0f};
+    bool early = false;
+    for (int i = 0; i < 3; ++i) early = early || delayed.push(&c_major, 1);
+    result.assert_bool(false, early, "Nothing committed inside the lag window");
+    result.assert_bool(true, delayed.push(&c_major, 1), "First frame committed after lag frames");
+
+    // Silence is a state of its own, and state memory stays bounded with many distinct chords
+    ChordDetector::ChordSequenceDecoder bounded;
+    ChordDetector::ChordSegment segment = {};
+    size_t segments = 0;
+    for (int i = 0; i < 200; ++i) {
+        ScoredChord chord = {analyze_chord_fast({36 + i % 40, 40 + i % 40, 43 + i % 40, 47 + (i / 40) % 3}), 1.0f};
+        for (int repeat = 0; repeat < 3; ++repeat) segments += bounded.push(&chord, 1, segment);
+    }
+    for (int i = 0; i < 20; ++i) segments += bounded.push(nullptr, 0, segment);
+    while (bounded.flush(segment)) ++segments;
+    result.assert_bool(true, segment.chord.pattern_id == ChordDetector::PATTERN_NONE, "Trailing silence decoded as no chord");
+    result.assert_bool(true, segments > 20 && segments <= 201, "Many distinct chords decode within bounded state");
+
+    // A new chord that replaces the previous best state still enters from that state's previous-frame score
+    ScoredChord full[ChordDetector::ChordSequenceDecoder::MAX_STATES];
+    for (int i = 0; i < 16; ++i) full[i] = {analyze_chord_fast({48 + i, 52 + i - (i >= 12), 55 + i}), i == 0 ? 10.0f : 0.0f};
+    ScoredChord next[16];
+    for (int i = 0; i < 15; ++i) next[i] = full[i + 1];
+    next[15] = {analyze_chord_fast({48, 51, 54}), 5.0f};     // Cdim
+    ChordDetector::ChordSequenceDecoder replaced;
+    std::string replaced_log;
+    if (replaced.push(full, 16, segment)) replaced_log += name(segment.chord) + " ";
+    if (replaced.push(next, 16, segment)) replaced_log += name(segment.chord) + " ";
+    while (replaced.flush(segment)) replaced_log += std::to_string(segment.start_frame) + ":" + name(segment.chord) + " ";
+    result.assert_equal("0:C 1:Cdim ", replaced_log, "Replaced best state keeps its predecessor score");
+}
+
+
+void test_stats() {
+    std::cout << "\n--- Stats Counters ---" << std::endl;
+    using ChordDetector::Counter;
+
+    // Counts of the calling thread made by f
+    auto delta = [](auto&& f) {
+        ChordDetector::Stats before = ChordDetector::thread_stats();
+        f();
+        ChordDetector::Stats after = ChordDetector::thread_stats();
+        after -= before;
+        return after;
+    };
+    auto expect = [](uint64_t enabled_count) { return ChordDetector::STATS_ENABLED ? enabled_count : 0; };
+
+    ChordDetector::Stats fast = delta([] { analyze_chord_fast({60, 64, 67}); });
+    result.assert_bool(true, fast[Counter::AnalyzeChordFast] == expect(1) && fast[Counter::TableLookups] == expect(1),
+                       "analyze_chord_fast counts one call and one table lookup");
+
+    ChordDetector::Stats wrapped = delta([] { analyze_chord({60, 64, 67}); });
+    result.assert_bool(true, wrapped[Counter::AnalyzeChord] == expect(1) && wrapped[Counter::AnalyzeChordFast] == expect(1),
+                       "analyze_chord also counts its analyze_chord_fast call");
+
+    // C/E over the reference scan: 3 roots in the main pass, 2 in the slash pass, each scanning every pattern
+    ChordDetector::Stats reference = delta([] {
+        int notes[] = {64, 67, 72};
+        ChordDetector::analyze_chord_reference(notes, 3, false, true);
+    });
+    result.assert_bool(true, reference[Counter::ReferenceCalls] == expect(1) && reference[Counter::RootsPassed] == expect(5) &&
+                       reference[Counter::PatternCompares] == expect(5 * ChordDetector::NUM_PATTERNS),
+                       "Reference scan counts roots and pattern compares");
+
+    // E-C dyad: no root-position reading, so slash analysis overrides the weak winner
+    ChordDetector::Stats override_reference = delta([] {
+        int notes[] = {64, 72};
+        ChordDetector::analyze_chord_reference(notes, 2, false, true);
+    });
+    ChordDetector::Stats override_select = delta([] {
+        CandidateBuffer<8> candidates;
+        analyze_chord_candidates({64, 72}, candidates);
+        select_chord(candidates, true);
+    });
+    result.assert_bool(true, override_reference[Counter::SlashOverrides] == expect(1) &&
+                       override_select[Counter::SlashOverrides] == expect(1) &&
+                       override_select[Counter::AnalyzeChordCandidates] == expect(1),
+                       "Slash overrides counted by both engines");
+    result.assert_equal("0", std::to_string(delta([] { select_chord(CandidateBuffer<8>(), true); })[Counter::SlashOverrides]),
+                        "No override without candidates");
+
+    ChordDetector::Stats batch = delta([] {
+        uint16_t masks[3] = {0x091, 0x091, 0x891};
+        uint8_t bass[3] = {0, 4, 0};
+        PackedChordResult out[3];
+        analyze_chords_batch(masks, bass, 3, out);
+    });
+    result.assert_bool(true, batch[Counter::BatchCalls] == expect(1) && batch[Counter::BatchChords] == expect(3) &&
+                       batch[Counter::TableLookups] == expect(3),
+                       "Batch counts calls, chords and lookups");
+
+    // Tracker: second C only re-confirms the held pitch-class set and bass
+    ChordDetector::Stats tracker = delta([] {
+        ChordTracker chord_tracker;
+        chord_tracker.note_on(60);
+        chord_tracker.note_on(72);
+        chord_tracker.note_on(64);
+    });
+    result.assert_bool(true, tracker[Counter::TrackerHits] == expect(1) && tracker[Counter::TrackerMisses] == expect(2),
+                       "Tracker hits and misses");
+
+    // Building a table is not traffic
+    ChordDetector::Stats build = delta([] {
+        ChordDetector::ChordPattern extra[] = {{(1 << 0) | (1 << 7), "5", 40}};
+        ChordDictionary dictionary(extra, 1);
+    });
+    result.assert_equal("0", std::to_string(build[Counter::PatternCompares]), "Table construction is not counted");
+
+    // Other threads' counters are included, also after they exit
+    ChordDetector::reset_stats();
+    std::thread worker([] {
+        for (int i = 0; i < 10; ++i) analyze_chord_fast({62, 65, 69});
+    });
+    worker.join();
+    analyze_chord_fast({60, 64, 67});
+    result.assert_equal(std::to_string(expect(11)), std::to_string(ChordDetector::stats()[Counter::AnalyzeChordFast]),
+                        "stats() aggregates all threads since reset_stats()");
+    result.assert_equal("tracker_misses", ChordDetector::counter_name(Counter::TrackerMisses), "Counter names");
+}
+
+void test_memo_cache() {
+    std::cout << "\n--- Memo Cache ---" << std::endl;
+    using ChordDetector::Counter;
+
+    // One set of two entries: least recently used is evicted
+    ChordDetector::MemoCache<1> cache;
+    PackedChordResult c = {0, 0, 1, ChordDetector::CHORD_FLAG_MATCHED}, e = {4, 4, 2, ChordDetector::CHORD_FLAG_MATCHED};
+    PackedChordResult found;
+    result.assert_bool(false, cache.find(0, 0x091, 0, false, found), "Empty cache misses");
+    cache.insert(0, 0x091, 0, false, c);
+    cache.insert(0, 0x890, 4, false, e);
+    result.assert_bool(true, cache.find(0, 0x091, 0, false, found) && found.pattern_id == 1, "Older entry still cached");
+    result.assert_bool(false, cache.find(1, 0x091, 0, false, found) || cache.find(0, 0x091, 0, true, found),
+                       "Owner and use_slash are part of the key");
+    cache.insert(0, 0x0A5, 2, false, c);    // Evicts 0x890, the least recently used
+    result.assert_bool(true, cache.find(0, 0x091, 0, false, found) && !cache.find(0, 0x890, 4, false, found),
+                       "LRU eviction");
+
+    ChordDetector::ChordPattern extra[] = {{(1<<0)|(1<<3)|(1<<4)|(1<<7)|(1<<10), "7#9", 82},
+                                           {(1<<0)|(1<<5)|(1<<10), "quartal", 50}};
+    ChordDictionary table(extra, 2);
+    ChordDictionary cached(extra, 2, true, ChordDictionary::Mode::Cached);
+    result.assert_bool(false, cached.tabulated() || cached.table().data(false) != nullptr, "Cached dictionary builds no table");
+
+    int mismatches = 0;
+    for (int mask = 0; mask < 4096; ++mask) {
+        for (int bass = 0; bass < 12; ++bass) {
+            for (int use_slash = 0; use_slash < 2; ++use_slash) {
+                PackedChordResult a = table.lookup(static_cast<uint16_t>(mask), bass, use_slash != 0);
+                PackedChordResult b = cached.lookup(static_cast<uint16_t>(mask), bass, use_slash != 0);
+                if (std::memcmp(&a, &b, sizeof(a)) != 0) ++mismatches;
+            }
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Cached dictionary matches its table counterpart");
+    result.assert_equal("E7#9", analyze_chord(cached, {64, 68, 71, 74, 79}).full_name, "Cached dictionary analysis");
+
+    analyze_chord_fast(cached, {62, 67, 72});
+    ChordDetector::Stats before = ChordDetector::thread_stats();
+    for (int i = 0; i < 3; ++i) analyze_chord_fast(cached, {62, 67, 72});
+    ChordDetector::Stats after = ChordDetector::thread_stats();
+    after -= before;
+    uint64_t hits = ChordDetector::STATS_ENABLED ? 3 : 0;
+    result.assert_equal(std::to_string(hits), std::to_string(after[Counter::MemoHits]), "Repeated voicing hits the memo cache");
+
+    uint16_t masks[3] = {0x091, 0x489, 0x091};
+    uint8_t bass[3] = {4, 3, 200};
+    PackedChordResult expected[3], actual[3];
+    analyze_chords_batch(table, masks, bass, 3, expected, true);
+    analyze_chords_batch(cached, masks, bass, 3, actual, true);
+    result.assert_bool(true, std::memcmp(expected, actual, sizeof(expected)) == 0, "Cached dictionary batch");
+
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    ChordTracker tracker(cached, true);
+    tracker.note_on(64);
+    tracker.note_on(68);
+    tracker.note_on(71);
+    tracker.note_on(74);
+    tracker.note_on(79);
+    result.assert_equal("E7#9", std::string(format_chord(tracker.current(), cached, buf, sizeof(buf))),
+                        "Tracker over a cached dictionary");
+
+    ChordDetector::ParallelAnalyzer analyzer(2, &cached);
+    PackedChordResult out[3];
+    ChordDetector::FrameStream stream = {masks, bass, 3, out};
+    analyzer.analyze(&stream, 1, true);
+    result.assert_bool(true, std::memcmp(expected, out, sizeof(out)) == 0, "Parallel analysis over a cached dictionary");
+}
+
+void test_progression_analysis() {
+    std::cout << "\n--- Progression Analysis ---" << std::endl;
+    using ChordDetector::Key;
+    using ChordDetector::KeyMode;
+
+    // ii7 - V65 - I in C, then a borrowed bVII
+    ChordDetector::ProgressionAnalyzer progression({0, KeyMode::Major});
+    ChordDetector::ProgressionStep step;
+    std::vector<std::vector<int>> voicings = {{62, 65, 69, 72}, {59, 65, 67, 74}, {60, 64, 67}, {58, 65, 70, 74}};
+    std::string romans, motions;
+    for (const std::vector<int>& notes : voicings) {
+        progression.push(analyze_chord_fast(notes, true), notes.data(), static_cast<int>(notes.size()), step);
+        romans += std::string(step.roman) + " ";
+        motions += std::to_string(step.root_motion) + " ";
+    }
+    result.assert_equal("ii7 V65 I bVII ", romans, "Roman numerals in C major");
+    result.assert_equal("-1 5 5 10 ", motions, "Root motion in ascending semitones");
+
+    // C -> F/C -> G/B: 0+1+2, then 1+3+2 semitones
+    progression.reset();
+    std::string movement;
+    for (std::vector<int> notes : {std::vector<int>{60, 64, 67}, {60, 65, 69}, {59, 62, 67}}) {
+        progression.push(analyze_chord_fast(notes, true), notes.data(), static_cast<int>(notes.size()), step);
+        movement += std::to_string(step.voice_leading) + " ";
+    }
+    result.assert_equal("-1 3 6 ", movement, "Voice-leading distance");
+    result.assert_equal("1st", inversion_name(step.inversion), "Progression inversion");
+    result.assert_equal("3", std::to_string(step.interval_count), "Progression interval count");
+    result.assert_bool(true, step.intervals_from_root[1] == 4 && step.interval_mask == 0x091, "Progression intervals from root");
+
+    // Voices may split: one note to a doubled octave costs both moves
+    uint8_t single[] = {60};
+    uint8_t octave[] = {60, 72};
+    result.assert_equal("12", std::to_string(ChordDetector::voice_leading_distance(single, 1, octave, 2)), "Voice splitting");
+    result.assert_equal("-1", std::to_string(ChordDetector::voice_leading_distance(single, 1, octave, 0)), "Empty voicing");
+
+    // A minor: natural-minor degrees, raised leading tone, qualities
+    char buf[ChordDetector::ROMAN_CAPACITY];
+    Key a_minor = {9, KeyMode::Minor};
+    auto roman = [&](std::initializer_list<int> notes, const Key& key) {
+        ChordDetector::roman_numeral(analyze_chord_fast(notes, true), key, buf, sizeof(buf));
+        return std::string(buf);
+    };
+    result.assert_equal("V7", roman({64, 68, 71, 74}, a_minor), "Minor key V7");
+    result.assert_equal("VII", roman({67, 71, 74}, a_minor), "Minor key VII");
+    result.assert_equal("#viio", roman({68, 71, 74}, a_minor), "Minor key leading-tone diminished");
+    result.assert_equal("ii\xC3\xB8" "7", roman({71, 74, 77, 81}, a_minor), "Half-diminished");
+    result.assert_equal("III+", roman({60, 64, 68}, a_minor), "Augmented");
+    result.assert_equal("IM7", roman({60, 64, 67, 71}, {0, KeyMode::Major}), "Major seventh");
+    result.assert_equal("I64", roman({67, 72, 76}, {0, KeyMode::Major}), "Second inversion triad");
+    result.assert_equal("", roman({60}, a_minor), "Unmatched has no numeral");
+    ChordDetector::roman_numeral(analyze_chord_fast({62, 65, 69, 72}, true), {0, KeyMode::Major}, buf, 3);
+    result.assert_equal("ii", std::string(buf), "Roman numeral truncated");
+
+    // The string inversion API is the enum's name
+    result.assert_equal(inversion_name(get_inversion(analyze_chord({64, 67, 72}, false, true))),
+                        get_inversion_type(analyze_chord({64, 67, 72}, false, true)), "get_inversion_type matches get_inversion");
+
+    // Batch form over the analyze_chords_batch layout continues the stream
+    int notes[] = {65, 69, 72, 67, 71, 74, 77, 60, 64, 67};
+    size_t offsets[] = {0, 3, 7, 10};
+    PackedChordResult chords[3];
+    ChordDetector::ProgressionStep steps[3];
+    analyze_chords_batch(notes, offsets, 3, chords, true);
+    ChordDetector::ProgressionAnalyzer batch({0, KeyMode::Major});
+    batch.push(chords, notes, offsets, 3, steps);
+    result.assert_equal("IV V7 I", std::string(steps[0].roman) + " " + steps[1].roman + " " + steps[2].roman, "Batch progression");
+}
+
+void test_key_estimation() {
+    std::cout << "\n--- Key Estimation ---" << std::endl;
+    using ChordDetector::Key;
+    using ChordDetector::KeyMode;
+
+    // Block chords, one per beat at 480 ticks, each released before the next
+    auto play = [](ChordDetector::ChordKeyTracker& tracker, const std::vector<std::vector<int>>& chords, uint32_t& tick) {
+        for (const std::vector<int>& chord : chords) {
+            for (int note : chord) tracker.apply({tick, static_cast<uint8_t>(note), 0, 1});
+            tick += 480;
+            for (int note : chord) tracker.apply({tick, static_cast<uint8_t>(note), 0, 0});
+        }
+    };
+    auto key_name = [](const Key& key) {
+        return std::string(ChordDetector::NOTE_NAMES_SHARP[key.tonic_pc]) + (key.mode == KeyMode::Minor ? "m" : "");
+    };
+
+    ChordDetector::ChordKeyTracker tracker(true);
+    uint32_t tick = 0;
+    result.assert_equal("C", key_name(tracker.key()), "No data: default key");
+
+    // I - IV - V7 - I in Bb: spelled with flats once the key is detected
+    std::vector<std::vector<int>> b_flat = {{58, 62, 65}, {63, 67, 70}, {65, 69, 72, 75}, {58, 62, 65}};
+    for (int bar = 0; bar < 4; ++bar) play(tracker, b_flat, tick);
+    result.assert_equal("A#", key_name(tracker.key()), "Bb major detected");
+    result.assert_bool(true, tracker.use_flats(), "Bb major spells with flats");
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    tracker.apply({tick, 62, 0, 1});
+    tracker.apply({tick, 65, 0, 1});
+    tracker.apply({tick, 70, 0, 1});
+    result.assert_equal("Bb/D", std::string(tracker.chord_name(buf, sizeof(buf))), "Chord spelled in the detected key");
+    for (int note : {62, 65, 70}) tracker.apply({tick + 480, static_cast<uint8_t>(note), 0, 0});
+    tick += 480;
+
+    // Modulation to E major: the window slides past the Bb material
+    std::vector<std::vector<int>> e_major = {{64, 68, 71}, {69, 73, 76}, {71, 75, 78, 81}, {64, 68, 71}};
+    for (int bar = 0; bar < 8; ++bar) play(tracker, e_major, tick);
+    result.assert_equal("E", key_name(tracker.key()), "Modulation to E major");
+    result.assert_bool(false, tracker.use_flats(), "E major spells with sharps");
+    result.assert_bool(true, tracker.keys().correlation() > 0.5, "Strong correlation with the profile");
+
+    // i - iv - V7 - i in A minor
+    tracker.reset();
+    tick = 0;
+    std::vector<std::vector<int>> a_minor = {{57, 60, 64}, {62, 65, 69}, {64, 68, 71, 74}, {57, 60, 64}};
+    for (int bar = 0; bar < 4; ++bar) play(tracker, a_minor, tick);
+    result.assert_equal("Am", key_name(tracker.key()), "A minor detected");
+
+    // Histogram is duration-weighted and slides back to empty after a long silence
+    ChordDetector::KeyEstimator estimator({960, 4});
+    uint16_t counts[12] = {};
+    counts[0] = 2;
+    estimator.advance(0, counts);
+    estimator.advance(100, counts);
+    result.assert_equal("200", std::to_string(estimator.histogram()[0]), "Duration-weighted counts");
+    counts[0] = 0;
+    estimator.advance(1000000, counts);
+    result.assert_equal("0", std::to_string(estimator.histogram()[0]), "Window slides out");
+    result.assert_bool(true, ChordDetector::key_uses_flats({2, KeyMode::Minor}) && !ChordDetector::key_uses_flats({4, KeyMode::Minor}),
+                       "Minor key signatures");
+}
+
+void test_realtime_mode() {
+    std::cout << "\n--- Real-Time Mode ---" << std::endl;
+
+    result.assert_bool(true, prepare_realtime() > 0, "prepare_realtime touches the tables");
+
+    int notes[] = {64, 67, 72};
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+    result.assert_equal("C", std::string(format_chord(analyze_chord_realtime(notes, 3), buf, sizeof(buf))), "Real-time C major");
+    result.assert_equal("C/E", std::string(format_chord(analyze_chord_realtime(notes, 3, true), buf, sizeof(buf))),
+                        "Real-time slash chord");
+    std::array<int, 4> seventh = {43, 59, 62, 65};
+    result.assert_equal("G7", std::string(format_chord(analyze_chord_realtime(seventh), buf, sizeof(buf))), "Real-time std::array");
+
+    PackedChordResult empty = analyze_chord_realtime(nullptr, 0);
+    result.assert_bool(true, empty.bass_pc == ChordDetector::NO_PITCH_CLASS && !(empty.flags & ChordDetector::CHORD_FLAG_MATCHED),
+                       "Real-time empty input");
+    int invalid[] = {-5, 128, 300};
+    PackedChordResult none = analyze_chord_realtime(invalid, 3, true);
+    result.assert_bool(true, none.bass_pc == ChordDetector::NO_PITCH_CLASS && none.root_pc == ChordDetector::NO_PITCH_CLASS,
+                       "Real-time ignores invalid notes");
+    result.assert_bool(true, analyze_chord_realtime(notes, -1).bass_pc == ChordDetector::NO_PITCH_CLASS,
+                       "Real-time negative count");
+
+    // Same result as analyze_chord_fast on random voicings, invalid notes and counts past the slot limit included
+    int mismatches = 0;
+    uint32_t seed = 12345;
+    auto next = [&seed] {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+    int voicing[24];
+    for (int trial = 0; trial < 20000; ++trial) {
+        int count = static_cast<int>(next() % 21);
+        for (int i = 0; i < count; ++i) voicing[i] = static_cast<int>(next() % 140) - 6;
+        int limited = count < ChordDetector::REALTIME_MAX_NOTES ? count : ChordDetector::REALTIME_MAX_NOTES;
+        for (int use_slash = 0; use_slash < 2; ++use_slash) {
+            PackedChordResult a = analyze_chord_fast(voicing, limited, use_slash != 0);
+            PackedChordResult b = analyze_chord_realtime(voicing, count, use_slash != 0);
+            if (std::memcmp(&a, &b, sizeof(a)) != 0) ++mismatches;
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Real-time matches analyze_chord_fast");
+
+    int triad[] = {52, 55, 60};
+    uint16_t mask;
+    uint8_t bass = ChordDetector::realtime_voicing(triad, 3, mask);
+    result.assert_bool(true, mask == 0x091, "Real-time voicing mask");
+    result.assert_equal("4", std::to_string(bass), "Real-time voicing bass");
+}
+
+void test_tolerant_matching() {
+    std::cout << "\n--- Tolerant Matching ---" << std::endl;
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+
+    // C7 with a passing A: no exact pattern, one removal away from C7
+    ChordDetector::TolerantChord passing = analyze_chord_tolerant({60, 64, 67, 69, 70});
+    result.assert_equal("", std::string(format_chord(analyze_chord_fast({60, 64, 67, 69, 70}), buf, sizeof(buf))),
+                        "Passing tone defeats exact matching");
+    result.assert_equal("C7", std::string(format_chord(passing.chord, buf, sizeof(buf))), "Tolerant reading ignores the passing tone");
+    result.assert_bool(true, passing.distance == 1 && passing.extra == (1 << 9) && passing.missing == 0, "Passing tone reported as extra");
+
+    ChordDetector::TolerantChord exact = analyze_chord_tolerant({64, 67, 72}, true);
+    result.assert_equal("C/E", std::string(format_chord(exact.chord, buf, sizeof(buf))), "Exact match wins");
+    result.assert_bool(true, exact.distance == 0 && exact.extra == 0 && exact.missing == 0, "Exact match has no edits");
+    result.assert_bool(true, analyze_chord_tolerant({60, 64, 67, 69, 70}, false, 0).chord.pattern_id == ChordDetector::PATTERN_NONE,
+                       "Distance 0 is exact matching");
+    result.assert_bool(true, analyze_chord_tolerant(std::vector<int>()).chord.bass_pc == ChordDetector::NO_PITCH_CLASS,
+                       "Tolerant empty input");
+
+    // The shared neighbor tables agree with probing, and with exact matching wherever that matches
+    const ChordDetector::LookupTable& table = ChordDetector::lookup_table();
+    int mismatches = 0, inexact = 0;
+    for (int distance = 1; distance <= 2; ++distance) {
+        ChordDetector::ToleranceOptions options;
+        options.max_distance = distance;
+        const ChordDetector::ToleranceTable& neighbors = ChordDetector::tolerance_table(distance);
+        for (int mask = 1; mask < 4096; ++mask) {
+            for (int bass = 0; bass < 12; ++bass) {
+                if (!(mask & (1 << bass))) continue;
+                for (int use_slash = 0; use_slash < 2; ++use_slash) {
+                    ChordDetector::TolerantChord a = neighbors.find(static_cast<uint16_t>(mask), bass, use_slash != 0);
+                    ChordDetector::TolerantChord b = ChordDetector::search_tolerant(table, static_cast<uint16_t>(mask), bass,
+                                                                                    use_slash != 0, options);
+                    if (std::memcmp(&a.chord, &b.chord, sizeof(PackedChordResult)) != 0 || a.extra != b.extra ||
+                        a.missing != b.missing || a.distance != b.distance) ++mismatches;
+
+                    PackedChordResult plain = ChordDetector::lookup_chord(static_cast<uint16_t>(mask), bass, use_slash != 0);
+                    if ((plain.flags & ChordDetector::CHORD_FLAG_MATCHED) &&
+                        (std::memcmp(&plain, &a.chord, sizeof(PackedChordResult)) != 0 || a.distance != 0)) ++mismatches;
+                    if (!(plain.flags & ChordDetector::CHORD_FLAG_MATCHED) && a.distance > 0) ++inexact;
+                }
+            }
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Neighbor tables match probing and exact results");
+    result.assert_bool(true, inexact > 0, "Tolerance names otherwise unmatched sets");
+    ChordDetector::TolerantChord past_end = ChordDetector::tolerance_table(1).find(0xFFF, 12, true);
+    result.assert_bool(false, (past_end.chord.flags & ChordDetector::CHORD_FLAG_MATCHED) != 0, "Tolerant bass past 11 is unmatched");
+
+    // Probing finds the best-scoring set among all sets within the distance (brute force over 4096 masks)
+    ChordDetector::ToleranceOptions options;
+    options.max_distance = 2;
+    uint32_t seed = 5;
+    mismatches = 0;
+    for (int trial = 0; trial < 300; ++trial) {
+        seed = seed * 1664525u + 1013904223u;
+        uint16_t mask = static_cast<uint16_t>((seed >> 8) & 0xFFF);
+        int bass = static_cast<int>((seed >> 24) % 12);
+        mask |= static_cast<uint16_t>(1 << bass);
+        if (table.find(mask, bass, true).flags & ChordDetector::CHORD_FLAG_MATCHED) continue;
+
+        int best = -1000;
+        for (int other = 0; other < 4096; ++other) {
+            int distance = ChordDetector::count_pitch_classes(static_cast<uint16_t>(other ^ mask));
+            if (distance == 0 || distance > 2 || !(other & (1 << bass))) continue;
+            const ChordDetector::LookupEntry& entry = table.find(static_cast<uint16_t>(other), bass, true);
+            if (!(entry.flags & ChordDetector::CHORD_FLAG_MATCHED)) continue;
+            int score = entry.priority - options.distance_penalty * distance;
+            if (score > best) best = score;
+        }
+        ChordDetector::TolerantChord found = ChordDetector::search_tolerant(table, mask, bass, true, options);
+        uint16_t target = static_cast<uint16_t>((mask & ~found.extra) | found.missing);
+        int score = (found.chord.flags & ChordDetector::CHORD_FLAG_MATCHED)
+                        ? table.find(target, bass, true).priority - options.distance_penalty * found.distance : -1000;
+        if (score != best || (found.extra & ~mask) || (found.missing & mask)) ++mismatches;
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Tolerant search is optimal");
+}
+
+void test_tracker_bank() {
+    std::cout << "\n--- Chord Tracker Bank ---" << std::endl;
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+
+    ChordDetector::ChordTrackerBank bank(128, true);
+    size_t piano = bank.merge({0, 1});
+    // Left hand alone is a single (unmatched) note, so only channels 1 and 5 change
+    NoteEvent block[] = {{0, 48, 0, 1}, {0, 64, 1, 1}, {0, 67, 1, 1}, {0, 72, 1, 1}, {0, 62, 5, 1}, {0, 65, 5, 1}, {0, 69, 5, 1}};
+    result.assert_equal("2", std::to_string(bank.process(block, 7)), "Bank reports changed channels");
+    result.assert_bool(true, bank.changed_channels() == std::vector<uint32_t>({1, 5}), "Changed channels in order");
+    result.assert_equal("Dm", std::string(format_chord(bank.current(5), buf, sizeof(buf))), "Channel 5 chord");
+    result.assert_equal("C", std::string(format_chord(bank.group_current(piano), buf, sizeof(buf))), "Merged hands");
+    result.assert_bool(true, bank.group_changed(piano) && bank.changed_groups().size() == 1, "Merged group changed");
+    result.assert_equal("48", std::to_string(bank.bass_note(0)), "Bank bass note");
+
+    // An octave doubling changes neither pitch-class set nor bass: no new result
+    NoteEvent doubling[] = {{1, 76, 1, 1}};
+    result.assert_equal("0", std::to_string(bank.process(doubling, 1)), "Octave doubling keeps the chord");
+    result.assert_bool(false, bank.group_changed(piano), "Group unchanged by doubling");
+
+    NoteEvent release[] = {{2, 48, 0, 0}};
+    bank.process(release, 1);
+    result.assert_equal("C/E", std::string(format_chord(bank.group_current(piano), buf, sizeof(buf))), "Group follows the new bass");
+    result.assert_bool(true, bank.group_changed(piano), "Bass change marks the group changed");
+    bank.process(nullptr, 0);
+    result.assert_bool(true, !bank.group_changed(piano) && bank.changed_groups().empty(), "Empty block clears group changes");
+    bank.release(1);
+    bank.flush();
+    result.assert_bool(true, !(bank.group_current(piano).flags & ChordDetector::CHORD_FLAG_MATCHED) &&
+                       bank.bass_note(1) == ChordDetector::ChordTrackerBank::NO_NOTE, "Released channel is empty");
+
+    // Same results as one ChordTracker per channel (and one fed by both channels of a group) on random blocks
+    const uint32_t channels = 24;
+    ChordDetector::ChordTrackerBank random_bank(channels, true);
+    size_t group = random_bank.merge({3, 7, 11});
+    std::vector<ChordTracker> trackers(channels, ChordTracker(true));
+    ChordTracker group_tracker(true);
+    std::vector<std::array<bool, 128>> held(channels);
+    for (std::array<bool, 128>& notes : held) notes.fill(false);
+
+    uint32_t seed = 99;
+    auto next = [&seed] {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+    int mismatches = 0;
+    std::vector<NoteEvent> events;
+    for (int round = 0; round < 400; ++round) {
+        events.clear();
+        size_t count = next() % 40;
+        for (size_t e = 0; e < count; ++e) {
+            uint8_t channel = static_cast<uint8_t>(next() % channels);
+            uint8_t note = static_cast<uint8_t>(36 + next() % 48);
+            bool on = !held[channel][note];
+            held[channel][note] = on;
+            events.push_back({0, note, channel, static_cast<uint8_t>(on)});
+            trackers[channel].apply(events.back());
+            if (channel == 3 || channel == 7 || channel == 11) group_tracker.apply(events.back());
+        }
+
+        std::vector<PackedChordResult> before(channels);
+        for (uint32_t c = 0; c < channels; ++c) before[c] = random_bank.current(c);
+        random_bank.process(events.data(), events.size());
+
+        std::vector<uint32_t> expected_changes;
+        for (uint32_t c = 0; c < channels; ++c) {
+            if (std::memcmp(&random_bank.current(c), &trackers[c].current(), sizeof(PackedChordResult)) != 0) ++mismatches;
+            if (!ChordDetector::same_chord(before[c], trackers[c].current())) expected_changes.push_back(c);
+        }
+        if (expected_changes != random_bank.changed_channels()) ++mismatches;
+        if (std::memcmp(&random_bank.group_current(group), &group_tracker.current(), sizeof(PackedChordResult)) != 0) ++mismatches;
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Bank matches per-channel trackers");
+
+    random_bank.reset();
+    result.assert_bool(true, random_bank.process(nullptr, 0) == 0 && random_bank.current(3).bass_pc == ChordDetector::NO_PITCH_CLASS,
+                       "Bank reset");
+}
+
+void test_annotation_format() {
+    std::cout << "\n--- Binary Annotation Format ---" << std::endl;
+    char buf[ChordDetector::CHORD_NAME_CAPACITY];
+
+    ChordDetector::AnnotationOptions options;
+    options.records_per_block = 4;
+    options.ticks_per_quarter = 480;
+    ChordDetector::AnnotationWriter writer(options);
+    std::vector<ChordDetector::ChordChange> changes;
+    const std::vector<int> voicings[] = {{60, 64, 67}, {64, 67, 72}, {62, 65, 69}, {67, 71, 74, 77}, {60}, {57, 60, 64}};
+    for (int i = 0; i < 30; ++i) {
+        changes.push_back({uint64_t(i) * 480 + (i % 3) * 7, analyze_chord_fast(voicings[i % 6], true)});
+        writer.add(changes.back());
+    }
+    result.assert_bool(false, writer.add(0, changes[0].chord), "Writer rejects decreasing ticks");
+    const std::vector<uint8_t>& image = writer.finish();
+
+    ChordDetector::AnnotationReader reader(image.data(), image.size());
+    result.assert_bool(true, reader.ok(), "Reader opens writer output");
+    result.assert_equal("30 8 480", std::to_string(reader.record_count()) + " " + std::to_string(reader.block_count()) + " " +
+                        std::to_string(reader.ticks_per_quarter()), "Annotation header fields");
+    result.assert_equal("7", std::string(reader.pattern_name(changes[3].chord.pattern_id)), "Embedded pattern name");
+
+    ChordDetector::ChordChange change;
+    int mismatches = 0;
+    size_t read = 0;
+    for (; reader.next(change); ++read) {
+        if (read >= changes.size() || change.tick != changes[read].tick ||
+            std::memcmp(&change.chord, &changes[read].chord, sizeof(PackedChordResult)) != 0) ++mismatches;
+    }
+    result.assert_bool(true, mismatches == 0 && read == changes.size(), "Annotation round trip");
+
+    // Records of the data section: at most 2 varint bytes of delta (480 + 7), 1 pitch-class byte, 2 pattern bytes
+    size_t data_size = 0;
+    for (size_t b = 0; b < reader.block_count(); ++b) data_size += reader.block(b).byte_size;
+    result.assert_bool(true, data_size <= changes.size() * 5, "Records take at most 5 bytes here");
+
+    // Seek lands on the chord in effect at the tick
+    reader.seek(changes[13].tick + 100);
+    reader.next(change);
+    result.assert_bool(true, change.tick == changes[13].tick, "Seek to the chord in effect");
+    reader.seek(changes[13].tick);
+    reader.next(change);
+    result.assert_bool(true, change.tick == changes[13].tick, "Seek to an exact tick");
+    reader.seek(0);
+    reader.next(change);
+    result.assert_bool(true, change.tick == 0, "Seek to the start");
+    reader.seek(uint64_t(1) << 40);
+    reader.next(change);
+    result.assert_bool(true, change.tick == changes.back().tick && !reader.next(change), "Seek past the end");
+
+    std::vector<ChordDetector::ChordChange> block(reader.block(2).record_count);
+    result.assert_bool(true, reader.read_block(2, block.data()) == 4 && block[0].tick == changes[8].tick, "Read one block");
+
+    result.assert_equal("C/E", std::string(reader.format(changes[1].chord, buf, sizeof(buf))), "Format from the embedded names");
+    result.assert_equal("G7", reader.to_chord_result(changes[3].chord).full_name, "Expand to ChordResult");
+    result.assert_equal("", std::string(reader.format(changes[4].chord, buf, sizeof(buf))), "Unmatched record formats empty");
+
+    // Custom vocabularies are named without the dictionary
+    ChordDictionary quartal = {{(1 << 0) | (1 << 5) | (1 << 10), "quartal", 50}};
+    ChordDetector::AnnotationWriter custom(quartal);
+    custom.add(0, analyze_chord_fast(quartal, {62, 67, 72}));
+    std::vector<uint8_t> custom_image = custom.finish();
+    ChordDetector::AnnotationReader custom_reader(custom_image.data(), custom_image.size());
+    custom_reader.next(change);
+    result.assert_equal("Dquartal", std::string(custom_reader.format(change.chord, buf, sizeof(buf))), "Custom vocabulary names");
+
+    // Names longer than CHORD_NAME_CAPACITY are read back in full
+    ChordDictionary verbose = {{(1 << 0) | (1 << 2) | (1 << 4) | (1 << 5) | (1 << 9) | (1 << 11),
+                                "maj7(add9,add11,add13,no3)-custom-voicing", 90}};
+    ChordDetector::AnnotationWriter verbose_writer(verbose);
+    verbose_writer.add(0, analyze_chord_fast(verbose, {60, 62, 64, 65, 69, 71}));
+    std::vector<uint8_t> verbose_image = verbose_writer.finish();
+    ChordDetector::AnnotationReader verbose_reader(verbose_image.data(), verbose_image.size());
+    verbose_reader.next(change);
+    char long_buf[64];
+    std::string expected_long = analyze_chord(verbose, {60, 62, 64, 65, 69, 71}).full_name;
+    result.assert_equal("Cmaj7(add9,add11,add13,no3)-custom-voicing", expected_long, "Long dictionary name analyzed");
+    result.assert_equal(expected_long, std::string(verbose_reader.format(change.chord, long_buf, sizeof(long_buf))),
+                        "Long embedded name formatted in full");
+    result.assert_equal(expected_long, verbose_reader.to_chord_result(change.chord).full_name, "Long embedded name expanded in full");
+
+    // Corrupt and truncated input is rejected, not read past
+    ChordDetector::AnnotationReader truncated(image.data(), image.size() - 1);
+    result.assert_bool(false, truncated.ok(), "Truncated file rejected");
+    std::vector<uint8_t> corrupt = image;
+    corrupt[0] = 'X';
+    result.assert_bool(false, ChordDetector::AnnotationReader(corrupt.data(), corrupt.size()).ok(), "Bad magic rejected");
+    corrupt = image;
+    corrupt[4] = 2;
+    result.assert_equal("unsupported annotation version", ChordDetector::AnnotationReader(corrupt.data(), corrupt.size()).error(),
+                        "Unknown version rejected");
+    corrupt = image;
+    corrupt.back() = 0xFF;  // Last record's pattern code becomes an unterminated varint
+    ChordDetector::AnnotationReader bad_record(corrupt.data(), corrupt.size());
+    result.assert_bool(true, !bad_record.ok() && !bad_record.next(change), "Corrupt record rejected on open");
+    ChordDetector::AnnotationReader short_header(image.data(), ChordDetector::ANNOTATION_HEADER_SIZE - 1);
+    result.assert_bool(false, short_header.ok(), "Truncated header rejected");
+    corrupt = image;
+    for (int i = 0; i < 8; ++i) corrupt[32 + i] = i == 0 ? 0xF0 : 0xFF;    // Names offset that wraps when added to
+    result.assert_equal("truncated or corrupt annotation header",
+                        ChordDetector::AnnotationReader(corrupt.data(), corrupt.size()).error(), "Wrapping names offset rejected");
+    corrupt = image;
+    size_t second_entry = static_cast<size_t>(corrupt[40] | (corrupt[41] << 8)) + ChordDetector::ANNOTATION_INDEX_ENTRY_SIZE;
+    corrupt[second_entry] = 1000 & 0xFF;    // Block 1 now starts before block 0's last record (tick 1440)
+    corrupt[second_entry + 1] = 1000 >> 8;
+    result.assert_equal("block starts before the previous block ends",
+                        ChordDetector::AnnotationReader(corrupt.data(), corrupt.size()).error(), "Overlapping blocks rejected");
+    corrupt = image;
+    size_t data_start = static_cast<size_t>(corrupt[48] | (corrupt[49] << 8));
+    corrupt[data_start + 1] |= 0x0F;    // First record (tick delta 0, C) gets bass nibble 15 while matched
+    result.assert_equal("corrupt record", ChordDetector::AnnotationReader(corrupt.data(), corrupt.size()).error(),
+                        "Matched record without a bass rejected");
+    PackedChordResult no_bass = changes[0].chord;
+    no_bass.bass_pc = ChordDetector::NO_PITCH_CLASS;
+    PackedChordResult bad_root = changes[0].chord;
+    bad_root.root_pc = 12;
+    ChordDetector::AnnotationWriter strict;
+    result.assert_bool(true, !strict.add(0, no_bass) && !strict.add(0, bad_root) && strict.record_count() == 0,
+                       "Writer rejects matched chords with out-of-range pitch classes");
+
+    ChordDetector::AnnotationWriter empty;
+    std::vector<uint8_t> empty_image = empty.finish();
+    ChordDetector::AnnotationReader empty_reader(empty_image.data(), empty_image.size());
+    result.assert_bool(true, empty_reader.ok() && !empty_reader.seek(0) && !empty_reader.next(change), "Empty annotation");
+}
+
+void test_arena_batch() {
+    std::cout << "\n--- Arena-backed Bulk Analysis ---" << std::endl;
+
+    // Flat note buffer of random voicings, 1-6 notes each
+    std::vector<int> notes;
+    std::vector<size_t> offsets = {0};
+    uint32_t seed = 17;
+    for (int chord = 0; chord < 700; ++chord) {
+        seed = seed * 1664525u + 1013904223u;
+        int count = 1 + static_cast<int>((seed >> 24) % 6);
+        for (int n = 0; n < count; ++n) {
+            seed = seed * 1664525u + 1013904223u;
+            notes.push_back(48 + static_cast<int>((seed >> 16) % 36));
+        }
+        offsets.push_back(notes.size());
+    }
+    size_t chord_count = offsets.size() - 1;
+
+    ChordDetector::AnalysisArena arena(1024);
+    int mismatches = 0;
+    for (int use_flats = 0; use_flats < 2; ++use_flats) {
+        arena.reset();
+        ChordDetector::Span<ChordDetector::DetailedAnalysisView> details =
+            get_detailed_analysis_batch(notes.data(), offsets.data(), chord_count, arena, use_flats != 0);
+        ChordDetector::Span<ChordDetector::ChordResultView> chords =
+            analyze_chords_batch(notes.data(), offsets.data(), chord_count, arena, use_flats != 0, false);
+        for (size_t c = 0; c < chord_count; ++c) {
+            const int* voicing = notes.data() + offsets[c];
+            int count = static_cast<int>(offsets[c + 1] - offsets[c]);
+            DetailedAnalysis expected = get_detailed_analysis(voicing, count, use_flats != 0);
+            const ChordDetector::DetailedAnalysisView& d = details[c];
+            if (expected.chord.full_name != d.chord.full_name || expected.chord.chord_name != d.chord.chord_name ||
+                expected.chord.bass_note != d.chord.bass_note || expected.chord.is_slash_chord != d.chord.is_slash_chord ||
+                expected.chord.root_pitch_class != d.chord.root_pitch_class ||
+                expected.chord.bass_pitch_class != d.chord.bass_pitch_class || expected.inversion_type != d.inversion_type ||
+                expected.note_names.size() != d.note_names.size() ||
+                expected.intervals_from_root.size() != d.intervals_from_root.size()) {
+                ++mismatches;
+                continue;
+            }
+            for (size_t n = 0; n < d.note_names.size(); ++n) mismatches += expected.note_names[n] != d.note_names[n];
+            for (size_t n = 0; n < d.intervals_from_root.size(); ++n) {
+                mismatches += expected.intervals_from_root[n] != d.intervals_from_root[n];
+            }
+
+            ChordResult plain = analyze_chord(voicing, count, use_flats != 0, false);
+            mismatches += plain.full_name != chords[c].full_name || plain.root_pitch_class != chords[c].root_pitch_class;
+        }
+    }
+    result.assert_equal("0", std::to_string(mismatches), "Arena batches match per-chord analysis");
+
+    // Reset keeps the blocks: a second batch of the same size takes nothing from upstream
+    size_t blocks = arena.block_count();
+    arena.reset();
+    get_detailed_analysis_batch(notes.data(), offsets.data(), chord_count, arena);
+    result.assert_bool(true, blocks > 1 && arena.block_count() == blocks && arena.used() > 0, "Arena reuses its blocks");
+    arena.release();
+    result.assert_bool(true, arena.block_count() == 0 && arena.capacity() == 0, "Arena release");
+
+    // Custom vocabulary names are formatted into the arena; fields skip work as in analyze_chord
+    ChordDictionary jazz = {{(1<<0)|(1<<3)|(1<<4)|(1<<7)|(1<<10), "7#9", 82}};
+    int jazz_notes[] = {61, 66, 70, 73, 76, 81, 60, 64, 67};
+    size_t jazz_offsets[] = {0, 6, 9};
+    ChordDetector::Span<ChordDetector::ChordResultView> named = analyze_chords_batch(jazz, jazz_notes, jazz_offsets, 2, arena, true, true);
+    result.assert_bool(true, named.size() == 2 && named[0].full_name == "Gb7#9/Db" && named[0].chord_name == "Gb7#9" &&
+                       named[1].full_name == "C", "Dictionary names in the arena");
+
+    // Names longer than CHORD_NAME_CAPACITY are formatted in full, with and without a slash bass
+    ChordDictionary verbose = {{(1<<0)|(1<<3)|(1<<4)|(1<<7)|(1<<10), "-dominant-seventh-with-sharp-ninth-voicing", 82}};
+    int long_mismatches = 0;
+    for (int use_slash = 0; use_slash < 2; ++use_slash) {
+        ChordDetector::Span<ChordDetector::ChordResultView> verbose_named =
+            analyze_chords_batch(verbose, jazz_notes, jazz_offsets, 1, arena, true, use_slash != 0);
+        ChordResult expected = analyze_chord(verbose, jazz_notes, 6, true, use_slash != 0);
+        long_mismatches += expected.full_name != verbose_named[0].full_name || expected.chord_name != verbose_named[0].chord_name;
+        long_mismatches += expected.full_name.size() < 40;
+    }
+    result.assert_equal("0", std::to_string(long_mismatches), "Long dictionary names in the arena");
+    ChordDetector::Span<ChordDetector::DetailedAnalysisView> lean =
+        get_detailed_analysis_batch(jazz_notes, jazz_offsets, 2, arena, false, ChordDetector::FIELD_INTERVALS);
+    result.assert_bool(true, lean[1].chord.full_name.empty() && lean[1].note_names.empty() && lean[1].intervals_from_root.size() == 3,
+                       "Arena batch fields");
+
+    // The arena also serves pmr containers
+    std::pmr::vector<int> shared(&arena);
+    shared.assign(100, 7);
+    result.assert_bool(true, shared.size() == 100 && shared[99] == 7, "Arena as a memory_resource");
+
+    // Over-aligned requests are aligned by address, both in a fresh block and after smaller allocations
+    ChordDetector::AnalysisArena aligned(1024), shifted(1024);
+    void* first = aligned.allocate(8, 256);
+    shifted.allocate_array<char>(1);
+    void* second = shifted.allocate(8, 64);
+    result.assert_bool(true, reinterpret_cast<uintptr_t>(first) % 256 == 0 && reinterpret_cast<uintptr_t>(second) % 64 == 0,
+                       "Arena aligns over-aligned requests");
+    bool overflow_thrown = false;
+    try {
+        aligned.allocate_array<int>(SIZE_MAX / 2);
+    } catch (const std::bad_array_new_length&) {
+        overflow_thrown = true;
+    }
+    result.assert_bool(true, overflow_thrown, "Arena rejects array sizes that overflow");
+}
 
 int main() {
     std::cout << "🎵 Unified Chord Detector - Comprehensive Test Suite 🎵" << std::endl;
@@ -454,6 +2085,7 @@ int main() {
     test_legacy_compatibility();
     test_inversion_analysis();
     test_detailed_analysis();
+    test_compact_detailed_analysis();
     test_sharp_flat_notation();
     test_different_input_formats();
     test_edge_cases();
@@ -463,8 +2095,30 @@ int main() {
     test_augmented_chords();
     test_additional_sus_chords();
     test_new_chord_patterns();
-
-    test_performance();
+    test_lookup_table();
+    test_packed_results();
+    test_result_fields();
+    test_batch_analysis();
+    test_chord_tracker();
+    test_constexpr_analysis();
+    test_pattern_index();
+    test_chord_dictionary();
+    test_parallel_analysis();
+    test_midi_reader();
+    test_candidates();
+    test_multiple_translation_units();
+    test_name_pool();
+    test_chroma_input();
+    test_sequence_decoder();
+    test_stats();
+    test_memo_cache();
+    test_progression_analysis();
+    test_key_estimation();
+    test_realtime_mode();
+    test_tolerant_matching();
+    test_tracker_bank();
+    test_annotation_format();
+    test_arena_batch();
 
     // Print final results
     result.print_summary();
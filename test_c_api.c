@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+#include "chord_detector_c.h"
+
+/* C ABI smoke test, compiled as C against the shared library */
+
+static int failed = 0;
+
+static void check(int condition, const char* name) {
+    printf("%s %s\n", condition ? "✓" : "✗", name);
+    if (!condition) failed++;
+}
+
+int main(void) {
+    int g7_b[] = {71, 74, 77, 79};
+    int single[] = {60};
+    cd_result chord;
+
+    check(cd_abi_version() == CD_ABI_VERSION, "ABI version");
+
+    chord = cd_analyze(g7_b, 4, 1);
+    check(chord.root_pc == 7 && chord.bass_pc == 11, "G7/B root and bass");
+    check((chord.flags & CD_FLAG_SLASH) != 0, "G7/B is a slash chord");
+
+    chord = cd_analyze(g7_b, 4, 0);
+    check(chord.root_pc == 7 && (chord.flags & CD_FLAG_SLASH) == 0, "G7 without slash detection");
+
+    chord = cd_lookup((1 << 0) | (1 << 4) | (1 << 7), 4, 1);
+    check(chord.root_pc == 0 && chord.bass_pc == 4, "C/E from a pitch-class mask");
+
+    chord = cd_analyze(single, 1, 1);
+    check(chord.pattern_id == CD_PATTERN_NONE && chord.root_pc == CD_NO_PITCH_CLASS, "Single note is unmatched");
+
+    chord = cd_lookup(0x091, 12, 1);
+    check(chord.pattern_id == CD_PATTERN_NONE, "Invalid bass is unmatched");
+
+    {
+        /* C/E, G7/B, invalid bass */
+        uint16_t masks[3] = {(1 << 0) | (1 << 4) | (1 << 7), (1 << 11) | (1 << 2) | (1 << 5) | (1 << 7), 0x091};
+        uint8_t bass[3] = {4, 11, 200};
+        int notes[] = {64, 67, 72, 71, 74, 77, 79};
+        size_t offsets[] = {0, 3, 7};
+        cd_result out[3];
+        char name[CD_NAME_CAPACITY];
+
+        cd_analyze_batch(masks, bass, 3, out, 1);
+        cd_format(&out[0], 0, name, sizeof(name));
+        check(strcmp(name, "C/E") == 0, "Batch C/E formatted");
+        cd_format(&out[1], 1, name, sizeof(name));
+        check(strcmp(name, "G7/B") == 0, "Batch G7/B formatted");
+        check(cd_format(&out[2], 0, name, sizeof(name)) == 0 && name[0] == '\0', "Unmatched formats as empty");
+
+        cd_analyze_notes_batch(notes, offsets, 2, out, 1);
+        check(out[0].root_pc == 0 && out[1].root_pc == 7 && out[1].bass_pc == 11, "Note batch matches");
+
+        check(cd_format(&out[1], 0, name, 3) == 2 && strcmp(name, "G7") == 0, "Truncated to capacity");
+
+        /* Garbage pitch classes or pattern ids with the MATCHED bit set format as empty */
+        chord = out[1];
+        chord.root_pc = 200;
+        check(cd_format(&chord, 0, name, sizeof(name)) == 0 && name[0] == '\0', "Out-of-range root formats as empty");
+        chord = out[1];
+        chord.bass_pc = 12;
+        check(cd_format(&chord, 0, name, sizeof(name)) == 0 && name[0] == '\0', "Out-of-range slash bass formats as empty");
+        chord = out[1];
+        chord.pattern_id = (uint16_t)cd_pattern_count();
+        check(cd_format(&chord, 0, name, sizeof(name)) == 0 && name[0] == '\0', "Out-of-range pattern formats as empty");
+
+        check(cd_pattern_count() > 0 && strcmp(cd_pattern_suffixes()[out[1].pattern_id], "7") == 0,
+              "Pattern suffix table");
+        check(strcmp(cd_pattern_suffix(out[1].pattern_id), "7") == 0 && cd_pattern_suffix(CD_PATTERN_NONE)[0] == '\0',
+              "Pattern suffix lookup");
+        check(strcmp(cd_note_name(10, 1), "Bb") == 0 && strcmp(cd_note_name(10, 0), "A#") == 0, "Note names");
+    }
+
+    printf("C API: %s\n", failed ? "FAILED" : "all passed");
+    return failed ? 1 : 0;
+}
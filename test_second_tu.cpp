@@ -0,0 +1,14 @@
+#include "chord_detector.h"
+#include "chord_detector_parallel.h"
+#include "chord_detector_midi.h"
+
+// Second translation unit of chord_detector_test: the headers must link when included more than once
+
+std::string chord_name_from_second_tu(std::initializer_list<int> midi_notes) {
+    DetailedAnalysis analysis = get_detailed_analysis(midi_notes);
+    return analysis.chord.full_name + " " + get_chord_name(midi_notes) + " " + analyze_chord(midi_notes).full_name;
+}
+
+const ChordDetector::LookupTable* lookup_table_from_second_tu() {
+    return &ChordDetector::lookup_table();
+}